@@ -16,12 +16,14 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<string.h>
 #include"z3.h"
 #include"api_log_macros.h"
 #include"api_context.h"
 #include"api_util.h"
 #include"cmd_context.h"
 #include"smt2parser.h"
+#include"mapped_file.h"
 #include"smtparser.h"
 #include"solver_na2as.h"
 
@@ -252,7 +254,8 @@ extern "C" {
     // ---------------
     // Support for SMTLIB2
 
-    Z3_ast parse_smtlib2_stream(bool exec, Z3_context c, std::istream& is,
+    // If is is 0, then the commands are read from the buffer [begin, end).
+    Z3_ast parse_smtlib2_stream(bool exec, Z3_context c, std::istream * is, char const * begin, char const * end,
                                 unsigned num_sorts,
                                 Z3_symbol const sort_names[],
                                 Z3_sort const sorts[],
@@ -269,7 +272,8 @@ extern "C" {
             psort* ps = ctx.pm().mk_psort_cnst(to_sort(sorts[i]));
             ctx.insert(ctx.pm().mk_psort_user_decl(0, to_symbol(sort_names[i]), ps));
         }
-        if (!parse_smt2_commands(ctx, is)) {
+        bool ok = is ? parse_smt2_commands(ctx, *is) : parse_smt2_commands(ctx, begin, end);
+        if (!ok) {
             SET_ERROR_CODE(Z3_PARSER_ERROR);
             return of_ast(mk_c(c)->m().mk_true());
         }
@@ -289,9 +293,8 @@ extern "C" {
                                           Z3_func_decl const decls[]) {
         Z3_TRY;
         LOG_Z3_parse_smtlib2_string(c, str, num_sorts, sort_names, sorts, num_decls, decl_names, decls);
-        std::string s(str);
-        std::istringstream is(s);
-        Z3_ast r = parse_smtlib2_stream(false, c, is, num_sorts, sort_names, sorts, num_decls, decl_names, decls);
+        // the string is scanned in place.
+        Z3_ast r = parse_smtlib2_stream(false, c, 0, str, str + strlen(str), num_sorts, sort_names, sorts, num_decls, decl_names, decls);
         RETURN_Z3(r);
         Z3_CATCH_RETURN(0);
     }
@@ -305,12 +308,12 @@ extern "C" {
                                         Z3_func_decl const decls[]) {
         Z3_TRY;
         LOG_Z3_parse_smtlib2_string(c, file_name, num_sorts, sort_names, sorts, num_decls, decl_names, decls);
-        std::ifstream is(file_name);
-        if (!is) {
+        mapped_file in;
+        if (!in.open(file_name)) {
             SET_ERROR_CODE(Z3_PARSER_ERROR);
             return 0;
         }
-        Z3_ast r = parse_smtlib2_stream(false, c, is, num_sorts, sort_names, sorts, num_decls, decl_names, decls);
+        Z3_ast r = parse_smtlib2_stream(false, c, 0, in.begin(), in.end(), num_sorts, sort_names, sorts, num_decls, decl_names, decls);
         RETURN_Z3(r);
         Z3_CATCH_RETURN(0);
     }
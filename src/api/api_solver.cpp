@@ -17,6 +17,7 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<fstream>
 #include"z3.h"
 #include"api_log_macros.h"
 #include"api_context.h"
@@ -32,6 +33,8 @@ Revision History:
 #include"smt_strategic_solver.h"
 #include"smt_solver.h"
 #include"smt_implied_equalities.h"
+#include"ast_binary.h"
+#include"mapped_file.h"
 
 extern "C" {
 
@@ -396,6 +399,53 @@ extern "C" {
         Z3_CATCH_RETURN("");
     }
 
+    void Z3_API Z3_solver_to_binary_file(Z3_context c, Z3_solver s, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_solver_to_binary_file(c, s, file_name);
+        RESET_ERROR_CODE();
+        init_solver(c, s);
+        std::ofstream out(file_name, std::ios::out | std::ios::binary);
+        if (out.bad() || out.fail()) {
+            SET_ERROR_CODE(Z3_FILE_ACCESS_ERROR);
+            return;
+        }
+        solver * slv = to_solver_ref(s);
+        ptr_vector<ast> fmls;
+        unsigned sz = slv->get_num_assertions();
+        for (unsigned i = 0; i < sz; i++)
+            fmls.push_back(slv->get_assertion(i));
+        ast_to_binary(mk_c(c)->m(), fmls.size(), fmls.c_ptr(), out);
+        out.close();
+        if (out.fail())
+            SET_ERROR_CODE(Z3_FILE_ACCESS_ERROR);
+        Z3_CATCH;
+    }
+
+    void Z3_API Z3_solver_from_binary_file(Z3_context c, Z3_solver s, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_solver_from_binary_file(c, s, file_name);
+        RESET_ERROR_CODE();
+        init_solver(c, s);
+        mapped_file in;
+        if (!in.open(file_name)) {
+            SET_ERROR_CODE(Z3_FILE_ACCESS_ERROR);
+            return;
+        }
+        ast_manager & m = mk_c(c)->m();
+        ast_ref_vector fmls(m);
+        ast_from_binary(m, in.begin(), in.end(), fmls);
+        for (unsigned i = 0; i < fmls.size(); i++) {
+            ast * f = fmls.get(i);
+            if (!is_expr(f) || !m.is_bool(to_expr(f))) {
+                SET_ERROR_CODE(Z3_INVALID_ARG);
+                return;
+            }
+        }
+        for (unsigned i = 0; i < fmls.size(); i++)
+            to_solver_ref(s)->assert_expr(to_expr(fmls.get(i)));
+        Z3_CATCH;
+    }
+
 
     Z3_lbool Z3_API Z3_get_implied_equalities(Z3_context c, 
                                               Z3_solver s,
@@ -5916,6 +5916,27 @@ extern "C" {
     */
     Z3_string Z3_API Z3_solver_to_string(Z3_context c, Z3_solver s);
 
+    /**
+       \brief Save the assertions of the solver \c s in the file \c file_name
+       using a compact binary format. Sharing between the assertions is preserved.
+       Assumptions used for unsat core extraction (see #Z3_solver_assert_and_track) are not saved.
+
+       \sa Z3_solver_from_binary_file
+
+       def_API('Z3_solver_to_binary_file', VOID, (_in(CONTEXT), _in(SOLVER), _in(STRING)))
+    */
+    void Z3_API Z3_solver_to_binary_file(Z3_context c, Z3_solver s, Z3_string file_name);
+
+    /**
+       \brief Assert in the solver \c s the formulas stored in the file \c file_name
+       by #Z3_solver_to_binary_file.
+
+       \sa Z3_solver_to_binary_file
+
+       def_API('Z3_solver_from_binary_file', VOID, (_in(CONTEXT), _in(SOLVER), _in(STRING)))
+    */
+    void Z3_API Z3_solver_from_binary_file(Z3_context c, Z3_solver s, Z3_string file_name);
+
     /*@}*/
 
     /** @name Statistics */
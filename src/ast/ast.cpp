@@ -1356,6 +1356,9 @@ ast_manager::ast_manager(ast_manager const & src, bool disable_proofs):
 }
 
 void ast_manager::init() {
+    m_concurrent = false;
+    omp_init_nest_lock(&m_lock);
+    omp_init_lock(&m_node_lock);
     m_int_real_coercions = true;
     m_debug_ref_count = false;
     m_fresh_id = 0;
@@ -1388,6 +1391,7 @@ void ast_manager::init() {
 
 ast_manager::~ast_manager() {
     SASSERT(is_format_manager() || !m_family_manager.has_family(symbol("format")));
+    set_concurrent(false);
 
     dec_ref(m_bool_sort);
     dec_ref(m_proof_sort);
@@ -1434,9 +1438,12 @@ ast_manager::~ast_manager() {
         dealloc(m_trace_stream);
         m_trace_stream = 0;
     }
+    omp_destroy_lock(&m_node_lock);
+    omp_destroy_nest_lock(&m_lock);
 }
 
 void ast_manager::compact_memory() {
+    SASSERT(!m_concurrent);
     m_alloc.consolidate();
     unsigned capacity = m_ast_table.capacity();
     if (capacity > 4*m_ast_table.size()) {
@@ -1456,6 +1463,7 @@ void ast_manager::compact_memory() {
 }
 
 void ast_manager::compress_ids() {
+    SASSERT(!m_concurrent);
     ptr_vector<ast> asts;
     m_expr_id_gen.cleanup();
     m_decl_id_gen.cleanup(c_first_decl_id);
@@ -1476,6 +1484,67 @@ void ast_manager::compress_ids() {
         m_ast_table.insert(*it2);
 }
 
+void ast_manager::set_concurrent(bool f) {
+    if (f == m_concurrent)
+        return;
+    if (f) {
+        for (unsigned i = 0; i < c_num_stripes; i++)
+            m_ast_stripes.push_back(alloc(ast_stripe));
+        ast_table::iterator it  = m_ast_table.begin();
+        ast_table::iterator end = m_ast_table.end();
+        for (; it != end; ++it)
+            get_stripe((*it)->hash()).m_table.insert(*it);
+        m_ast_table.finalize();
+        m_concurrent = true;
+        return;
+    }
+    m_concurrent = false;
+    ptr_vector<ast> garbage;
+    for (unsigned i = 0; i < c_num_stripes; i++) {
+        ast_table & t = m_ast_stripes[i]->m_table;
+        ast_table::iterator it  = t.begin();
+        ast_table::iterator end = t.end();
+        for (; it != end; ++it) {
+            m_ast_table.insert(*it);
+            if ((*it)->get_ref_count() == 0)
+                garbage.push_back(*it);
+        }
+        dealloc(m_ast_stripes[i]);
+    }
+    m_ast_stripes.reset();
+    // A node in garbage may be an argument of another one.
+    // Increment all counters first, so that no node is deleted twice.
+    ptr_vector<ast>::iterator it  = garbage.begin();
+    ptr_vector<ast>::iterator end = garbage.end();
+    for (; it != end; ++it)
+        inc_ref(*it);
+    for (it = garbage.begin(); it != end; ++it)
+        dec_ref(*it);
+}
+
+bool ast_manager::contains(ast * a) const {
+    if (!m_concurrent)
+        return m_ast_table.contains(a);
+    ast_stripe & s = get_stripe(a->hash());
+    omp_set_lock(&s.m_lock);
+    bool r = s.m_table.contains(a);
+    omp_unset_lock(&s.m_lock);
+    return r;
+}
+
+unsigned ast_manager::get_num_asts() const {
+    if (!m_concurrent)
+        return m_ast_table.size();
+    unsigned r = 0;
+    for (unsigned i = 0; i < c_num_stripes; i++) {
+        ast_stripe & s = *m_ast_stripes[i];
+        omp_set_lock(&s.m_lock);
+        r += s.m_table.size();
+        omp_unset_lock(&s.m_lock);
+    }
+    return r;
+}
+
 void ast_manager::raise_exception(char const * msg) {
     throw ast_exception(msg);
 }
@@ -1512,6 +1581,7 @@ void ast_manager::copy_families_plugins(ast_manager const & from) {
 }
 
 void ast_manager::set_next_expr_id(unsigned id) {
+    SASSERT(!m_concurrent);
     while (true) {
         id = m_expr_id_gen.set_next_id(id);
         ast_table::iterator it  = m_ast_table.begin();
@@ -1623,6 +1693,8 @@ bool ast_manager::slow_not_contains(ast const * n) {
 ast * ast_manager::register_node_core(ast * n) {
     unsigned h = get_node_hash(n);
     n->m_hash = h;
+    if (m_concurrent)
+        return register_node_concurrent(n);
 #ifdef Z3DEBUG
     bool contains = m_ast_table.contains(n);
     CASSERT("nondet_bug", contains || slow_not_contains(n));
@@ -1659,8 +1731,39 @@ ast * ast_manager::register_node_core(ast * n) {
         SASSERT(!contains);
         SASSERT(m_ast_table.contains(n));
     }
+    init_node(n);
+    return n;
+}
 
-    n->m_id   = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+/**
+   \brief Concurrent version of register_node_core.
+   The new node is initialized while the lock of its stripe is held,
+   so that other threads never retrieve a partially initialized node.
+*/
+ast * ast_manager::register_node_concurrent(ast * n) {
+    ast_stripe & s = get_stripe(n->m_hash);
+    omp_set_lock(&s.m_lock);
+    ast * r = s.m_table.insert_if_not_there(n);
+    if (r == n)
+        init_node(n);
+    omp_unset_lock(&s.m_lock);
+    if (r != n) {
+        if (is_func_decl(r) && to_func_decl(r)->get_range() != to_func_decl(n)->get_range()) {
+            std::ostringstream buffer;
+            buffer << "Recycling of declaration for the same name '" << to_func_decl(r)->get_name().str().c_str() << "'"
+                   << " and domain, but different range type is not permitted";
+            throw ast_exception(buffer.str().c_str());
+        }
+        deallocate_node(n, ::get_node_size(n));
+    }
+    return r;
+}
+
+void ast_manager::init_node(ast * n) {
+    {
+        node_lock lock(*this);
+        n->m_id   = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+    }
 
 
     TRACE("ast", tout << "Object " << n->m_id << " was created.\n";);
@@ -1745,7 +1848,6 @@ ast * ast_manager::register_node_core(ast * n) {
     default:
         break;
     }
-    return n;
 }
 
 void ast_manager::delete_node(ast * n) {
@@ -1816,6 +1918,7 @@ void ast_manager::delete_node(ast * n) {
 }
 
 sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters) {
+    concurrent_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_sort(k, num_parameters, parameters);
@@ -1824,6 +1927,7 @@ sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters,
 
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned arity, sort * const * domain, sort * range) {
+    concurrent_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, arity, domain, range);
@@ -1832,6 +1936,7 @@ func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_p
 
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned num_args, expr * const * args, sort * range) {
+    concurrent_lock lock(*this);
     decl_plugin * p = get_plugin(fid);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, num_args, args, range);
@@ -1872,6 +1977,7 @@ sort * ast_manager::mk_sort(symbol const & name, sort_info * info) {
 }
 
 sort * ast_manager::mk_uninterpreted_sort(symbol const & name, unsigned num_parameters, parameter const * parameters) {
+    concurrent_lock lock(*this);
     user_sort_plugin * plugin = get_user_sort_plugin();
     decl_kind kind = plugin->register_name(name);
     return plugin->mk_sort(kind, num_parameters, parameters);
@@ -2150,6 +2256,7 @@ app * ast_manager::mk_app(func_decl * decl, unsigned num_args, expr * const * ar
 
 func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const & suffix, unsigned arity,
                                             sort * const * domain, sort * range) {
+    concurrent_lock lock(*this);
     func_decl_info info(null_family_id, null_decl_kind);
     info.m_skolem = true;
     SASSERT(info.is_skolem());
@@ -2175,6 +2282,7 @@ func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const
 }
 
 sort * ast_manager::mk_fresh_sort(char const * prefix) {
+    concurrent_lock lock(*this);
     string_buffer<32> buffer;
     buffer << prefix << "!" << m_fresh_id;
     m_fresh_id++;
@@ -2182,6 +2290,7 @@ sort * ast_manager::mk_fresh_sort(char const * prefix) {
 }
 
 symbol ast_manager::mk_fresh_var_name(char const * prefix) {
+    concurrent_lock lock(*this);
     string_buffer<32> buffer;
     buffer << (prefix ? prefix : "var") << "!" << m_fresh_id;
     m_fresh_id++;
@@ -2486,6 +2595,7 @@ expr * ast_manager::get_some_value(sort * s) {
         return v;
     family_id fid = s->get_family_id();
     if (fid != null_family_id) {
+        concurrent_lock lock(*this);
         decl_plugin * p = get_plugin(fid);
         if (p != 0) {
             v = p->get_some_value(s);
@@ -45,6 +45,7 @@ Revision History:
 #include"z3_exception.h"
 #include"dependency.h"
 #include"rlimit.h"
+#include"z3_omp.h"
 
 #define RECYCLE_FREE_AST_INDICES
 
@@ -454,6 +455,18 @@ protected:
         m_ref_count --;
     }
 
+    void inc_ref_atomic() {
+        SASSERT(m_ref_count < UINT_MAX);
+        #pragma omp atomic
+        m_ref_count++;
+    }
+
+    void dec_ref_atomic() {
+        SASSERT(m_ref_count > 0);
+        #pragma omp atomic
+        m_ref_count--;
+    }
+
     ast(ast_kind k):m_id(UINT_MAX), m_kind(k), m_mark1(false), m_mark2(false), m_mark_shared_occs(false), m_ref_count(0) {
         DEBUG_CODE({
             m_mark1_owner = 0;
@@ -1457,6 +1470,41 @@ protected:
     ast_manager *             m_format_manager; // hack for isolating format objects in a different manager.
     symbol                    m_rec_fun;
 
+    /**
+       \brief In concurrent mode, the hash-consing table is partitioned into stripes
+       selected by the hash of the nodes, and each stripe owns its own lock.
+    */
+    struct ast_stripe {
+        omp_lock_t m_lock;
+        ast_table  m_table;
+        ast_stripe() { omp_init_lock(&m_lock); }
+        ~ast_stripe() { omp_destroy_lock(&m_lock); }
+    };
+    static const unsigned     c_num_stripes_log = 6;
+    static const unsigned     c_num_stripes     = 1u << c_num_stripes_log;
+    bool                      m_concurrent;
+    ptr_vector<ast_stripe>    m_ast_stripes;  // empty if !m_concurrent
+    omp_nest_lock_t           m_lock;         // plugins, families and fresh names in concurrent mode
+    omp_lock_t                m_node_lock;    // m_alloc and the id generators in concurrent mode
+
+    // The table uses the low bits of the hash to select a bucket,
+    // so use the high bits to select the stripe.
+    ast_stripe & get_stripe(unsigned h) const { return *m_ast_stripes[h >> (32 - c_num_stripes_log)]; }
+
+    class concurrent_lock {
+        ast_manager & m;
+    public:
+        concurrent_lock(ast_manager const & _m):m(const_cast<ast_manager&>(_m)) { if (m.m_concurrent) omp_set_nest_lock(&m.m_lock); }
+        ~concurrent_lock() { if (m.m_concurrent) omp_unset_nest_lock(&m.m_lock); }
+    };
+
+    class node_lock {
+        ast_manager & m;
+    public:
+        node_lock(ast_manager & _m):m(_m) { if (m.m_concurrent) omp_set_lock(&m.m_node_lock); }
+        ~node_lock() { if (m.m_concurrent) omp_unset_lock(&m.m_node_lock); }
+    };
+
     void init();
 
     bool coercion_needed(func_decl * decl, unsigned num_args, expr * const * args);
@@ -1499,10 +1547,28 @@ public:
 
     small_object_allocator & get_allocator() { return m_alloc; }
 
-    family_id mk_family_id(symbol const & s) { return m_family_manager.mk_family_id(s); }
+    /**
+       \brief Enable/disable the concurrent mode, where several threads share the terms of this manager.
+
+       In concurrent mode, the hash-consing table is striped, reference counters are updated
+       atomically, and the creation of sorts, declarations and terms through the manager
+       (including the calls to its plugins, family ids and fresh names) is thread-safe.
+       A node whose reference counter reaches zero is not deleted, since another thread may be
+       retrieving it from the table. Such nodes are deleted when the mode is disabled.
+
+       The mode must be enabled and disabled when no other thread uses the manager.
+       The other services of the manager (the allocator returned by get_allocator, the array and
+       dependency managers, proofs, marks, compact_memory, compress_ids), the caches of the plugins
+       used without the manager (e.g. arith_util::mk_numeral), and the rewriters and solvers built
+       on top of the manager are not thread-safe.
+    */
+    void set_concurrent(bool f);
+    bool is_concurrent() const { return m_concurrent; }
+
+    family_id mk_family_id(symbol const & s) { concurrent_lock lock(*this); return m_family_manager.mk_family_id(s); }
     family_id mk_family_id(char const * s) { return mk_family_id(symbol(s)); }
 
-    family_id get_family_id(symbol const & s) const { return m_family_manager.get_family_id(s); }
+    family_id get_family_id(symbol const & s) const { concurrent_lock lock(*this); return m_family_manager.get_family_id(s); }
     family_id get_family_id(char const * s) const { return get_family_id(symbol(s)); }
 
     symbol const & get_family_name(family_id fid) const { return m_family_manager.get_name(fid); }
@@ -1560,23 +1626,32 @@ public:
 
     bool are_distinct(expr * a, expr * b) const;
 
-    bool contains(ast * a) const { return m_ast_table.contains(a); }
+    bool contains(ast * a) const;
 
     bool is_rec_fun_def(quantifier* q) const { return q->get_qid() == m_rec_fun; }
     
     symbol const& rec_fun_qid() const { return m_rec_fun; }
 
-    unsigned get_num_asts() const { return m_ast_table.size(); }
+    unsigned get_num_asts() const;
 
     void debug_ref_count() { m_debug_ref_count = true; }
 
     void inc_ref(ast * n) {
-        if (n)
-            n->inc_ref();
+        if (n) {
+            if (m_concurrent)
+                n->inc_ref_atomic();
+            else
+                n->inc_ref();
+        }
     }
 
     void dec_ref(ast * n) {
         if (n) {
+            if (m_concurrent) {
+                // n is deleted by set_concurrent(false) if its counter is still zero.
+                n->dec_ref_atomic();
+                return;
+            }
             n->dec_ref();
             if (n->get_ref_count() == 0)
                 delete_node(n);
@@ -1614,13 +1689,19 @@ protected:
     void delete_node(ast * n);
 
     void * allocate_node(unsigned size) {
+        node_lock lock(*this);
         return m_alloc.allocate(size);
     }
 
     void deallocate_node(ast * n, unsigned sz) {
+        node_lock lock(*this);
         m_alloc.deallocate(sz, n);
     }
 
+    ast * register_node_concurrent(ast * n);
+
+    void init_node(ast * n);
+
 public:
     sort * get_sort(expr const * n) const { return ::get_sort(n); }
     void check_sort(func_decl const * decl, unsigned num_args, expr * const * args) const;
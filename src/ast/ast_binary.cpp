@@ -0,0 +1,671 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Compact binary format for AST DAGs.
+
+    The input is a header followed by a sequence of records.
+    Each record starts with a tag, and unsigned integers are
+    stored using a variable length encoding (7 bits per byte).
+
+    A symbol is referenced by 0 (symbol::null) or 1 + its position in the
+    sequence of symbol records, a family by 1 (null_family_id, used by
+    fresh, skolem and assoc/comm declarations) or 2 + its position in the
+    sequence of family records, and a node by its position in the sequence
+    of node records (sorts, declarations, applications, variables and
+    quantifiers). The family of a sort or declaration without info is
+    written as 0. Declaration kinds are signed, since a declaration
+    without a family has kind null_decl_kind (-1).
+
+Author:
+
+Revision History:
+
+--*/
+#include<string.h>
+#include"ast_binary.h"
+#include"map.h"
+#include"z3_exception.h"
+
+namespace {
+
+    static char const  g_header[]     = { 'Z', '3', 'A', 'S', 'T' };
+    static const unsigned g_header_sz = sizeof(g_header);
+    static const unsigned char g_version = 2;
+    static const unsigned g_null_family = 1;
+
+    enum record_tag {
+        TAG_END = 0,
+        TAG_SYMBOL_STR,
+        TAG_SYMBOL_NUM,
+        TAG_FAMILY,
+        TAG_SORT,
+        TAG_FUNC_DECL,
+        TAG_APP,
+        TAG_VAR,
+        TAG_QUANTIFIER,
+        TAG_ROOT
+    };
+
+    enum sort_size_tag {
+        SS_TAG_INFINITE = 0,
+        SS_TAG_VERY_BIG,
+        SS_TAG_FINITE
+    };
+
+    enum func_decl_flag {
+        FD_LEFT_ASSOC  = 1,
+        FD_RIGHT_ASSOC = 2,
+        FD_FLAT_ASSOC  = 4,
+        FD_COMMUTATIVE = 8,
+        FD_CHAINABLE   = 16,
+        FD_PAIRWISE    = 32,
+        FD_INJECTIVE   = 64,
+        FD_SKOLEM      = 128,
+        FD_IDEMPOTENT  = 256
+    };
+
+    class writer {
+        typedef map<symbol, unsigned, symbol_hash_proc, symbol_eq_proc> symbol2idx;
+        ast_manager &       m;
+        svector<char> &     m_out;
+        symbol2idx          m_symbols;
+        u_map<unsigned>     m_families;
+        obj_map<ast, unsigned> m_nodes;
+        ptr_vector<ast>     m_todo;
+        ptr_buffer<ast>     m_children;
+
+        void write_byte(unsigned char b) { m_out.push_back(static_cast<char>(b)); }
+
+        void write_uint(uint64 n) {
+            while (n >= 0x80) {
+                write_byte(static_cast<unsigned char>(n & 0x7f) | 0x80);
+                n >>= 7;
+            }
+            write_byte(static_cast<unsigned char>(n));
+        }
+
+        void write_int(int n) {
+            // zig-zag encoding
+            write_uint(n < 0 ? ((static_cast<uint64>(-(static_cast<int64>(n))) << 1) - 1) : (static_cast<uint64>(n) << 1));
+        }
+
+        void write_chars(char const * s, unsigned sz) {
+            write_uint(sz);
+            m_out.append(sz, s);
+        }
+
+        unsigned symbol_ref(symbol const & s) {
+            if (s == symbol::null)
+                return 0;
+            unsigned idx;
+            if (m_symbols.find(s, idx))
+                return idx;
+            if (s.is_numerical()) {
+                write_byte(TAG_SYMBOL_NUM);
+                write_uint(s.get_num());
+            }
+            else {
+                char const * str = s.bare_str();
+                write_byte(TAG_SYMBOL_STR);
+                write_chars(str, static_cast<unsigned>(strlen(str)));
+            }
+            idx = m_symbols.size() + 1;
+            m_symbols.insert(s, idx);
+            return idx;
+        }
+
+        unsigned family_ref(family_id fid) {
+            if (fid == null_family_id)
+                return g_null_family;
+            unsigned idx;
+            if (m_families.find(fid, idx))
+                return idx;
+            unsigned name = symbol_ref(m.get_family_name(fid));
+            write_byte(TAG_FAMILY);
+            write_uint(name);
+            idx = m_families.size() + 2;
+            m_families.insert(fid, idx);
+            return idx;
+        }
+
+        unsigned node_ref(ast * n) {
+            unsigned idx = 0;
+            VERIFY(m_nodes.find(n, idx));
+            return idx;
+        }
+
+        // The symbols and families used by a record are written before its tag.
+        void collect_params(decl * d, unsigned_vector & syms) {
+            for (unsigned i = 0; i < d->get_num_parameters(); i++) {
+                parameter const & p = d->get_parameter(i);
+                if (p.is_symbol())
+                    syms.push_back(symbol_ref(p.get_symbol()));
+                else if (p.is_external())
+                    throw default_exception("binary format does not support external parameters");
+            }
+        }
+
+        void write_params(decl * d, unsigned_vector const & syms) {
+            unsigned num = d->get_num_parameters();
+            unsigned j   = 0;
+            write_uint(num);
+            for (unsigned i = 0; i < num; i++) {
+                parameter const & p = d->get_parameter(i);
+                write_byte(static_cast<unsigned char>(p.get_kind()));
+                switch (p.get_kind()) {
+                case parameter::PARAM_INT:
+                    write_int(p.get_int());
+                    break;
+                case parameter::PARAM_AST:
+                    write_uint(node_ref(p.get_ast()));
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    write_uint(syms[j++]);
+                    break;
+                case parameter::PARAM_RATIONAL: {
+                    std::string s = p.get_rational().to_string();
+                    write_chars(s.c_str(), static_cast<unsigned>(s.size()));
+                    break;
+                }
+                case parameter::PARAM_DOUBLE: {
+                    double d = p.get_double();
+                    m_out.append(sizeof(double), reinterpret_cast<char const *>(&d));
+                    break;
+                }
+                default:
+                    UNREACHABLE();
+                }
+            }
+        }
+
+        void write_sort(sort * s) {
+            sort_info * info = s->get_info();
+            unsigned name    = symbol_ref(s->get_name());
+            unsigned fam     = info == 0 ? 0 : family_ref(info->get_family_id());
+            unsigned_vector syms;
+            if (info)
+                collect_params(s, syms);
+            write_byte(TAG_SORT);
+            write_uint(name);
+            write_uint(fam);
+            if (info) {
+                write_int(info->get_decl_kind());
+                sort_size const & sz = info->get_num_elements();
+                if (sz.is_infinite()) {
+                    write_byte(SS_TAG_INFINITE);
+                }
+                else if (sz.is_very_big()) {
+                    write_byte(SS_TAG_VERY_BIG);
+                }
+                else {
+                    write_byte(SS_TAG_FINITE);
+                    write_uint(sz.size());
+                }
+                write_byte(info->private_parameters());
+                write_params(s, syms);
+            }
+        }
+
+        void write_func_decl(func_decl * f) {
+            func_decl_info * info = f->get_info();
+            unsigned name = symbol_ref(f->get_name());
+            unsigned fam  = info == 0 ? 0 : family_ref(info->get_family_id());
+            unsigned_vector syms;
+            if (info)
+                collect_params(f, syms);
+            write_byte(TAG_FUNC_DECL);
+            write_uint(name);
+            write_uint(f->get_arity());
+            for (unsigned i = 0; i < f->get_arity(); i++)
+                write_uint(node_ref(f->get_domain(i)));
+            write_uint(node_ref(f->get_range()));
+            write_uint(fam);
+            if (info) {
+                write_int(info->get_decl_kind());
+                unsigned flags = 0;
+                if (info->is_left_associative())  flags |= FD_LEFT_ASSOC;
+                if (info->is_right_associative()) flags |= FD_RIGHT_ASSOC;
+                if (info->is_flat_associative())  flags |= FD_FLAT_ASSOC;
+                if (info->is_commutative())       flags |= FD_COMMUTATIVE;
+                if (info->is_chainable())         flags |= FD_CHAINABLE;
+                if (info->is_pairwise())          flags |= FD_PAIRWISE;
+                if (info->is_injective())         flags |= FD_INJECTIVE;
+                if (info->is_skolem())            flags |= FD_SKOLEM;
+                if (info->is_idempotent())        flags |= FD_IDEMPOTENT;
+                write_uint(flags);
+                write_params(f, syms);
+            }
+        }
+
+        void write_quantifier(quantifier * q) {
+            unsigned num_decls = q->get_num_decls();
+            unsigned_vector names;
+            for (unsigned i = 0; i < num_decls; i++)
+                names.push_back(symbol_ref(q->get_decl_name(i)));
+            unsigned qid  = symbol_ref(q->get_qid());
+            unsigned skid = symbol_ref(q->get_skid());
+            write_byte(TAG_QUANTIFIER);
+            write_byte(q->is_forall());
+            write_uint(num_decls);
+            for (unsigned i = 0; i < num_decls; i++) {
+                write_uint(node_ref(q->get_decl_sort(i)));
+                write_uint(names[i]);
+            }
+            write_uint(node_ref(q->get_expr()));
+            write_int(q->get_weight());
+            write_uint(qid);
+            write_uint(skid);
+            write_uint(q->get_num_patterns());
+            for (unsigned i = 0; i < q->get_num_patterns(); i++)
+                write_uint(node_ref(q->get_pattern(i)));
+            write_uint(q->get_num_no_patterns());
+            for (unsigned i = 0; i < q->get_num_no_patterns(); i++)
+                write_uint(node_ref(q->get_no_pattern(i)));
+        }
+
+        void write_node(ast * n) {
+            switch (n->get_kind()) {
+            case AST_SORT:
+                write_sort(to_sort(n));
+                break;
+            case AST_FUNC_DECL:
+                write_func_decl(to_func_decl(n));
+                break;
+            case AST_APP: {
+                app * a = to_app(n);
+                write_byte(TAG_APP);
+                write_uint(node_ref(a->get_decl()));
+                write_uint(a->get_num_args());
+                for (unsigned i = 0; i < a->get_num_args(); i++)
+                    write_uint(node_ref(a->get_arg(i)));
+                break;
+            }
+            case AST_VAR:
+                write_byte(TAG_VAR);
+                write_uint(to_var(n)->get_idx());
+                write_uint(node_ref(to_var(n)->get_sort()));
+                break;
+            case AST_QUANTIFIER:
+                write_quantifier(to_quantifier(n));
+                break;
+            default:
+                UNREACHABLE();
+            }
+            m_nodes.insert(n, m_nodes.size());
+        }
+
+        void get_children(ast * n, ptr_buffer<ast> & r) {
+            switch (n->get_kind()) {
+            case AST_SORT:
+            case AST_FUNC_DECL: {
+                decl * d = to_decl(n);
+                for (unsigned i = 0; i < d->get_num_parameters(); i++) {
+                    if (d->get_parameter(i).is_ast())
+                        r.push_back(d->get_parameter(i).get_ast());
+                }
+                if (is_func_decl(n)) {
+                    func_decl * f = to_func_decl(n);
+                    for (unsigned i = 0; i < f->get_arity(); i++)
+                        r.push_back(f->get_domain(i));
+                    r.push_back(f->get_range());
+                }
+                break;
+            }
+            case AST_APP:
+                r.push_back(to_app(n)->get_decl());
+                for (unsigned i = 0; i < to_app(n)->get_num_args(); i++)
+                    r.push_back(to_app(n)->get_arg(i));
+                break;
+            case AST_VAR:
+                r.push_back(to_var(n)->get_sort());
+                break;
+            case AST_QUANTIFIER: {
+                quantifier * q = to_quantifier(n);
+                for (unsigned i = 0; i < q->get_num_decls(); i++)
+                    r.push_back(q->get_decl_sort(i));
+                for (unsigned i = 0; i < q->get_num_children(); i++)
+                    r.push_back(q->get_child(i));
+                break;
+            }
+            default:
+                UNREACHABLE();
+            }
+        }
+
+        void visit(ast * root) {
+            m_todo.push_back(root);
+            while (!m_todo.empty()) {
+                ast * n = m_todo.back();
+                if (m_nodes.contains(n)) {
+                    m_todo.pop_back();
+                    continue;
+                }
+                m_children.reset();
+                get_children(n, m_children);
+                bool visited = true;
+                for (unsigned i = 0; i < m_children.size(); i++) {
+                    if (!m_nodes.contains(m_children[i])) {
+                        m_todo.push_back(m_children[i]);
+                        visited = false;
+                    }
+                }
+                if (visited) {
+                    m_todo.pop_back();
+                    write_node(n);
+                }
+            }
+        }
+
+    public:
+        writer(ast_manager & _m, svector<char> & out):m(_m), m_out(out) {}
+
+        void operator()(unsigned num_roots, ast * const * roots) {
+            m_out.append(g_header_sz, g_header);
+            write_byte(g_version);
+            for (unsigned i = 0; i < num_roots; i++) {
+                visit(roots[i]);
+                write_byte(TAG_ROOT);
+                write_uint(node_ref(roots[i]));
+            }
+            write_byte(TAG_END);
+        }
+    };
+
+    class reader {
+        ast_manager &       m;
+        char const *        m_curr;
+        char const *        m_end;
+        svector<symbol>     m_symbols;
+        svector<family_id>  m_families;
+        ast_ref_vector      m_nodes;
+        ast_ref_vector &    m_result;
+
+        void error() {
+            throw default_exception("invalid binary AST input");
+        }
+
+        unsigned char read_byte() {
+            if (m_curr == m_end)
+                error();
+            return static_cast<unsigned char>(*m_curr++);
+        }
+
+        uint64 read_uint64() {
+            uint64 r = 0;
+            unsigned shift = 0;
+            while (true) {
+                unsigned char b = read_byte();
+                if (shift > 63)
+                    error();
+                r |= static_cast<uint64>(b & 0x7f) << shift;
+                if ((b & 0x80) == 0)
+                    return r;
+                shift += 7;
+            }
+        }
+
+        unsigned read_uint() {
+            uint64 r = read_uint64();
+            if (r > UINT_MAX)
+                error();
+            return static_cast<unsigned>(r);
+        }
+
+        int read_int() {
+            uint64 r = read_uint64();
+            int64 v = (r & 1) ? -static_cast<int64>(r >> 1) - 1 : static_cast<int64>(r >> 1);
+            if (v < INT_MIN || v > INT_MAX)
+                error();
+            return static_cast<int>(v);
+        }
+
+        char const * read_chars(unsigned & sz) {
+            sz = read_uint();
+            if (static_cast<size_t>(m_end - m_curr) < sz)
+                error();
+            char const * r = m_curr;
+            m_curr += sz;
+            return r;
+        }
+
+        symbol read_symbol() {
+            unsigned idx = read_uint();
+            if (idx == 0)
+                return symbol::null;
+            if (idx > m_symbols.size())
+                error();
+            return m_symbols[idx - 1];
+        }
+
+        family_id to_family(unsigned idx) {
+            if (idx == g_null_family)
+                return null_family_id;
+            if (idx == 0 || idx > m_families.size() + 1)
+                error();
+            return m_families[idx - 2];
+        }
+
+        ast * read_node() {
+            unsigned idx = read_uint();
+            if (idx >= m_nodes.size())
+                error();
+            return m_nodes.get(idx);
+        }
+
+        sort * read_sort() {
+            ast * n = read_node();
+            if (!is_sort(n))
+                error();
+            return to_sort(n);
+        }
+
+        expr * read_expr() {
+            ast * n = read_node();
+            if (!is_expr(n))
+                error();
+            return to_expr(n);
+        }
+
+        void read_params(vector<parameter> & ps) {
+            unsigned num = read_uint();
+            for (unsigned i = 0; i < num; i++) {
+                switch (read_byte()) {
+                case parameter::PARAM_INT:
+                    ps.push_back(parameter(read_int()));
+                    break;
+                case parameter::PARAM_AST:
+                    ps.push_back(parameter(read_node()));
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    ps.push_back(parameter(read_symbol()));
+                    break;
+                case parameter::PARAM_RATIONAL: {
+                    unsigned sz;
+                    char const * s = read_chars(sz);
+                    std::string str(s, sz);
+                    ps.push_back(parameter(rational(str.c_str())));
+                    break;
+                }
+                case parameter::PARAM_DOUBLE: {
+                    double d;
+                    if (static_cast<size_t>(m_end - m_curr) < sizeof(double))
+                        error();
+                    memcpy(&d, m_curr, sizeof(double));
+                    m_curr += sizeof(double);
+                    ps.push_back(parameter(d));
+                    break;
+                }
+                default:
+                    error();
+                }
+            }
+        }
+
+        void read_sort_rec() {
+            symbol name   = read_symbol();
+            unsigned fam  = read_uint();
+            if (fam == 0) {
+                m_nodes.push_back(m.mk_uninterpreted_sort(name));
+                return;
+            }
+            family_id fid = to_family(fam);
+            decl_kind k   = read_int();
+            sort_size sz;
+            switch (read_byte()) {
+            case SS_TAG_INFINITE: sz = sort_size::mk_infinite(); break;
+            case SS_TAG_VERY_BIG: sz = sort_size::mk_very_big(); break;
+            case SS_TAG_FINITE:   sz = sort_size::mk_finite(read_uint64()); break;
+            default: error();
+            }
+            bool private_params = read_byte() != 0;
+            vector<parameter> ps;
+            read_params(ps);
+            m_nodes.push_back(m.mk_sort(name, sort_info(fid, k, sz, ps.size(), ps.c_ptr(), private_params)));
+        }
+
+        void read_func_decl_rec() {
+            symbol name    = read_symbol();
+            unsigned arity = read_uint();
+            ptr_buffer<sort> domain;
+            for (unsigned i = 0; i < arity; i++)
+                domain.push_back(read_sort());
+            sort * range   = read_sort();
+            unsigned fam   = read_uint();
+            if (fam == 0) {
+                m_nodes.push_back(m.mk_func_decl(name, arity, domain.c_ptr(), range));
+                return;
+            }
+            family_id fid  = to_family(fam);
+            decl_kind k    = read_int();
+            unsigned flags = read_uint();
+            vector<parameter> ps;
+            read_params(ps);
+            func_decl_info info(fid, k, ps.size(), ps.c_ptr());
+            info.set_left_associative((flags & FD_LEFT_ASSOC) != 0);
+            info.set_right_associative((flags & FD_RIGHT_ASSOC) != 0);
+            info.set_flat_associative((flags & FD_FLAT_ASSOC) != 0);
+            info.set_commutative((flags & FD_COMMUTATIVE) != 0);
+            info.set_chainable((flags & FD_CHAINABLE) != 0);
+            info.set_pairwise((flags & FD_PAIRWISE) != 0);
+            info.set_injective((flags & FD_INJECTIVE) != 0);
+            info.set_skolem((flags & FD_SKOLEM) != 0);
+            info.set_idempotent((flags & FD_IDEMPOTENT) != 0);
+            m_nodes.push_back(m.mk_func_decl(name, arity, domain.c_ptr(), range, info));
+        }
+
+        void read_app_rec() {
+            ast * d = read_node();
+            if (!is_func_decl(d))
+                error();
+            unsigned num_args = read_uint();
+            ptr_buffer<expr> args;
+            for (unsigned i = 0; i < num_args; i++)
+                args.push_back(read_expr());
+            m_nodes.push_back(m.mk_app(to_func_decl(d), num_args, args.c_ptr()));
+        }
+
+        void read_quantifier_rec() {
+            bool forall        = read_byte() != 0;
+            unsigned num_decls = read_uint();
+            ptr_buffer<sort> sorts;
+            buffer<symbol>   names;
+            for (unsigned i = 0; i < num_decls; i++) {
+                sorts.push_back(read_sort());
+                names.push_back(read_symbol());
+            }
+            expr * body   = read_expr();
+            int weight    = read_int();
+            symbol qid    = read_symbol();
+            symbol skid   = read_symbol();
+            ptr_buffer<expr> pats, no_pats;
+            unsigned num_pats = read_uint();
+            for (unsigned i = 0; i < num_pats; i++)
+                pats.push_back(read_expr());
+            unsigned num_no_pats = read_uint();
+            for (unsigned i = 0; i < num_no_pats; i++)
+                no_pats.push_back(read_expr());
+            m_nodes.push_back(m.mk_quantifier(forall, num_decls, sorts.c_ptr(), names.c_ptr(), body, weight, qid, skid,
+                                              num_pats, pats.c_ptr(), num_no_pats, no_pats.c_ptr()));
+        }
+
+    public:
+        reader(ast_manager & _m, char const * begin, char const * end, ast_ref_vector & result):
+            m(_m), m_curr(begin), m_end(end), m_nodes(_m), m_result(result) {}
+
+        void operator()() {
+            if (!is_ast_binary(m_curr, m_end))
+                error();
+            m_curr += g_header_sz;
+            if (read_byte() != g_version)
+                throw default_exception("unsupported version of the binary AST format");
+            while (true) {
+                switch (read_byte()) {
+                case TAG_END:
+                    return;
+                case TAG_SYMBOL_STR: {
+                    unsigned sz;
+                    char const * s = read_chars(sz);
+                    std::string str(s, sz);
+                    m_symbols.push_back(symbol(str.c_str()));
+                    break;
+                }
+                case TAG_SYMBOL_NUM:
+                    m_symbols.push_back(symbol(read_uint()));
+                    break;
+                case TAG_FAMILY: {
+                    symbol name = read_symbol();
+                    if (!m.has_plugin(name))
+                        throw default_exception(default_exception::fmt(), "binary AST input uses unknown theory '%s'", name.str().c_str());
+                    m_families.push_back(m.get_family_id(name));
+                    break;
+                }
+                case TAG_SORT:
+                    read_sort_rec();
+                    break;
+                case TAG_FUNC_DECL:
+                    read_func_decl_rec();
+                    break;
+                case TAG_APP:
+                    read_app_rec();
+                    break;
+                case TAG_VAR: {
+                    unsigned idx = read_uint();
+                    m_nodes.push_back(m.mk_var(idx, read_sort()));
+                    break;
+                }
+                case TAG_QUANTIFIER:
+                    read_quantifier_rec();
+                    break;
+                case TAG_ROOT:
+                    m_result.push_back(read_node());
+                    break;
+                default:
+                    error();
+                }
+            }
+        }
+    };
+
+};
+
+void ast_to_binary(ast_manager & m, unsigned num_roots, ast * const * roots, std::ostream & out) {
+    svector<char> buffer;
+    writer w(m, buffer);
+    w(num_roots, roots);
+    out.write(buffer.c_ptr(), buffer.size());
+}
+
+void ast_from_binary(ast_manager & m, char const * begin, char const * end, ast_ref_vector & result) {
+    reader r(m, begin, end, result);
+    r();
+}
+
+bool is_ast_binary(char const * begin, char const * end) {
+    return static_cast<size_t>(end - begin) > g_header_sz && memcmp(begin, g_header, g_header_sz) == 0;
+}
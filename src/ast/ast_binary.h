@@ -0,0 +1,49 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.h
+
+Abstract:
+
+    Compact binary format for AST DAGs.
+
+    Sharing is preserved: each node (sort, declaration, application,
+    variable or quantifier) is written once, after its children, and
+    referenced by its position. Symbols and families are also written
+    only once. Declarations and sorts are reconstructed in the target
+    manager as in ast_translation, families are matched by name.
+
+    Parameters of kind PARAM_EXTERNAL (e.g., floating point numerals and
+    irrational algebraic numbers) are not supported.
+
+Author:
+
+Revision History:
+
+--*/
+#ifndef AST_BINARY_H_
+#define AST_BINARY_H_
+
+#include<iostream>
+#include"ast.h"
+
+/**
+   \brief Write the DAG rooted at roots in binary format.
+   Throws default_exception if an AST cannot be serialized.
+*/
+void ast_to_binary(ast_manager & m, unsigned num_roots, ast * const * roots, std::ostream & out);
+
+/**
+   \brief Read the roots stored in the binary format in [begin, end), and
+   append them to result. Throws default_exception if the input is not valid.
+*/
+void ast_from_binary(ast_manager & m, char const * begin, char const * end, ast_ref_vector & result);
+
+/**
+   \brief Return true if [begin, end) starts with the header of the binary format.
+*/
+bool is_ast_binary(char const * begin, char const * end);
+
+#endif
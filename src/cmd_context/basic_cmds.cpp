@@ -15,6 +15,7 @@ Author:
 Notes:
 
 --*/
+#include<fstream>
 #include"cmd_context.h"
 #include"version.h"
 #include"ast_smt_pp.h"
@@ -28,6 +29,9 @@ Notes:
 #include"eval_cmd.h"
 #include"gparams.h"
 #include"env_params.h"
+#include"ast_binary.h"
+#include"mapped_file.h"
+#include"decl_collector.h"
 
 class help_cmd : public cmd {
     svector<symbol> m_cmds;
@@ -235,6 +239,59 @@ UNARY_CMD(pp_cmd, "display", "<term>", "display the given term.", CPK_EXPR, expr
 
 UNARY_CMD(echo_cmd, "echo", "<string>", "display the given string", CPK_STRING, char const *, ctx.regular_stream() << arg << std::endl;);
 
+UNARY_CMD(save_binary_cmd, "save-binary", "<string>", "save the asserted formulas in the given file using a compact binary format", CPK_STRING, char const *, {
+    std::ofstream out(arg, std::ios::out | std::ios::binary);
+    if (out.bad() || out.fail())
+        throw cmd_exception(std::string("failed to open file '") + arg + "'");
+    ptr_buffer<ast> fmls;
+    ptr_vector<expr>::const_iterator it  = ctx.begin_assertions();
+    ptr_vector<expr>::const_iterator end = ctx.end_assertions();
+    for (; it != end; ++it)
+        fmls.push_back(*it);
+    ast_to_binary(ctx.m(), fmls.size(), fmls.c_ptr(), out);
+    ctx.print_success();
+});
+
+// Declare the uninterpreted sorts and functions used in fmls that are not declared in ctx yet.
+static void declare_binary_decls(cmd_context & ctx, ast_ref_vector const & fmls) {
+    decl_collector decls(ctx.m(), false);
+    for (unsigned i = 0; i < fmls.size(); i++)
+        decls.visit(fmls.get(i));
+    for (unsigned i = 0; i < decls.get_num_sorts(); i++) {
+        sort * s = decls.get_sorts()[i];
+        if (ctx.m().is_uninterp(s) && s->get_num_parameters() == 0 && !ctx.find_psort_decl(s->get_name()))
+            ctx.insert(ctx.pm().mk_psort_user_decl(0, s->get_name(), 0));
+    }
+    for (unsigned i = 0; i < decls.get_num_decls(); i++) {
+        func_decl * f = decls.get_func_decls()[i];
+        func_decl * g = 0;
+        try {
+            g = ctx.find_func_decl(f->get_name(), 0, 0, f->get_arity(), f->get_domain(), f->get_range());
+        }
+        catch (cmd_exception &) {
+            // not declared
+        }
+        if (f != g)
+            ctx.insert(f);
+    }
+}
+
+UNARY_CMD(load_binary_cmd, "load-binary", "<string>", "assert the formulas stored in the given file by save-binary", CPK_STRING, char const *, {
+    mapped_file in;
+    if (!in.open(arg))
+        throw cmd_exception(std::string("failed to open file '") + arg + "'");
+    ast_ref_vector fmls(ctx.m());
+    ast_from_binary(ctx.m(), in.begin(), in.end(), fmls);
+    for (unsigned i = 0; i < fmls.size(); i++) {
+        if (!is_expr(fmls.get(i)) || !ctx.m().is_bool(to_expr(fmls.get(i))))
+            throw cmd_exception("invalid load-binary command, file contains an object that is not a Boolean term");
+    }
+    declare_binary_decls(ctx, fmls);
+    for (unsigned i = 0; i < fmls.size(); i++)
+        ctx.assert_expr(to_expr(fmls.get(i)));
+    ctx.print_success();
+});
+
 
 class set_get_option_cmd : public cmd {
 protected:
@@ -794,6 +851,8 @@ void install_ext_basic_cmds(cmd_context & ctx) {
     ctx.insert(alloc(pp_cmd));
     ctx.insert(alloc(get_model_cmd));
     ctx.insert(alloc(echo_cmd));
+    ctx.insert(alloc(save_binary_cmd));
+    ctx.insert(alloc(load_binary_cmd));
     ctx.insert(alloc(labels_cmd));
     ctx.insert(alloc(declare_map_cmd));
     ctx.insert(alloc(builtin_cmd, "reset", 0, "reset the shell (all declarations and assertions will be erased)"));
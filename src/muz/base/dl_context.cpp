@@ -286,6 +286,8 @@ namespace datalog {
     bool context::default_table_checked() const { return m_params->datalog_default_table_checked(); }
     bool context::dbg_fpr_nonempty_relation_signature() const { return m_params->datalog_dbg_fpr_nonempty_relation_signature(); }
     unsigned context::dl_profile_milliseconds_threshold() const { return m_params->datalog_profile_timeout_milliseconds(); }
+    unsigned context::num_threads() const { return m_params->datalog_threads(); }
+    unsigned context::join_partition_threshold() const { return m_params->datalog_join_partition_threshold(); }
     bool context::all_or_nothing_deltas() const { return m_params->datalog_all_or_nothing_deltas(); }
     bool context::compile_with_widening() const { return m_params->datalog_compile_with_widening(); }
     bool context::unbound_compressor() const { return m_unbound_compressor; }
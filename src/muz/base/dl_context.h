@@ -256,6 +256,8 @@ namespace datalog {
         bool default_table_checked() const;
         bool dbg_fpr_nonempty_relation_signature() const;
         unsigned dl_profile_milliseconds_threshold() const;
+        unsigned num_threads() const;
+        unsigned join_partition_threshold() const;
         bool all_or_nothing_deltas() const;
         bool compile_with_widening() const;
         bool unbound_compressor() const;
@@ -190,6 +190,13 @@ namespace datalog {
         class join_fn : public base_fn {
         public:
             virtual base_object * operator()(const base_object & t1, const base_object & t2) = 0;
+
+            /**
+               \brief Build the state of \c t1 and \c t2 that \c operator() would compute lazily
+               (e.g., indexes), so that afterwards it only reads them and can be applied 
+               concurrently with other operations reading the same objects.
+            */
+            virtual void prepare(const base_object & t1, const base_object & t2) {}
         };
 
         class transformer_fn : public base_fn {
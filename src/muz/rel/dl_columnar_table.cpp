@@ -0,0 +1,699 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_columnar_table.cpp
+
+Abstract:
+
+    Table that stores its facts column by column, with bit-packed
+    or dictionary encoded columns.
+
+Author:
+
+Revision History:
+
+--*/
+
+#include<algorithm>
+#include"dl_columnar_table.h"
+#include"dl_relation_manager.h"
+
+namespace datalog {
+
+    // -----------------------------------
+    //
+    // columnar_column
+    //
+    // -----------------------------------
+
+    columnar_column::columnar_column(table_sort domain) : m_log_width(0), m_dict(false) {
+        unsigned bits = 1;
+        if (domain > 2) {
+            bits = uint64_log2(domain - 1) + 1;
+        }
+        if (domain == 0 || bits > max_plain_width) {
+            m_dict = true;
+        }
+        else {
+            while (width() < bits) {
+                ++m_log_width;
+            }
+        }
+    }
+
+    columnar_column::columnar_column(columnar_column const & src, unsigned_vector const & rows) :
+        m_log_width(src.m_log_width),
+        m_dict(src.m_dict),
+        m_values(src.m_values),
+        m_codes(src.m_codes) {
+        resize(rows.size());
+        for (unsigned i = 0; i < rows.size(); ++i) {
+            set_code(i, src.get_code(rows[i]));
+        }
+    }
+
+    uint64 columnar_column::broadcast(uint64 code) const {
+        uint64 result = 0;
+        for (unsigned i = 0; i < (1u << log_codes_per_word()); ++i) {
+            result |= code << (i << m_log_width);
+        }
+        return result;
+    }
+
+    void columnar_column::set_code(unsigned row, uint64 code) {
+        SASSERT(code <= code_mask());
+        uint64 & w = m_words[row >> log_codes_per_word()];
+        unsigned shift = (row & ((1u << log_codes_per_word()) - 1)) << m_log_width;
+        w = (w & ~(code_mask() << shift)) | (code << shift);
+    }
+
+    void columnar_column::widen(unsigned num_rows) {
+        SASSERT(m_log_width < 6);
+        svector<uint64> words;
+        words.swap(m_words);
+        unsigned log_cpw = log_codes_per_word();
+        uint64   mask    = code_mask();
+        unsigned w       = width();
+        ++m_log_width;
+        resize(num_rows);
+        for (unsigned row = 0; row < num_rows; ++row) {
+            uint64 code = (words[row >> log_cpw] >> ((row & ((1u << log_cpw) - 1)) * w)) & mask;
+            set_code(row, code);
+        }
+    }
+
+    bool columnar_column::find_code(table_element val, uint64 & code) const {
+        if (!m_dict) {
+            code = val;
+            return val <= code_mask();
+        }
+        unsigned c;
+        if (!m_codes.find(val, c)) {
+            return false;
+        }
+        code = c;
+        return true;
+    }
+
+    uint64 columnar_column::mk_code(table_element val, unsigned num_rows) {
+        uint64 code = val;
+        if (m_dict) {
+            unsigned c;
+            if (m_codes.find(val, c)) {
+                return c;
+            }
+            code = m_values.size();
+            m_codes.insert(val, m_values.size());
+            m_values.push_back(val);
+        }
+        while (code > code_mask()) {
+            widen(num_rows);
+        }
+        return code;
+    }
+
+    void columnar_column::resize(unsigned num_rows) {
+        unsigned log_cpw = log_codes_per_word();
+        m_words.resize((num_rows + (1u << log_cpw) - 1) >> log_cpw, 0);
+    }
+
+    void columnar_column::reset() {
+        m_words.reset();
+    }
+
+    void columnar_column::keep_rows(unsigned_vector const & rows) {
+        for (unsigned i = 0; i < rows.size(); ++i) {
+            SASSERT(i <= rows[i]);
+            set_code(i, get_code(rows[i]));
+        }
+        resize(rows.size());
+    }
+
+    void columnar_column::find_equal(uint64 code, unsigned num_rows, unsigned_vector & rows) const {
+        unsigned cpw     = 1u << log_codes_per_word();
+        unsigned top_bit = width() - 1;
+        uint64 pattern   = broadcast(code);
+        // all bits of each code except for the highest one
+        uint64 low       = broadcast(code_mask() >> 1);
+        for (unsigned i = 0, row = 0; row < num_rows; ++i, row += cpw) {
+            uint64 x = m_words[i] ^ pattern;
+            // the highest bit of a code in z is set iff the code in x is 0
+            uint64 z = ~(((x & low) + low) | x | low);
+            if (z == 0) {
+                continue;
+            }
+            unsigned end = std::min(cpw, num_rows - row);
+            for (unsigned j = 0; j < end; ++j) {
+                if ((z >> ((j << m_log_width) + top_bit)) & 1) {
+                    rows.push_back(row + j);
+                }
+            }
+        }
+    }
+
+    void columnar_column::filter_identical(columnar_column const & other, unsigned num_rows,
+                                           unsigned_vector & rows) const {
+        unsigned j = 0;
+        if (!m_dict && !other.m_dict && m_log_width == other.m_log_width) {
+            // the columns use the same encoding, compare the codes of whole words at once
+            unsigned log_cpw = log_codes_per_word();
+            unsigned top_bit = width() - 1;
+            uint64 low       = broadcast(code_mask() >> 1);
+            unsigned last    = UINT_MAX;
+            uint64 z         = 0;
+            for (unsigned i = 0; i < rows.size(); ++i) {
+                unsigned row = rows[i];
+                unsigned wi  = row >> log_cpw;
+                if (wi != last) {
+                    uint64 x = m_words[wi] ^ other.m_words[wi];
+                    z = ~(((x & low) + low) | x | low);
+                    last = wi;
+                }
+                if ((z >> (((row & ((1u << log_cpw) - 1)) << m_log_width) + top_bit)) & 1) {
+                    rows[j++] = row;
+                }
+            }
+        }
+        else {
+            for (unsigned i = 0; i < rows.size(); ++i) {
+                if (get(rows[i]) == other.get(rows[i])) {
+                    rows[j++] = rows[i];
+                }
+            }
+        }
+        rows.shrink(j);
+    }
+
+    unsigned columnar_column::get_size_estimate_bytes() const {
+        return m_words.size()*sizeof(uint64) + m_values.size()*2*sizeof(table_element);
+    }
+
+    // -----------------------------------
+    //
+    // columnar_table
+    //
+    // -----------------------------------
+
+    unsigned columnar_table::row_hash_proc::operator()(unsigned row) const {
+        unsigned h = 17;
+        for (unsigned i = 0; i < m_table.m_columns.size(); ++i) {
+            h = combine_hash(h, hash_ull(m_table.get_code(row, i)));
+        }
+        return h;
+    }
+
+    bool columnar_table::row_eq_proc::operator()(unsigned r1, unsigned r2) const {
+        for (unsigned i = 0; i < m_table.m_columns.size(); ++i) {
+            if (m_table.get_code(r1, i) != m_table.get_code(r2, i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    columnar_table::columnar_table(columnar_table_plugin & plugin, const table_signature & sig)
+        : table_base(plugin, sig),
+          m_size(0),
+          m_index(DEFAULT_HASHTABLE_INITIAL_CAPACITY, row_hash_proc(*this), row_eq_proc(*this)) {
+        for (unsigned i = 0; i < sig.size(); ++i) {
+            m_columns.push_back(columnar_column(sig[i]));
+        }
+        m_probe.resize(sig.size(), 0);
+    }
+
+    bool columnar_table::mk_probe(const table_element * f) const {
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            if (!m_columns[i].find_code(f[i], m_probe[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void columnar_table::reset_index() {
+        m_index.reset();
+        for (unsigned row = 0; row < m_size; ++row) {
+            m_index.insert(row);
+        }
+    }
+
+    void columnar_table::keep_rows(unsigned_vector const & rows) {
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            m_columns[i].keep_rows(rows);
+        }
+        m_size = rows.size();
+        reset_index();
+    }
+
+    void columnar_table::remove_duplicates() {
+        m_index.reset();
+        unsigned_vector rows;
+        for (unsigned row = 0; row < m_size; ++row) {
+            if (!m_index.contains(row)) {
+                m_index.insert(row);
+                rows.push_back(row);
+            }
+        }
+        if (rows.size() < m_size) {
+            keep_rows(rows);
+        }
+    }
+
+    bool columnar_table::add_probe() {
+        if (m_index.contains(probe_row)) {
+            return false;
+        }
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            m_columns[i].resize(m_size + 1);
+            m_columns[i].set_code(m_size, m_probe[i]);
+        }
+        m_index.insert(m_size);
+        ++m_size;
+        return true;
+    }
+
+    void columnar_table::add_fact(const table_fact & f) {
+        SASSERT(f.size() == m_columns.size());
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            m_probe[i] = m_columns[i].mk_code(f[i], m_size);
+        }
+        add_probe();
+    }
+
+    void columnar_table::remove_fact(const table_element* fact) {
+        unsigned row;
+        if (!mk_probe(fact) || !m_index.find(probe_row, row)) {
+            return;
+        }
+        m_index.remove(row);
+        unsigned last = m_size - 1;
+        if (row != last) {
+            // move the last row into the gap
+            m_index.remove(last);
+            for (unsigned i = 0; i < m_columns.size(); ++i) {
+                m_columns[i].set_code(row, m_columns[i].get_code(last));
+            }
+            m_index.insert(row);
+        }
+        --m_size;
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            m_columns[i].resize(m_size);
+        }
+    }
+
+    bool columnar_table::contains_fact(const table_fact & f) const {
+        return mk_probe(f.c_ptr()) && m_index.contains(probe_row);
+    }
+
+    void columnar_table::reset() {
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            m_columns[i].reset();
+        }
+        m_size = 0;
+        m_index.reset();
+    }
+
+    table_base * columnar_table::clone() const {
+        columnar_table * res = static_cast<columnar_table *>(get_plugin().mk_empty(get_signature()));
+        res->m_columns.reset();
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            res->m_columns.push_back(m_columns[i]);
+        }
+        res->m_size = m_size;
+        res->reset_index();
+        return res;
+    }
+
+    unsigned columnar_table::get_size_estimate_bytes() const {
+        unsigned sz = m_index.capacity()*sizeof(unsigned);
+        for (unsigned i = 0; i < m_columns.size(); ++i) {
+            sz += m_columns[i].get_size_estimate_bytes();
+        }
+        return sz;
+    }
+
+    class columnar_table::our_iterator_core : public iterator_core {
+        const columnar_table & m_table;
+        unsigned               m_row;
+
+        // the values of a row are decoded only when they are accessed.
+        class our_row : public row_interface {
+            const our_iterator_core & m_parent;
+        public:
+            our_row(const our_iterator_core & parent) : row_interface(parent.m_table), m_parent(parent) {}
+
+            virtual table_element operator[](unsigned col) const {
+                return m_parent.m_table.get_cell(m_parent.m_row, col);
+            }
+        };
+
+        our_row m_row_obj;
+
+    public:
+        our_iterator_core(const columnar_table & t, bool finished) :
+            m_table(t), m_row(finished ? t.m_size : 0), m_row_obj(*this) {}
+
+        virtual bool is_finished() const {
+            return m_row == m_table.m_size;
+        }
+
+        virtual row_interface & operator*() {
+            SASSERT(!is_finished());
+            return m_row_obj;
+        }
+
+        virtual void operator++() {
+            SASSERT(!is_finished());
+            ++m_row;
+        }
+    };
+
+    table_base::iterator columnar_table::begin() const {
+        return mk_iterator(alloc(our_iterator_core, *this, false));
+    }
+
+    table_base::iterator columnar_table::end() const {
+        return mk_iterator(alloc(our_iterator_core, *this, true));
+    }
+
+    // -----------------------------------
+    //
+    // columnar_table_plugin
+    //
+    // -----------------------------------
+
+    columnar_table const& columnar_table_plugin::get(table_base const& t) {
+        return static_cast<columnar_table const&>(t);
+    }
+
+    columnar_table& columnar_table_plugin::get(table_base& t) {
+        return static_cast<columnar_table&>(t);
+    }
+
+    table_base * columnar_table_plugin::mk_empty(const table_signature & s) {
+        SASSERT(can_handle_signature(s));
+        return alloc(columnar_table, *this, s);
+    }
+
+    /**
+       Hash join: the rows of the smaller table are indexed by the codes of their joined columns,
+       and the values of the other table are translated into these codes. The columns of the
+       result keep the encoding of the columns they are copied from.
+    */
+    class columnar_table_plugin::join_project_fn : public convenient_table_join_project_fn {
+
+        /**
+           Rows of a table indexed by the codes in the columns \c m_cols. The index holds the
+           first row of each key, the other rows with the same key are chained by \c m_next.
+        */
+        class key_index {
+            struct key_hash_proc {
+                key_index const & m_index;
+                key_hash_proc(key_index const & i) : m_index(i) {}
+                unsigned operator()(unsigned row) const {
+                    unsigned h = 17;
+                    for (unsigned i = 0; i < m_index.m_cols.size(); ++i) {
+                        h = combine_hash(h, hash_ull(m_index.get_code(row, i)));
+                    }
+                    return h;
+                }
+            };
+
+            struct key_eq_proc {
+                key_index const & m_index;
+                key_eq_proc(key_index const & i) : m_index(i) {}
+                bool operator()(unsigned r1, unsigned r2) const {
+                    for (unsigned i = 0; i < m_index.m_cols.size(); ++i) {
+                        if (m_index.get_code(r1, i) != m_index.get_code(r2, i)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+            };
+
+            columnar_table const &  m_table;
+            unsigned_vector const & m_cols;
+            svector<uint64>         m_probe;
+            unsigned_vector         m_next;
+            hashtable<unsigned, key_hash_proc, key_eq_proc> m_first;
+
+            uint64 get_code(unsigned row, unsigned i) const {
+                return row == columnar_table::probe_row ? m_probe[i] : m_table.m_columns[m_cols[i]].get_code(row);
+            }
+
+        public:
+            key_index(columnar_table const & t, unsigned_vector const & cols) :
+                m_table(t),
+                m_cols(cols),
+                m_first(DEFAULT_HASHTABLE_INITIAL_CAPACITY, key_hash_proc(*this), key_eq_proc(*this)) {
+                m_probe.resize(cols.size(), 0);
+                m_next.resize(t.m_size, UINT_MAX);
+                for (unsigned row = 0; row < t.m_size; ++row) {
+                    unsigned first;
+                    if (m_first.find(row, first)) {
+                        m_next[row] = m_next[first];
+                        m_next[first] = row;
+                    }
+                    else {
+                        m_first.insert(row);
+                    }
+                }
+            }
+
+            /**
+               \brief Set the key to the row \c row of \c t in the columns \c cols. Return false
+               if the indexed table contains none of its values.
+            */
+            bool set_key(columnar_table const & t, unsigned_vector const & cols, unsigned row) {
+                for (unsigned i = 0; i < cols.size(); ++i) {
+                    if (!m_table.m_columns[m_cols[i]].find_code(t.get_cell(row, cols[i]), m_probe[i])) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+               \brief Return the first row with the key, or UINT_MAX if there is none.
+            */
+            unsigned first() const {
+                unsigned row;
+                return m_first.find(columnar_table::probe_row, row) ? row : UINT_MAX;
+            }
+
+            unsigned next(unsigned row) const { return m_next[row]; }
+        };
+
+    public:
+        join_project_fn(const table_signature & t1_sig, const table_signature & t2_sig, unsigned col_cnt, 
+                const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt, 
+                const unsigned * removed_cols) 
+            : convenient_table_join_project_fn(t1_sig, t2_sig, col_cnt, cols1, cols2, 
+                removed_col_cnt, removed_cols) {}
+
+        virtual table_base * operator()(const table_base & tb1, const table_base & tb2) {
+            const columnar_table & t1 = get(tb1);
+            const columnar_table & t2 = get(tb2);
+
+            // the rows of the result, as pairs of rows of t1 and t2
+            unsigned_vector rows1, rows2;
+            if (t1.m_size <= t2.m_size) {
+                key_index index(t1, m_cols1);
+                for (unsigned row = 0; row < t2.m_size; ++row) {
+                    if (!index.set_key(t2, m_cols2, row)) {
+                        continue;
+                    }
+                    for (unsigned r = index.first(); r != UINT_MAX; r = index.next(r)) {
+                        rows1.push_back(r);
+                        rows2.push_back(row);
+                    }
+                }
+            }
+            else {
+                key_index index(t2, m_cols2);
+                for (unsigned row = 0; row < t1.m_size; ++row) {
+                    if (!index.set_key(t1, m_cols1, row)) {
+                        continue;
+                    }
+                    for (unsigned r = index.first(); r != UINT_MAX; r = index.next(r)) {
+                        rows1.push_back(row);
+                        rows2.push_back(r);
+                    }
+                }
+            }
+
+            columnar_table & res = get(*t1.get_plugin().mk_empty(get_result_signature()));
+            res.m_columns.reset();
+            unsigned n1 = t1.m_columns.size();
+            for (unsigned i = 0, r = 0; i < n1 + t2.m_columns.size(); ++i) {
+                if (r < m_removed_cols.size() && m_removed_cols[r] == i) {
+                    ++r;
+                }
+                else if (i < n1) {
+                    res.m_columns.push_back(columnar_column(t1.m_columns[i], rows1));
+                }
+                else {
+                    res.m_columns.push_back(columnar_column(t2.m_columns[i - n1], rows2));
+                }
+            }
+            res.m_size = rows1.size();
+            if (m_removed_cols.empty()) {
+                res.reset_index();
+            }
+            else {
+                res.remove_duplicates();
+            }
+            return &res;
+        }
+    };
+
+    table_join_fn * columnar_table_plugin::mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2) {
+        return mk_join_project_fn(t1, t2, col_cnt, cols1, cols2, 0, static_cast<unsigned*>(0));
+    }
+
+    table_join_fn * columnar_table_plugin::mk_join_project_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt, 
+            const unsigned * removed_cols) {
+        if (t1.get_kind() != get_kind() || t2.get_kind() != get_kind() 
+            || removed_col_cnt == t1.get_signature().size() + t2.get_signature().size()) {
+            return 0;
+        }
+        return alloc(join_project_fn, t1.get_signature(), t2.get_signature(), col_cnt, cols1, cols2,
+            removed_col_cnt, removed_cols);
+    }
+
+    /**
+       The rows of the source are encoded with the codes of the target and looked up in its 
+       row index, only the new rows are decoded (for the delta).
+    */
+    class columnar_table_plugin::union_fn : public table_union_fn {
+    public:
+        virtual void operator()(table_base & tgt0, const table_base & src0, table_base * delta) {
+            columnar_table & tgt = get(tgt0);
+            const columnar_table & src = get(src0);
+            unsigned col_cnt = tgt.m_columns.size();
+            table_fact fact;
+            for (unsigned row = 0; row < src.m_size; ++row) {
+                for (unsigned i = 0; i < col_cnt; ++i) {
+                    tgt.m_probe[i] = tgt.m_columns[i].mk_code(src.get_cell(row, i), tgt.m_size);
+                }
+                if (tgt.add_probe() && delta) {
+                    fact.reset();
+                    for (unsigned i = 0; i < col_cnt; ++i) {
+                        fact.push_back(src.get_cell(row, i));
+                    }
+                    delta->add_fact(fact);
+                }
+            }
+        }
+    };
+
+    table_union_fn * columnar_table_plugin::mk_union_fn(const table_base & tgt, const table_base & src, 
+            const table_base * delta) {
+        if (tgt.get_kind() != get_kind() || src.get_kind() != get_kind() 
+            || (delta && delta->get_kind() != get_kind())
+            || tgt.get_signature() != src.get_signature()
+            || (delta && delta->get_signature() != tgt.get_signature())) {
+            return 0;
+        }
+        return alloc(union_fn);
+    }
+
+    class columnar_table_plugin::filter_equal_fn : public table_mutator_fn {
+        table_element m_value;
+        unsigned      m_col;
+    public:
+        filter_equal_fn(const table_element & value, unsigned col) : m_value(value), m_col(col) {}
+
+        virtual void operator()(table_base & tb) {
+            columnar_table & t = get(tb);
+            uint64 code;
+            if (!t.m_columns[m_col].find_code(m_value, code)) {
+                t.reset();
+                return;
+            }
+            unsigned_vector rows;
+            t.m_columns[m_col].find_equal(code, t.m_size, rows);
+            if (rows.size() < t.m_size) {
+                t.keep_rows(rows);
+            }
+        }
+    };
+
+    table_mutator_fn * columnar_table_plugin::mk_filter_equal_fn(const table_base & t,
+            const table_element & value, unsigned col) {
+        if (t.get_kind() != get_kind()) {
+            return 0;
+        }
+        return alloc(filter_equal_fn, value, col);
+    }
+
+    class columnar_table_plugin::filter_identical_fn : public table_mutator_fn {
+        unsigned_vector m_cols;
+    public:
+        filter_identical_fn(unsigned col_cnt, const unsigned * identical_cols) : m_cols(col_cnt, identical_cols) {}
+
+        virtual void operator()(table_base & tb) {
+            columnar_table & t = get(tb);
+            unsigned_vector rows;
+            for (unsigned row = 0; row < t.m_size; ++row) {
+                rows.push_back(row);
+            }
+            columnar_column const & c0 = t.m_columns[m_cols[0]];
+            for (unsigned i = 1; i < m_cols.size() && !rows.empty(); ++i) {
+                c0.filter_identical(t.m_columns[m_cols[i]], t.m_size, rows);
+            }
+            if (rows.size() < t.m_size) {
+                t.keep_rows(rows);
+            }
+        }
+    };
+
+    table_mutator_fn * columnar_table_plugin::mk_filter_identical_fn(const table_base & t,
+            unsigned col_cnt, const unsigned * identical_cols) {
+        if (t.get_kind() != get_kind() || col_cnt < 2) {
+            return 0;
+        }
+        return alloc(filter_identical_fn, col_cnt, identical_cols);
+    }
+
+    /**
+       The columns that are not projected out are copied as a whole,
+       the rows are not decoded.
+    */
+    class columnar_table_plugin::project_fn : public convenient_table_project_fn {
+    public:
+        project_fn(const table_signature & orig_sig, unsigned col_cnt, const unsigned * removed_cols)
+            : convenient_table_project_fn(orig_sig, col_cnt, removed_cols) {}
+
+        virtual table_base * operator()(const table_base & tb) {
+            const columnar_table & t = get(tb);
+            columnar_table & res = get(*t.get_plugin().mk_empty(get_result_signature()));
+            res.m_columns.reset();
+            for (unsigned i = 0, r = 0; i < t.m_columns.size(); ++i) {
+                if (r < m_removed_cols.size() && m_removed_cols[r] == i) {
+                    ++r;
+                }
+                else {
+                    res.m_columns.push_back(t.m_columns[i]);
+                }
+            }
+            res.m_size = t.m_size;
+            res.remove_duplicates();
+            return &res;
+        }
+    };
+
+    table_transformer_fn * columnar_table_plugin::mk_project_fn(const table_base & t, unsigned col_cnt,
+            const unsigned * removed_cols) {
+        if (t.get_kind() != get_kind() || col_cnt == t.get_signature().size()) {
+            return 0;
+        }
+        return alloc(project_fn, t.get_signature(), col_cnt, removed_cols);
+    }
+
+};
@@ -0,0 +1,218 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    dl_columnar_table.h
+
+Abstract:
+
+    Table that stores its facts column by column, with bit-packed
+    or dictionary encoded columns.
+
+Author:
+
+Revision History:
+
+--*/
+
+#ifndef DL_COLUMNAR_TABLE_H_
+#define DL_COLUMNAR_TABLE_H_
+
+#include "hashtable.h"
+#include "map.h"
+#include "vector.h"
+#include "dl_base.h"
+
+namespace datalog {
+
+    class columnar_table;
+
+    class columnar_table_plugin : public table_plugin {
+        friend class columnar_table;
+    protected:
+        class join_project_fn;
+        class union_fn;
+        class filter_equal_fn;
+        class filter_identical_fn;
+        class project_fn;
+
+    public:
+        typedef columnar_table table;
+
+        columnar_table_plugin(relation_manager & manager)
+            : table_plugin(symbol("columnar"), manager) {}
+
+        virtual bool can_handle_signature(const table_signature & s)
+        { return s.size() > 0 && s.functional_columns() == 0; }
+
+        virtual table_base * mk_empty(const table_signature & s);
+
+    protected:
+        virtual table_join_fn * mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2);
+        virtual table_join_fn * mk_join_project_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt, 
+            const unsigned * removed_cols);
+        virtual table_union_fn * mk_union_fn(const table_base & tgt, const table_base & src, 
+            const table_base * delta);
+        virtual table_transformer_fn * mk_project_fn(const table_base & t, unsigned col_cnt,
+            const unsigned * removed_cols);
+        virtual table_mutator_fn * mk_filter_identical_fn(const table_base & t, unsigned col_cnt,
+            const unsigned * identical_cols);
+        virtual table_mutator_fn * mk_filter_equal_fn(const table_base & t, const table_element & value,
+            unsigned col);
+
+        static columnar_table const& get(table_base const&);
+        static columnar_table& get(table_base&);
+    };
+
+    /**
+       \brief Column of a columnar table.
+
+       The values are stored as codes of \c m_width bits packed into 64-bit words. The width is
+       a power of two, so a code never spans two words. Columns whose domain needs more than
+       \c max_plain_width bits are dictionary encoded: a code is an index into \c m_values, and
+       the width grows with the number of distinct values in the column.
+    */
+    class columnar_column {
+        static const unsigned max_plain_width = 16;
+
+        typedef map<table_element, unsigned, table_element_hash, default_eq<table_element> > code_map;
+
+        unsigned                m_log_width;
+        bool                    m_dict;
+        svector<uint64>         m_words;
+        svector<table_element>  m_values;
+        code_map                m_codes;
+
+        unsigned width() const { return 1u << m_log_width; }
+        unsigned log_codes_per_word() const { return 6 - m_log_width; }
+        uint64 code_mask() const { return m_log_width == 6 ? UINT64_MAX : (static_cast<uint64>(1) << width()) - 1; }
+        uint64 broadcast(uint64 code) const;
+        void widen(unsigned num_rows);
+
+    public:
+        columnar_column(table_sort domain);
+
+        /**
+           \brief Column holding the rows \c rows of \c src, with the encoding of \c src.
+        */
+        columnar_column(columnar_column const & src, unsigned_vector const & rows);
+
+        bool is_dictionary() const { return m_dict; }
+        unsigned num_values() const { return m_values.size(); }
+
+        uint64 get_code(unsigned row) const {
+            uint64 w = m_words[row >> log_codes_per_word()];
+            return (w >> ((row & ((1u << log_codes_per_word()) - 1)) << m_log_width)) & code_mask();
+        }
+        void set_code(unsigned row, uint64 code);
+        table_element get(unsigned row) const {
+            uint64 code = get_code(row);
+            return m_dict ? m_values[static_cast<unsigned>(code)] : code;
+        }
+
+        /**
+           \brief Retrieve the code of \c val, return false if the column contains no such value.
+        */
+        bool find_code(table_element val, uint64 & code) const;
+
+        /**
+           \brief Return the code of \c val, adding it to the dictionary if necessary.
+           The table has \c num_rows rows.
+        */
+        uint64 mk_code(table_element val, unsigned num_rows);
+
+        void resize(unsigned num_rows);
+        void reset();
+
+        /**
+           \brief Keep the rows \c rows (in ascending order) of the first \c num_rows rows.
+        */
+        void keep_rows(unsigned_vector const & rows);
+
+        /**
+           \brief Collect the rows among the first \c num_rows whose code is \c code.
+           Whole words are compared at once.
+        */
+        void find_equal(uint64 code, unsigned num_rows, unsigned_vector & rows) const;
+
+        /**
+           \brief Keep the rows in \c rows where this column has the same value as \c other.
+        */
+        void filter_identical(columnar_column const & other, unsigned num_rows, unsigned_vector & rows) const;
+
+        unsigned get_size_estimate_bytes() const;
+    };
+
+    class columnar_table : public table_base {
+        friend class columnar_table_plugin;
+        friend class columnar_table_plugin::join_project_fn;
+        friend class columnar_table_plugin::union_fn;
+        friend class columnar_table_plugin::filter_equal_fn;
+        friend class columnar_table_plugin::filter_identical_fn;
+        friend class columnar_table_plugin::project_fn;
+
+        class our_iterator_core;
+
+        // the row index used for facts that are looked up in the table
+        static const unsigned probe_row = UINT_MAX;
+
+        struct row_hash_proc {
+            columnar_table const & m_table;
+            row_hash_proc(columnar_table const & t) : m_table(t) {}
+            unsigned operator()(unsigned row) const;
+        };
+
+        struct row_eq_proc {
+            columnar_table const & m_table;
+            row_eq_proc(columnar_table const & t) : m_table(t) {}
+            bool operator()(unsigned r1, unsigned r2) const;
+        };
+
+        typedef hashtable<unsigned, row_hash_proc, row_eq_proc> row_index;
+
+        vector<columnar_column> m_columns;
+        unsigned                m_size;
+        row_index               m_index;
+        mutable svector<uint64> m_probe;
+
+        uint64 get_code(unsigned row, unsigned col) const {
+            return row == probe_row ? m_probe[col] : m_columns[col].get_code(row);
+        }
+        bool mk_probe(const table_element * f) const;
+        /**
+           \brief Add the row whose codes are in \c m_probe. Return false if the table already
+           contains it.
+        */
+        bool add_probe();
+        void keep_rows(unsigned_vector const & rows);
+        void remove_duplicates();
+        void reset_index();
+
+        columnar_table(columnar_table_plugin & plugin, const table_signature & sig);
+    public:
+        columnar_table_plugin & get_plugin() const
+        { return static_cast<columnar_table_plugin &>(table_base::get_plugin()); }
+
+        table_element get_cell(unsigned row, unsigned col) const { return m_columns[col].get(row); }
+
+        virtual void add_fact(const table_fact & f);
+        virtual void remove_fact(const table_element* fact);
+        virtual bool contains_fact(const table_fact & f) const;
+        virtual void reset();
+        virtual table_base * clone() const;
+
+        virtual iterator begin() const;
+        virtual iterator end() const;
+
+        virtual bool empty() const { return m_size == 0; }
+        virtual unsigned get_size_estimate_rows() const { return m_size; }
+        virtual unsigned get_size_estimate_bytes() const;
+        virtual bool knows_exact_size() const { return true; }
+    };
+
+};
+
+#endif /* DL_COLUMNAR_TABLE_H_ */
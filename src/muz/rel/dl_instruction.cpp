@@ -23,6 +23,8 @@ Revision History:
 #include"dl_util.h"
 #include"dl_instruction.h"
 #include"rel_context.h"
+#include"dl_table_relation.h"
+#include"dl_sparse_table.h"
 #include"debug.h"
 #include"warning.h"
 
@@ -185,6 +187,98 @@ namespace datalog {
         IF_VERBOSE(2, display(ctx, verbose_stream()););
     }
 
+    // -----------------------------------
+    //
+    // concurrent evaluation
+    //
+    // -----------------------------------
+
+    /**
+       \brief Return true if operations on \c r may be evaluated concurrently with operations on other 
+       relations. Only table relations represented by sparse tables are supported: their operations 
+       do not use the ast_manager, and the pool of tables shared by the plugin is protected.
+    */
+    static bool supports_concurrency(const relation_base & r) {
+        return r.from_table() && 
+            dynamic_cast<const sparse_table *>(&static_cast<const table_relation &>(r).get_table()) != 0;
+    }
+
+    /**
+       \brief State of a join (or join-project) evaluated by instruction_block::perform_concurrent.
+    */
+    class concurrent_join {
+        typedef execution_context::reg_idx reg_idx;
+        relation_join_fn *    m_fn;
+        const relation_base * m_r1;
+        const relation_base * m_r2;
+        relation_base *       m_result;
+    public:
+        concurrent_join(): m_fn(0), m_r1(0), m_r2(0), m_result(0) {}
+
+        static bool can_handle(execution_context & ctx, reg_idx rel1, reg_idx rel2) {
+            return 
+                ctx.reg(rel1) && ctx.reg(rel2) && 
+                supports_concurrency(*ctx.reg(rel1)) && supports_concurrency(*ctx.reg(rel2));
+        }
+
+        void prepare(execution_context & ctx, reg_idx rel1, reg_idx rel2, relation_join_fn * fn) {
+            m_fn     = fn;
+            m_r1     = ctx.reg(rel1);
+            m_r2     = ctx.reg(rel2);
+            m_result = 0;
+            // other joins of the stage may read the same relations.
+            m_fn->prepare(*m_r1, *m_r2);
+        }
+
+        void perform() {
+            m_result = (*m_fn)(*m_r1, *m_r2);
+        }
+
+        void commit(execution_context & ctx, reg_idx res) {
+            if (m_result && !m_result->fast_empty()) {
+                ctx.set_reg(res, m_result);
+            }
+            else {
+                if (m_result) {
+                    m_result->deallocate();
+                }
+                ctx.make_empty(res);
+            }
+            m_result = 0;
+        }
+    };
+
+    /**
+       \brief State of a filter evaluated by instruction_block::perform_concurrent.
+    */
+    class concurrent_filter {
+        typedef execution_context::reg_idx reg_idx;
+        relation_mutator_fn * m_fn;
+        relation_base *       m_rel;
+    public:
+        concurrent_filter(): m_fn(0), m_rel(0) {}
+
+        static bool can_handle(execution_context & ctx, reg_idx reg) {
+            return ctx.reg(reg) && supports_concurrency(*ctx.reg(reg));
+        }
+
+        void prepare(execution_context & ctx, reg_idx reg, relation_mutator_fn * fn) {
+            m_fn  = fn;
+            m_rel = ctx.reg(reg);
+        }
+
+        void perform() {
+            (*m_fn)(*m_rel);
+        }
+
+        void commit(execution_context & ctx, reg_idx reg) {
+            if (m_rel->fast_empty()) {
+                ctx.make_empty(reg);
+            }
+            m_rel = 0;
+        }
+    };
+
     class instr_io : public instruction {
         bool m_store;
         func_decl_ref m_pred;
@@ -245,6 +339,10 @@ namespace datalog {
         reg_idx m_reg;
     public:
         instr_dealloc(reg_idx reg) : m_reg(reg) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_reg);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             ctx.make_empty(m_reg);
             return true;
@@ -268,6 +366,12 @@ namespace datalog {
     public:
         instr_clone_move(bool clone, reg_idx src, reg_idx tgt)
             : m_clone(clone), m_src(src), m_tgt(tgt) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            // moving the relation empties the source register
+            (m_clone ? reads : writes).push_back(m_src);
+            writes.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             if (ctx.reg(m_src)) log_verbose(ctx);            
             if (m_clone) {
@@ -366,11 +470,47 @@ namespace datalog {
         column_vector m_cols1;
         column_vector m_cols2;
         reg_idx m_res;
+        concurrent_join m_concurrent;
+
+        relation_join_fn * get_fn(const relation_base & r1, const relation_base & r2) {
+            relation_join_fn * fn;
+            if (!find_fn(r1, r2, fn)) {
+                fn = r1.get_manager().mk_join_fn(r1, r2, m_cols1, m_cols2);
+                if (!fn) {
+                    throw default_exception(default_exception::fmt(), 
+                                            "trying to perform unsupported join operation on relations of kinds %s and %s",
+                                            r1.get_plugin().get_name().bare_str(), r2.get_plugin().get_name().bare_str());
+                }
+                store_fn(r1, r2, fn);
+            }
+            return fn;
+        }
     public:
         instr_join(reg_idx rel1, reg_idx rel2, unsigned col_cnt, const unsigned * cols1, 
             const unsigned * cols2, reg_idx result)
             : m_rel1(rel1), m_rel2(rel2), m_cols1(col_cnt, cols1), 
             m_cols2(col_cnt, cols2), m_res(result) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_rel1);
+            reads.push_back(m_rel2);
+            writes.push_back(m_res);
+            return true;
+        }
+        virtual bool prepare_concurrent(execution_context & ctx) {
+            if (!concurrent_join::can_handle(ctx, m_rel1, m_rel2)) {
+                return false;
+            }
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_join;
+            m_concurrent.prepare(ctx, m_rel1, m_rel2, get_fn(*ctx.reg(m_rel1), *ctx.reg(m_rel2)));
+            return true;
+        }
+        virtual void perform_concurrent() {
+            m_concurrent.perform();
+        }
+        virtual void commit_concurrent(execution_context & ctx) {
+            m_concurrent.commit(ctx, m_res);
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             ++ctx.m_stats.m_join;
@@ -378,18 +518,9 @@ namespace datalog {
                 ctx.make_empty(m_res);
                 return true;
             }
-            relation_join_fn * fn;
             const relation_base & r1 = *ctx.reg(m_rel1);
             const relation_base & r2 = *ctx.reg(m_rel2);
-            if (!find_fn(r1, r2, fn)) {
-                fn = r1.get_manager().mk_join_fn(r1, r2, m_cols1, m_cols2);
-                if (!fn) {
-                    throw default_exception(default_exception::fmt(), 
-                                            "trying to perform unsupported join operation on relations of kinds %s and %s",
-                                            r1.get_plugin().get_name().bare_str(), r2.get_plugin().get_name().bare_str());
-                }
-                store_fn(r1, r2, fn);
-            }
+            relation_join_fn * fn = get_fn(r1, r2);
 
             TRACE("dl",
                 r1.get_signature().output(ctx.get_rel_context().get_manager(), tout);
@@ -432,18 +563,10 @@ namespace datalog {
         reg_idx m_reg;
         app_ref m_value;
         unsigned m_col;
-    public:
-        instr_filter_equal(ast_manager & m, reg_idx reg, const relation_element & value, unsigned col)
-            : m_reg(reg), m_value(value, m), m_col(col) {}
-        virtual bool perform(execution_context & ctx) {
-            log_verbose(ctx);            
-            ++ctx.m_stats.m_filter_eq;
-            if (!ctx.reg(m_reg)) {
-                return true;
-            }
+        concurrent_filter m_concurrent;
 
+        relation_mutator_fn * get_fn(relation_base & r) {
             relation_mutator_fn * fn;
-            relation_base & r = *ctx.reg(m_reg);
             if (!find_fn(r, fn)) {
                 fn = r.get_manager().mk_filter_equal_fn(r, m_value, m_col);
                 if (!fn) {
@@ -453,6 +576,39 @@ namespace datalog {
                 }
                 store_fn(r, fn);
             }
+            return fn;
+        }
+    public:
+        instr_filter_equal(ast_manager & m, reg_idx reg, const relation_element & value, unsigned col)
+            : m_reg(reg), m_value(value, m), m_col(col) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_reg);
+            return true;
+        }
+        virtual bool prepare_concurrent(execution_context & ctx) {
+            if (!concurrent_filter::can_handle(ctx, m_reg)) {
+                return false;
+            }
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_filter_eq;
+            m_concurrent.prepare(ctx, m_reg, get_fn(*ctx.reg(m_reg)));
+            return true;
+        }
+        virtual void perform_concurrent() {
+            m_concurrent.perform();
+        }
+        virtual void commit_concurrent(execution_context & ctx) {
+            m_concurrent.commit(ctx, m_reg);
+        }
+        virtual bool perform(execution_context & ctx) {
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_filter_eq;
+            if (!ctx.reg(m_reg)) {
+                return true;
+            }
+
+            relation_base & r = *ctx.reg(m_reg);
+            relation_mutator_fn * fn = get_fn(r);
             (*fn)(r);
 
             if (r.fast_empty()) {
@@ -481,18 +637,10 @@ namespace datalog {
         typedef unsigned_vector column_vector;
         reg_idx m_reg;
         column_vector m_cols;
-    public:
-        instr_filter_identical(reg_idx reg, unsigned col_cnt, const unsigned * identical_cols)
-            : m_reg(reg), m_cols(col_cnt, identical_cols) {}
-        virtual bool perform(execution_context & ctx) {
-            log_verbose(ctx);            
-            ++ctx.m_stats.m_filter_id;
-            if (!ctx.reg(m_reg)) {
-                return true;
-            }
+        concurrent_filter m_concurrent;
 
+        relation_mutator_fn * get_fn(relation_base & r) {
             relation_mutator_fn * fn;
-            relation_base & r = *ctx.reg(m_reg);
             if (!find_fn(r, fn)) {
                 fn = r.get_manager().mk_filter_identical_fn(r, m_cols.size(), m_cols.c_ptr());
                 if (!fn) {
@@ -502,6 +650,39 @@ namespace datalog {
                 }
                 store_fn(r, fn);
             }
+            return fn;
+        }
+    public:
+        instr_filter_identical(reg_idx reg, unsigned col_cnt, const unsigned * identical_cols)
+            : m_reg(reg), m_cols(col_cnt, identical_cols) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_reg);
+            return true;
+        }
+        virtual bool prepare_concurrent(execution_context & ctx) {
+            if (!concurrent_filter::can_handle(ctx, m_reg)) {
+                return false;
+            }
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_filter_id;
+            m_concurrent.prepare(ctx, m_reg, get_fn(*ctx.reg(m_reg)));
+            return true;
+        }
+        virtual void perform_concurrent() {
+            m_concurrent.perform();
+        }
+        virtual void commit_concurrent(execution_context & ctx) {
+            m_concurrent.commit(ctx, m_reg);
+        }
+        virtual bool perform(execution_context & ctx) {
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_filter_id;
+            if (!ctx.reg(m_reg)) {
+                return true;
+            }
+
+            relation_base & r = *ctx.reg(m_reg);
+            relation_mutator_fn * fn = get_fn(r);
             (*fn)(r);
 
             if (r.fast_empty()) {
@@ -529,6 +710,10 @@ namespace datalog {
     public:
         instr_filter_interpreted(reg_idx reg, app_ref & condition)
             : m_reg(reg), m_cond(condition) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_reg);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             if (!ctx.reg(m_reg)) {
                 return true;
@@ -583,6 +768,11 @@ namespace datalog {
             unsigned col_cnt, const unsigned * removed_cols, reg_idx result)
             : m_src(src), m_cond(condition), m_cols(col_cnt, removed_cols),
               m_res(result) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_src);
+            writes.push_back(m_res);
+            return true;
+        }
 
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
@@ -644,6 +834,12 @@ namespace datalog {
     public:
         instr_union(reg_idx src, reg_idx tgt, reg_idx delta, bool widen)
             : m_src(src), m_tgt(tgt), m_delta(delta), m_widen(widen) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_src);
+            writes.push_back(m_tgt);
+            writes.push_back(m_delta);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             TRACE("dl", tout << "union " << m_src << " into " << m_tgt 
                   << " " << ctx.reg(m_src) << " " << ctx.reg(m_tgt) << "\n";);
@@ -758,6 +954,11 @@ namespace datalog {
         instr_project_rename(bool projection, reg_idx src, unsigned col_cnt, const unsigned * cols, 
             reg_idx tgt) : m_projection(projection), m_src(src), 
             m_cols(col_cnt, cols), m_tgt(tgt) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_src);
+            writes.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             if (!ctx.reg(m_src)) {
                 ctx.make_empty(m_tgt);
@@ -819,12 +1020,48 @@ namespace datalog {
         column_vector m_cols2;
         column_vector m_removed_cols;
         reg_idx m_res;
+        concurrent_join m_concurrent;
+
+        relation_join_fn * get_fn(const relation_base & r1, const relation_base & r2) {
+            relation_join_fn * fn;
+            if (!find_fn(r1, r2, fn)) {
+                fn = r1.get_manager().mk_join_project_fn(r1, r2, m_cols1, m_cols2, m_removed_cols);
+                if (!fn) {
+                    throw default_exception(default_exception::fmt(), 
+                                            "trying to perform unsupported join-project operation on relations of kinds %s and %s",
+                        r1.get_plugin().get_name().bare_str(), r2.get_plugin().get_name().bare_str());
+                }
+                store_fn(r1, r2, fn);
+            }
+            return fn;
+        }
     public:
         instr_join_project(reg_idx rel1, reg_idx rel2, unsigned joined_col_cnt, const unsigned * cols1, 
             const unsigned * cols2, unsigned removed_col_cnt, const unsigned * removed_cols, reg_idx result)
             : m_rel1(rel1), m_rel2(rel2), m_cols1(joined_col_cnt, cols1), 
             m_cols2(joined_col_cnt, cols2), m_removed_cols(removed_col_cnt, removed_cols), m_res(result) {
         }
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_rel1);
+            reads.push_back(m_rel2);
+            writes.push_back(m_res);
+            return true;
+        }
+        virtual bool prepare_concurrent(execution_context & ctx) {
+            if (!concurrent_join::can_handle(ctx, m_rel1, m_rel2)) {
+                return false;
+            }
+            log_verbose(ctx);            
+            ++ctx.m_stats.m_join_project;
+            m_concurrent.prepare(ctx, m_rel1, m_rel2, get_fn(*ctx.reg(m_rel1), *ctx.reg(m_rel2)));
+            return true;
+        }
+        virtual void perform_concurrent() {
+            m_concurrent.perform();
+        }
+        virtual void commit_concurrent(execution_context & ctx) {
+            m_concurrent.commit(ctx, m_res);
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             if (!ctx.reg(m_rel1) || !ctx.reg(m_rel2)) {
@@ -832,18 +1069,9 @@ namespace datalog {
                 return true;
             }
             ++ctx.m_stats.m_join_project;
-            relation_join_fn * fn;
             const relation_base & r1 = *ctx.reg(m_rel1);
             const relation_base & r2 = *ctx.reg(m_rel2);
-            if (!find_fn(r1, r2, fn)) {
-                fn = r1.get_manager().mk_join_project_fn(r1, r2, m_cols1, m_cols2, m_removed_cols);
-                if (!fn) {
-                    throw default_exception(default_exception::fmt(), 
-                                            "trying to perform unsupported join-project operation on relations of kinds %s and %s",
-                        r1.get_plugin().get_name().bare_str(), r2.get_plugin().get_name().bare_str());
-                }
-                store_fn(r1, r2, fn);
-            }
+            relation_join_fn * fn = get_fn(r1, r2);
             TRACE("dl", tout<<r1.get_size_estimate_rows()<<" x "<<r2.get_size_estimate_rows()<<" jp->\n";);
             ctx.set_reg(m_res, (*fn)(r1, r2));
             TRACE("dl",  tout<<ctx.reg(m_res)->get_size_estimate_rows()<<"\n";);
@@ -897,6 +1125,11 @@ namespace datalog {
             // [Leo]: does not compile on gcc
             // TRACE("dl", tout << "src:"  << m_src << " result: " << m_result << " value:" << m_value << " column:" << m_col << "\n";);
         }
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_src);
+            writes.push_back(m_result);
+            return true;
+        }
 
         virtual bool perform(execution_context & ctx) {
             if (!ctx.reg(m_src)) {
@@ -953,6 +1186,11 @@ namespace datalog {
         instr_filter_by_negation(reg_idx tgt, reg_idx neg_rel, unsigned col_cnt, const unsigned * cols1, 
             const unsigned * cols2)
             : m_tgt(tgt), m_neg_rel(neg_rel), m_cols1(col_cnt, cols1), m_cols2(col_cnt, cols2) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_neg_rel);
+            writes.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             if (!ctx.reg(m_tgt) || !ctx.reg(m_neg_rel)) {
@@ -1011,6 +1249,10 @@ namespace datalog {
             m_sig.push_back(s);
             m_fact.push_back(val);
         }
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             ++ctx.m_stats.m_unary_singleton;
@@ -1044,6 +1286,10 @@ namespace datalog {
         reg_idx m_tgt;
     public:
         instr_mk_total(const relation_signature & sig, func_decl* p, reg_idx tgt) : m_sig(sig), m_pred(p), m_tgt(tgt) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            writes.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             ++ctx.m_stats.m_total;
@@ -1093,6 +1339,10 @@ namespace datalog {
     public:
         instr_assert_signature(const relation_signature & s, reg_idx tgt) 
             : m_sig(s), m_tgt(tgt) {}
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const {
+            reads.push_back(m_tgt);
+            return true;
+        }
         virtual bool perform(execution_context & ctx) {
             log_verbose(ctx);            
             if (ctx.reg(m_tgt)) {
@@ -1134,10 +1384,148 @@ namespace datalog {
             dealloc(*it);
         }
         m_data.reset();
+        m_stages.reset();
         m_observer = 0;
     }
 
+    /**
+       \brief Assign each instruction to the first stage after the stages of the previous instructions 
+       that access one of its registers. Instructions that do not report their registers are barriers: 
+       they get a stage of their own after all previous stages.
+    */
+    void instruction_block::mk_stages() const {
+        m_stages.reset();
+        // last stages writing and reading a register, after the last barrier. 
+        // A read depends only on the last write, a write also on the reads since that write.
+        u_map<unsigned> write_stage, read_stage; 
+        unsigned first_stage = 0;
+        unsigned_vector reads, writes;
+        for (unsigned i = 0; i < m_data.size(); ++i) {
+            reads.reset();
+            writes.reset();
+            if (!m_data[i]->get_registers(reads, writes)) {
+                m_stages.push_back(unsigned_vector());
+                m_stages.back().push_back(i);
+                write_stage.reset();
+                read_stage.reset();
+                first_stage = m_stages.size();
+                continue;
+            }
+            unsigned stage = first_stage;
+            unsigned s;
+            for (unsigned j = 0; j < reads.size(); ++j) {
+                if (write_stage.find(reads[j], s) && s + 1 > stage) {
+                    stage = s + 1;
+                }
+            }
+            for (unsigned j = 0; j < writes.size(); ++j) {
+                if (write_stage.find(writes[j], s) && s + 1 > stage) {
+                    stage = s + 1;
+                }
+                if (read_stage.find(writes[j], s) && s + 1 > stage) {
+                    stage = s + 1;
+                }
+            }
+            if (stage == m_stages.size()) {
+                m_stages.push_back(unsigned_vector());
+            }
+            m_stages[stage].push_back(i);
+            for (unsigned j = 0; j < reads.size(); ++j) {
+                if (reads[j] != execution_context::void_register && 
+                    (!read_stage.find(reads[j], s) || s < stage)) {
+                    read_stage.insert(reads[j], stage);
+                }
+            }
+            for (unsigned j = 0; j < writes.size(); ++j) {
+                if (writes[j] != execution_context::void_register) {
+                    write_stage.insert(writes[j], stage);
+                }
+            }
+        }
+        TRACE("dl", tout << "block with " << m_data.size() << " instructions in " << m_stages.size() << " stages\n";);
+    }
+
+    bool instruction_block::perform_stage(execution_context & ctx, unsigned_vector const & stage, unsigned num_threads) const {
+        cost_recorder crec;
+        ptr_buffer<instruction> concurrent;
+        for (unsigned i = 0; i < stage.size(); ++i) {
+            instruction * instr = m_data[stage[i]];
+            crec.start(instr);
+            if (ctx.should_terminate()) {
+                return false;
+            }
+            if (stage.size() > 1 && instr->prepare_concurrent(ctx)) {
+                concurrent.push_back(instr);
+            }
+            else if (!instr->perform(ctx)) {
+                return false;
+            }
+        }
+        // the time spent in concurrent evaluation is not attributed to the instructions.
+        crec.finish();
+        if (concurrent.empty()) {
+            return true;
+        }
+        
+        int num_tasks  = static_cast<int>(concurrent.size());
+        bool failed    = false;
+        bool is_error  = false;
+        unsigned error_code = 0;
+        std::string ex_msg;
+        #pragma omp parallel for num_threads(std::min(num_threads, concurrent.size())) schedule(dynamic)
+        for (int i = 0; i < num_tasks; ++i) {
+            try {
+                concurrent[i]->perform_concurrent();
+            }
+            catch (z3_error & err) {
+                #pragma omp critical (dl_instruction_block)
+                {
+                    if (!failed) {
+                        failed     = true;
+                        is_error   = true;
+                        error_code = err.error_code();
+                    }
+                }
+            }
+            catch (z3_exception & ex) {
+                #pragma omp critical (dl_instruction_block)
+                {
+                    if (!failed) {
+                        failed = true;
+                        ex_msg = ex.msg();
+                    }
+                }
+            }
+        }
+        for (unsigned i = 0; i < concurrent.size(); ++i) {
+            concurrent[i]->commit_concurrent(ctx);
+        }
+        if (failed) {
+            if (is_error) {
+                throw z3_error(error_code);
+            }
+            throw default_exception(ex_msg.c_str());
+        }
+        return true;
+    }
+
+    bool instruction_block::perform_concurrent(execution_context & ctx, unsigned num_threads) const {
+        if (m_stages.empty()) {
+            mk_stages();
+        }
+        for (unsigned i = 0; i < m_stages.size(); ++i) {
+            if (!perform_stage(ctx, m_stages[i], num_threads)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     bool instruction_block::perform(execution_context & ctx) const {
+        unsigned num_threads = ctx.get_rel_context().get_context().num_threads();
+        if (num_threads > 1 && m_data.size() > 1) {
+            return perform_concurrent(ctx, num_threads);
+        }
         cost_recorder crec;
         instr_seq_type::const_iterator it = m_data.begin();
         instr_seq_type::const_iterator end = m_data.end();
@@ -237,6 +237,29 @@ namespace datalog {
         virtual void display_body_impl(execution_context const & ctx, std::ostream & out, std::string indentation) const {}
         void log_verbose(execution_context& ctx);
 
+        /**
+           \brief Append to \c reads the registers whose relations the instruction only reads, and 
+           to \c writes the registers it modifies or replaces. Return false if the instruction may 
+           also access other state (e.g., the relations stored in the context), and therefore it 
+           cannot be reordered with other instructions of a block.
+        */
+        virtual bool get_registers(unsigned_vector & reads, unsigned_vector & writes) const { return false; }
+
+        /**
+           \brief Instructions that can be evaluated concurrently with other instructions split 
+           \c perform into three steps: \c prepare_concurrent creates the relation operation, 
+           \c perform_concurrent evaluates it without accessing the execution context, and 
+           \c commit_concurrent stores the result into the registers. 
+           
+           The first and last steps are executed sequentially. Other instructions of the stage may
+           read the same relations concurrently, so \c prepare_concurrent also builds any state
+           that the relation operation computes lazily on its arguments (e.g., key indexes). \c prepare_concurrent returns 
+           false if the instruction cannot be evaluated concurrently; then \c perform is used.
+        */
+        virtual bool prepare_concurrent(execution_context & ctx) { return false; }
+        virtual void perform_concurrent() {}
+        virtual void commit_concurrent(execution_context & ctx) {}
+
     public:
         typedef execution_context::reg_type reg_type;
         typedef execution_context::reg_idx reg_idx;
@@ -326,6 +349,18 @@ namespace datalog {
         typedef ptr_vector<instruction> instr_seq_type;
         instr_seq_type m_data;
         instruction_observer* m_observer;
+
+        /**
+           \brief Evaluation order used when several threads are available: the instructions
+           are grouped into stages, and an instruction of a stage does not access a register 
+           written by another instruction of the same stage; several instructions may read it.
+           A stage is evaluated after all the stages before it. Computed on demand.
+        */
+        mutable vector<unsigned_vector> m_stages;
+
+        void mk_stages() const;
+        bool perform_stage(execution_context & ctx, unsigned_vector const & stage, unsigned num_threads) const;
+        bool perform_concurrent(execution_context & ctx, unsigned num_threads) const;
     public:
         instruction_block() : m_observer(0) {}
         ~instruction_block();
@@ -333,6 +368,7 @@ namespace datalog {
 
         void push_back(instruction * i) { 
             m_data.push_back(i);
+            m_stages.reset();
             if (m_observer) {
                 m_observer->notify(i);
             }
@@ -350,6 +386,10 @@ namespace datalog {
 
            The execution can terminate before completion if the function 
            \c execution_context::should_terminate() returns true.
+
+           When datalog.threads is greater than one, instructions that do not share registers
+           may be evaluated out of order, and joins and filters over sparse tables are evaluated 
+           concurrently.
         */
         bool perform(execution_context & ctx) const;
 
@@ -702,6 +702,10 @@ namespace datalog {
             const unsigned * removed_cols)
             : m_join(join), m_project(0), m_removed_cols(removed_col_cnt, removed_cols) {}
 
+        virtual void prepare(const relation_base & t1, const relation_base & t2) {
+            m_join->prepare(t1, t2);
+        }
+
         virtual relation_base * operator()(const relation_base & t1, const relation_base & t2) {
             scoped_rel<relation_base> aux = (*m_join)(t1, t2);
             if(!m_project) {
@@ -1117,6 +1121,10 @@ namespace datalog {
             }
         };
 
+        virtual void prepare(const table_base & t1, const table_base & t2) {
+            m_join->prepare(t1, t2);
+        }
+
         virtual table_base * operator()(const table_base & t1, const table_base & t2) {
             table_base * aux = (*m_join)(t1, t2);
             if(m_project==0) {
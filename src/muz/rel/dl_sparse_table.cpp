@@ -18,6 +18,7 @@ Revision History:
 --*/
 
 #include<utility>
+#include<algorithm>
 #include"dl_context.h"
 #include"dl_util.h"
 #include"dl_sparse_table.h"
@@ -287,11 +288,11 @@ namespace datalog {
         typedef size_t_map<offset_vector> index_map;
 
         index_map m_map;
-        mutable entry_storage m_keys;
+        entry_storage m_keys;
         store_offset m_first_nonindexed;
 
 
-        void key_to_reserve(const key_value & key) const {
+        void key_to_reserve(const key_value & key) {
             m_keys.ensure_reserve();
             m_keys.write_into_reserve((char *)(key.c_ptr()));
         }
@@ -353,9 +354,8 @@ namespace datalog {
         }
 
         virtual query_result get_matching_offsets(const key_value & key) const {
-            key_to_reserve(key);
             store_offset ofs;
-            if (!m_keys.find_reserve_content(ofs)) {
+            if (!m_keys.find_content(reinterpret_cast<const char *>(key.c_ptr()), ofs)) {
                 return query_result();
             }
             index_map::entry * e = m_map.find_core(ofs);
@@ -368,7 +368,7 @@ namespace datalog {
     };
 
     /**
-       When doing lookup using this index, the content of the reserve in sparse_table::m_data changes.
+       Lookups build the fact of the key in a local buffer and find it in sparse_table::m_data.
     */
     class sparse_table::full_signature_key_indexer : public key_indexer {
         const sparse_table & m_table;
@@ -377,7 +377,6 @@ namespace datalog {
            Permutation of key columns to make it into table facts. If empty, no permutation is necessary.
         */
         unsigned_vector m_permutation;
-        mutable table_fact m_key_fact;
     public:
 
         static bool can_handle(unsigned key_len, const unsigned * key_cols, const sparse_table & t) {
@@ -404,23 +403,23 @@ namespace datalog {
                 //m_permutation[m_key_cols[i]] = i;
                 m_permutation[i] = m_key_cols[i];
             }
-            m_key_fact.resize(t.get_signature().size());
         }
 
         virtual ~full_signature_key_indexer() {}
 
         virtual query_result get_matching_offsets(const key_value & key) const {
+            //The key is not written into the reserve of the table, so that several threads may 
+            //look up keys at the same time. The buffer is zeroed as the reserve, and a column
+            //may be written as a word that extends past the end of the fact.
+            buffer<char, false, 128> key_fact;
+            key_fact.resize(m_table.m_fact_size + sizeof(uint64), 0);
             unsigned key_len = m_key_cols.size();
             for (unsigned i=0; i<key_len; i++) {
-                m_key_fact[m_permutation[i]] = key[i];
+                m_table.m_column_layout.set(key_fact.c_ptr(), m_permutation[i], key[i]);
             }
-            //We will change the content of the reserve; which does not change the 'high-level' 
-            //content of the table.
-            sparse_table & t = const_cast<sparse_table&>(m_table);
-            t.write_into_reserve(m_key_fact.c_ptr());
 
             store_offset res;
-            if (!t.m_data.find_reserve_content(res)) {
+            if (!m_table.m_data.find_content(key_fact.c_ptr(), res)) {
                 return query_result();
             }
             return query_result(res);
@@ -474,7 +473,12 @@ namespace datalog {
 #endif
         key_spec kspec;
         kspec.append(key_len, key_cols);
-        key_index_map::entry * key_map_entry = m_key_indexes.insert_if_not_there2(kspec, 0);
+        //An index that exists and is up to date is only read, so that concurrent joins can 
+        //share it once it is built (see sparse_table_plugin::join_project_fn::prepare).
+        key_index_map::entry * key_map_entry = m_key_indexes.find_core(kspec);
+        if (!key_map_entry) {
+            key_map_entry = m_key_indexes.insert_if_not_there2(kspec, 0);
+        }
         if (!key_map_entry->get_data().m_value) {
             if (full_signature_key_indexer::can_handle(key_len, key_cols, *this)) {
                 key_map_entry->get_data().m_value = alloc(full_signature_key_indexer, key_len, key_cols, *this);
@@ -732,6 +736,239 @@ namespace datalog {
         }
     }
 
+    // -----------------------------------
+    //
+    // partitioned join
+    //
+    // -----------------------------------
+
+    /**
+       \brief Join of two tables that are radix partitioned on the hash of their joined columns.
+       
+       Bucket \c b of a table consists of the rows \c m_rows[m_bounds[b]] ... \c m_rows[m_bounds[b+1]-1]
+       whose hash has the lowest bits equal to \c b. Only the hash and the offset of the rows are 
+       moved, so the buckets are small even for wide tables.
+    */
+    class sparse_table::partitioned_join {
+        struct row {
+            unsigned     m_hash;
+            store_offset m_ofs;
+        };
+
+        struct row_lt {
+            bool operator()(row const & r1, row const & r2) const { return r1.m_hash < r2.m_hash; }
+        };
+
+        struct partitions {
+            svector<row>    m_rows;
+            unsigned_vector m_bounds;
+        };
+
+        const sparse_table & m_t1;
+        const sparse_table & m_t2;
+        unsigned             m_key_len;
+        const unsigned *     m_cols1;
+        const unsigned *     m_cols2;
+        unsigned             m_num_buckets;
+        partitions           m_parts1;
+        partitions           m_parts2;
+
+        unsigned hash_key(const sparse_table & t, store_offset ofs, const unsigned * cols) const {
+            unsigned h = 17;
+            for (unsigned i = 0; i < m_key_len; ++i) {
+                h = combine_hash(h, hash_ull(t.get_cell(ofs, cols[i])));
+            }
+            return h;
+        }
+
+        bool keys_equal(store_offset ofs1, store_offset ofs2) const {
+            for (unsigned i = 0; i < m_key_len; ++i) {
+                if (m_t1.get_cell(ofs1, m_cols1[i]) != m_t2.get_cell(ofs2, m_cols2[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void partition(const sparse_table & t, const unsigned * cols, partitions & p) {
+            unsigned mask = m_num_buckets - 1;
+            unsigned entry_size = t.m_fact_size;
+            store_offset end = t.m_data.after_last_offset();
+            unsigned_vector hashes;
+            p.m_bounds.reset();
+            p.m_bounds.resize(m_num_buckets + 1, 0);
+            for (store_offset ofs = 0; ofs != end; ofs += entry_size) {
+                unsigned h = hash_key(t, ofs, cols);
+                hashes.push_back(h);
+                p.m_bounds[(h & mask) + 1]++;
+            }
+            for (unsigned b = 0; b < m_num_buckets; ++b) {
+                p.m_bounds[b + 1] += p.m_bounds[b];
+            }
+            unsigned_vector next(p.m_bounds);
+            p.m_rows.resize(hashes.size());
+            store_offset ofs = 0;
+            for (unsigned i = 0; i < hashes.size(); ++i, ofs += entry_size) {
+                row & r = p.m_rows[next[hashes[i] & mask]++];
+                r.m_hash = hashes[i];
+                r.m_ofs  = ofs;
+            }
+        }
+
+    public:
+        typedef svector<std::pair<store_offset, store_offset> > matches;
+
+        partitioned_join(const sparse_table & t1, const sparse_table & t2, unsigned key_len, 
+                         const unsigned * cols1, const unsigned * cols2, unsigned num_bits) :
+            m_t1(t1), m_t2(t2), m_key_len(key_len), m_cols1(cols1), m_cols2(cols2),
+            m_num_buckets(1u << num_bits) {
+            partition(t1, cols1, m_parts1);
+            partition(t2, cols2, m_parts2);
+        }
+
+        unsigned num_buckets() const { return m_num_buckets; }
+
+        /**
+           \brief Sort bucket \c b of both tables and collect the offsets of the matching rows.
+           Different buckets may be matched concurrently.
+        */
+        void match_bucket(unsigned b, matches & result) {
+            row * rows1 = m_parts1.m_rows.c_ptr();
+            row * rows2 = m_parts2.m_rows.c_ptr();
+            unsigned i  = m_parts1.m_bounds[b], end1 = m_parts1.m_bounds[b + 1];
+            unsigned j  = m_parts2.m_bounds[b], end2 = m_parts2.m_bounds[b + 1];
+            if (i == end1 || j == end2) {
+                return;
+            }
+            std::sort(rows1 + i, rows1 + end1, row_lt());
+            std::sort(rows2 + j, rows2 + end2, row_lt());
+            while (i < end1 && j < end2) {
+                unsigned h = rows1[i].m_hash;
+                if (h < rows2[j].m_hash) {
+                    ++i;
+                }
+                else if (rows2[j].m_hash < h) {
+                    ++j;
+                }
+                else {
+                    unsigned run_end = j;
+                    while (run_end < end2 && rows2[run_end].m_hash == h) {
+                        ++run_end;
+                    }
+                    for (; i < end1 && rows1[i].m_hash == h; ++i) {
+                        for (unsigned k = j; k < run_end; ++k) {
+                            if (keys_equal(rows1[i].m_ofs, rows2[k].m_ofs)) {
+                                result.push_back(std::make_pair(rows1[i].m_ofs, rows2[k].m_ofs));
+                            }
+                        }
+                    }
+                    j = run_end;
+                }
+            }
+        }
+
+        void add_matches(matches const & ms, const unsigned * removed_cols, bool tables_swapped, 
+                         sparse_table & result) const {
+            for (unsigned i = 0; i < ms.size(); ++i) {
+                result.m_data.ensure_reserve();
+                result.garbage_collect();
+                char * res_reserve = result.m_data.get_reserve_ptr();
+                char const * t1ptr = m_t1.get_at_offset(ms[i].first);
+                char const * t2ptr = m_t2.get_at_offset(ms[i].second);
+                if (tables_swapped) {
+                    concatenate_rows(m_t2.m_column_layout, m_t1.m_column_layout, result.m_column_layout,
+                        t2ptr, t1ptr, res_reserve, removed_cols);
+                } else {
+                    concatenate_rows(m_t1.m_column_layout, m_t2.m_column_layout, result.m_column_layout,
+                        t1ptr, t2ptr, res_reserve, removed_cols);
+                }
+                result.add_reserve_content();
+            }
+        }
+    };
+
+    void sparse_table::partitioned_join_project(const sparse_table & t1, const sparse_table & t2,
+            unsigned joined_col_cnt, const unsigned * t1_joined_cols, const unsigned * t2_joined_cols,
+            const unsigned * removed_cols, bool tables_swapped, unsigned num_threads, sparse_table & result) {
+        SASSERT(joined_col_cnt > 0);
+        verbose_action _va("partitioned_join_project", 1);
+
+        // the rows of a bucket of both tables should fit into the L2 cache
+        static const size_t   bucket_bytes = 1 << 18;
+        static const unsigned max_bits     = 16;
+        size_t bytes = t1.m_data.after_last_offset() + t2.m_data.after_last_offset();
+        unsigned num_bits = 0;
+        while (num_bits < max_bits && (bytes >> num_bits) > bucket_bytes) {
+            ++num_bits;
+        }
+        // enough buckets to balance the load between the threads
+        while (num_bits < max_bits && (1u << num_bits) < 4 * num_threads) {
+            ++num_bits;
+        }
+
+        partitioned_join pj(t1, t2, joined_col_cnt, t1_joined_cols, t2_joined_cols, num_bits);
+        unsigned num_buckets = pj.num_buckets();
+        IF_VERBOSE(2, verbose_stream() << "(join " << t1.row_count() << " x " << t2.row_count() 
+                   << " rows in " << num_buckets << " buckets)\n";);
+
+        if (num_threads <= 1) {
+            partitioned_join::matches ms;
+            for (unsigned b = 0; b < num_buckets; ++b) {
+                pj.match_bucket(b, ms);
+                pj.add_matches(ms, removed_cols, tables_swapped, result);
+                ms.reset();
+            }
+            return;
+        }
+
+        // match batches of buckets concurrently, and add the matches of each batch 
+        // to the result before matching the next one.
+        unsigned batch_size = std::min(num_buckets, 4 * num_threads);
+        vector<partitioned_join::matches> batch;
+        batch.resize(batch_size);
+        for (unsigned lo = 0; lo < num_buckets; lo += batch_size) {
+            int num_tasks = static_cast<int>(std::min(batch_size, num_buckets - lo));
+            bool failed   = false;
+            bool is_error = false;
+            unsigned error_code = 0;
+            std::string ex_msg;
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+            for (int i = 0; i < num_tasks; ++i) {
+                try {
+                    pj.match_bucket(lo + i, batch[i]);
+                }
+                catch (z3_error & err) {
+                    #pragma omp critical (dl_sparse_table_join)
+                    {
+                        if (!failed) {
+                            failed     = true;
+                            is_error   = true;
+                            error_code = err.error_code();
+                        }
+                    }
+                }
+                catch (z3_exception & ex) {
+                    #pragma omp critical (dl_sparse_table_join)
+                    {
+                        if (!failed) {
+                            failed = true;
+                            ex_msg = ex.msg();
+                        }
+                    }
+                }
+            }
+            if (failed) {
+                if (is_error) {
+                    throw z3_error(error_code);
+                }
+                throw default_exception(ex_msg.c_str());
+            }
+            for (int i = 0; i < num_tasks; ++i) {
+                pj.add_matches(batch[i], removed_cols, tables_swapped, result);
+                batch[i].reset();
+            }
+        }
+    }
 
     // -----------------------------------
     //
@@ -753,18 +990,23 @@ namespace datalog {
 
 
     void sparse_table_plugin::reset() {
-        table_pool::iterator it = m_pool.begin();
-        table_pool::iterator end = m_pool.end();
-        for (; it!=end; ++it) {
-            sp_table_vector * vect = it->m_value;
-            sp_table_vector::iterator vit = vect->begin();
-            sp_table_vector::iterator vend = vect->end();
-            for (; vit!=vend; ++vit) {
-                (*vit)->destroy(); //calling deallocate() would only put the table back into the pool
-            }
-            dealloc(vect);
-        }
-        m_pool.reset();
+        // garbage_collect() is reached from joins that run concurrently with
+        // recycle() and mk_empty().
+        #pragma omp critical (dl_sparse_table_pool)
+        {
+            table_pool::iterator it = m_pool.begin();
+            table_pool::iterator end = m_pool.end();
+            for (; it!=end; ++it) {
+                sp_table_vector * vect = it->m_value;
+                sp_table_vector::iterator vit = vect->begin();
+                sp_table_vector::iterator vend = vect->end();
+                for (; vit!=vend; ++vit) {
+                    (*vit)->destroy(); //calling deallocate() would only put the table back into the pool
+                }
+                dealloc(vect);
+            }
+            m_pool.reset();
+        }
     }
 
     void sparse_table_plugin::garbage_collect() {
@@ -777,26 +1019,35 @@ namespace datalog {
         verbose_action  _va("recycle", 2);
         const table_signature & sig = t->get_signature();
         t->reset();
-
-        table_pool::entry * e = m_pool.insert_if_not_there2(sig, 0);
-        sp_table_vector * & vect = e->get_data().m_value;
-        if (vect == 0) {
-            vect = alloc(sp_table_vector);
-        }
         IF_VERBOSE(12, verbose_stream() << "Recycle: " << t->get_size_estimate_bytes() << "\n";);
 
-        vect->push_back(t);
+        // the pool is shared by instructions evaluated concurrently (see datalog.threads).
+        #pragma omp critical (dl_sparse_table_pool)
+        {
+            table_pool::entry * e = m_pool.insert_if_not_there2(sig, 0);
+            sp_table_vector * & vect = e->get_data().m_value;
+            if (vect == 0) {
+                vect = alloc(sp_table_vector);
+            }
+            vect->push_back(t);
+        }
     }
 
     table_base * sparse_table_plugin::mk_empty(const table_signature & s) {
         SASSERT(can_handle_signature(s));
 
-        sp_table_vector * vect;
-        if (!m_pool.find(s, vect) || vect->empty()) {
+        sparse_table * res = 0;
+        #pragma omp critical (dl_sparse_table_pool)
+        {
+            sp_table_vector * vect;
+            if (m_pool.find(s, vect) && !vect->empty()) {
+                res = vect->back();
+                vect->pop_back();
+            }
+        }
+        if (res == 0) {
             return alloc(sparse_table, *this, s);
         }
-        sparse_table * res = vect->back();
-        vect->pop_back();
         return res;
     }
 
@@ -827,6 +1078,36 @@ namespace datalog {
             m_removed_cols.push_back(UINT_MAX);
         }
 
+        //If both tables are large, probing an index of one of them for every row of the 
+        //other one thrashes the cache, so we partition both of them on the joined columns.
+        bool use_partitions(const sparse_table & t1, const sparse_table & t2) const {
+            unsigned threshold = t1.get_plugin().get_context().join_partition_threshold();
+            return !m_cols1.empty() && threshold > 0 && 
+                t1.get_size_estimate_rows() >= threshold && t2.get_size_estimate_rows() >= threshold;
+        }
+
+        //If we join with some intersection, want to iterate over the smaller table and
+        //do indexing into the bigger one. If we simply do a product, we want the bigger
+        //one to be at the outer iteration (then the small one will hopefully fit into 
+        //the cache)
+        bool iterate_second(const sparse_table & t1, const sparse_table & t2) const {
+            return (t1.row_count() > t2.row_count()) == (!m_cols1.empty());
+        }
+
+        virtual void prepare(const table_base & tb1, const table_base & tb2) {
+            const sparse_table & t1 = get(tb1);
+            const sparse_table & t2 = get(tb2);
+            if (m_cols1.empty() || use_partitions(t1, t2)) {
+                return;
+            }
+            if (iterate_second(t1, t2)) {
+                t1.get_key_indexer(m_cols1.size(), m_cols1.c_ptr());
+            }
+            else {
+                t2.get_key_indexer(m_cols2.size(), m_cols2.c_ptr());
+            }
+        }
+
         virtual table_base * operator()(const table_base & tb1, const table_base & tb2) {
 
             const sparse_table & t1 = get(tb1);
@@ -836,11 +1117,11 @@ namespace datalog {
 
             sparse_table * res = get(plugin.mk_empty(get_result_signature()));
 
-            //If we join with some intersection, want to iterate over the smaller table and
-            //do indexing into the bigger one. If we simply do a product, we want the bigger
-            //one to be at the outer iteration (then the small one will hopefully fit into 
-            //the cache)
-            if ( (t1.row_count() > t2.row_count()) == (!m_cols1.empty()) ) {
+            if (use_partitions(t1, t2)) {
+                sparse_table::partitioned_join_project(t1, t2, m_cols1.size(), m_cols1.c_ptr(), 
+                    m_cols2.c_ptr(), m_removed_cols.c_ptr(), false, plugin.get_context().num_threads(), *res);
+            }
+            else if (iterate_second(t1, t2)) {
                 sparse_table::self_agnostic_join_project(t2, t1, m_cols1.size(), m_cols2.c_ptr(), 
                     m_cols1.c_ptr(), m_removed_cols.c_ptr(), true, *res);
             }
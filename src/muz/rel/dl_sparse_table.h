@@ -139,6 +139,21 @@ namespace datalog {
             }
         };
 
+        /**
+           \brief Compare the entries of the storage with an entry outside of it.
+        */
+        class content_eq_proc {
+            const storage & m_storage;
+            const char * m_content;
+            unsigned m_unique_entry_size;
+        public:
+            content_eq_proc(const storage & s, const char * content, unsigned unique_entry_sz) 
+                : m_storage(s), m_content(content), m_unique_entry_size(unique_entry_sz) {}
+            bool operator()(store_offset ofs) const {
+                return memcmp(m_storage.c_ptr()+ofs, m_content, m_unique_entry_size)==0;
+            }
+        };
+
         typedef hashtable<store_offset, offset_hash_proc, offset_eq_proc> storage_indexer;
 
         static const store_offset NO_RESERVE = UINT_MAX;
@@ -258,6 +273,23 @@ namespace datalog {
             return true;
         }
 
+        /**
+           \brief Find the offset of the stored entry equal to \c entry, which is not in the storage.
+
+           Unlike \c find_reserve_content it does not write into the storage, so several threads
+           may look up entries at the same time.
+        */
+        bool find_content(const char * entry, store_offset & result) const {
+            unsigned hash = string_hash(entry, m_unique_part_size, 0);
+            storage_indexer::entry * indexer_entry = 
+                m_data_indexer.find_core(hash, content_eq_proc(m_data, entry, m_unique_part_size));
+            if(!indexer_entry) {
+                return false;
+            }
+            result = indexer_entry->get_data();
+            return true;
+        }
+
         /**
            \brief Write fact \c f into the reserve at the end of the \c m_data storage.
 
@@ -315,6 +347,7 @@ namespace datalog {
         class key_indexer;
         class general_key_indexer;
         class full_signature_key_indexer;
+        class partitioned_join;
         typedef entry_storage::store_offset store_offset;
 
         
@@ -450,6 +483,21 @@ namespace datalog {
             unsigned joined_col_cnt, const unsigned * t1_joined_cols, const unsigned * t2_joined_cols,
             const unsigned * removed_cols, bool tables_swapped, sparse_table & result);
 
+        /**
+           \brief Perform join-project between t1 and t2 by radix partitioning the rows of both
+           tables on the hash of the joined columns into buckets that fit into the cache, and
+           joining the tables bucket by bucket.
+
+           The rows of each bucket are sorted by their hash, so matching rows of the two tables are 
+           found by merging the sorted buckets. Buckets are matched on up to \c num_threads threads, 
+           the resulting facts are added to \c result sequentially.
+
+           The remaining arguments have the same meaning as in \c self_agnostic_join_project.
+        */
+        static void partitioned_join_project(const sparse_table & t1, const sparse_table & t2,
+            unsigned joined_col_cnt, const unsigned * t1_joined_cols, const unsigned * t2_joined_cols,
+            const unsigned * removed_cols, bool tables_swapped, unsigned num_threads, sparse_table & result);
+
 
         /**
            If the fact at \c data (in table's native representation) is not in the table,
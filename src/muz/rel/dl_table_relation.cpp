@@ -81,6 +81,11 @@ namespace datalog {
             const unsigned * removed_cols, table_join_fn * tfun) 
             : convenient_relation_join_project_fn(s1, s2, col_cnt, cols1, cols2, removed_col_cnt,
                     removed_cols), m_tfun(tfun) {}
+
+        virtual void prepare(const relation_base & t1, const relation_base & t2) {
+            m_tfun->prepare(static_cast<const table_relation &>(t1).get_table(), 
+                static_cast<const table_relation &>(t2).get_table());
+        }
         
         virtual relation_base * operator()(const relation_base & t1, const relation_base & t2) {
             SASSERT(t1.from_table());
@@ -628,6 +628,11 @@ unsigned doc_manager::hash(doc const& src) const {
 // A contains B
 // B1 contains A1 or B2 contains A1
 // B1 contains A2 or B2 contains A2
+uint64 doc_manager::signature(doc const& src) const {
+    // a contains b only if a.pos() contains b.pos()
+    return m.signature(src.pos());
+}
+
 bool doc_manager::contains(doc const& a, doc const& b) const {
     if (!m.contains(a.pos(), b.pos())) return false;
     for (unsigned i = 0; i < a.neg().size(); ++i) {
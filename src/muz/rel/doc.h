@@ -81,6 +81,7 @@ public:
     void subtract(doc const& A, doc const& B, doc_vector& result);
     bool equals(doc const& a, doc const& b) const;
     unsigned hash(doc const& src) const;
+    uint64 signature(doc const& src) const;
     bool contains(doc const& a, doc const& b) const;
     bool contains(doc const& a, unsigned_vector const& colsa,
                   doc const& b, unsigned_vector const& colsb) const;
@@ -111,6 +112,23 @@ template<typename M, typename T>
 class union_bvec { 
     buffer<T*, false, 8> m_elems; // TBD: reuse allocator of M
 
+    // Subsumption signatures of the elements: if a contains b, then the signature of a
+    // is a subset of the signature of b (see tbv_manager::signature). 
+    // Either empty, or the signatures of all elements. It is only maintained for
+    // unions with at least index_threshold elements, and it is dropped when an
+    // element is accessed for update.
+    svector<uint64>      m_sigs;
+    static const unsigned index_threshold = 16;
+
+    bool is_indexed() const { return !m_sigs.empty() && m_sigs.size() == m_elems.size(); }
+
+    void mk_index(M& m) {
+        m_sigs.reset();
+        for (unsigned i = 0; i < size(); ++i) {
+            m_sigs.push_back(m.signature(*m_elems[i]));
+        }
+    }
+
     enum fix_bit_result_t {
         e_row_removed, // = 1
         e_duplicate_row, // = 2
@@ -120,7 +138,8 @@ class union_bvec {
 
 public:
     unsigned size() const { return m_elems.size(); }
-    T& operator[](unsigned idx) const { return *m_elems[idx]; }
+    T const& operator[](unsigned idx) const { return *m_elems[idx]; }
+    T& operator[](unsigned idx) { m_sigs.reset(); return *m_elems[idx]; }
     bool is_empty() const { return m_elems.empty(); }
     bool is_empty_complete(ast_manager& m, doc_manager& dm) const {
         for (unsigned i = 0; i < size(); ++i) {
@@ -130,9 +149,11 @@ public:
         return true;
     }
     bool is_full(M& m) const { return size() == 1 && m.is_full(*m_elems[0]); }
-    bool contains(M& m, T& t) const {
+    bool contains(M& m, T const& t) const {
+        bool indexed = is_indexed();
+        uint64 sig = indexed ? m.signature(t) : 0;
         for (unsigned i = 0; i < size(); ++i) {
-            if (m.contains(*m_elems[i], t)) return true;
+            if ((!indexed || (m_sigs[i] & ~sig) == 0) && m.contains(*m_elems[i], t)) return true;
         }
         return false;
     }
@@ -154,61 +175,90 @@ public:
     void push_back(T* t) {
         SASSERT(t);
         m_elems.push_back(t);
+        m_sigs.reset();
     }
     void erase(M& m, unsigned idx) {
         m.deallocate(m_elems[idx]);
         unsigned sz = m_elems.size();
+        bool indexed = is_indexed();
         for (unsigned i = idx+1; i < sz; ++i) {
             m_elems[i-1] = m_elems[i];
+            if (indexed) m_sigs[i-1] = m_sigs[i];
         }
         m_elems.resize(sz-1);
+        if (indexed) m_sigs.shrink(sz-1);
     }
     void reset(M& m) {
         for (unsigned i = 0; i < m_elems.size(); ++i) {
             m.deallocate(m_elems[i]);
         }
         m_elems.reset(); 
+        m_sigs.reset();
     }    
+    /**
+       \brief Add t to the union, unless it is contained in an element, and
+       remove the elements contained in t. Large unions only compare t with the 
+       elements whose signature is compatible with the signature of t.
+    */
     bool insert(M& m, T* t) {
         SASSERT(t);
         unsigned sz = size(), j = 0;
         bool found = false;
+        bool indexed = sz >= index_threshold;
+        if (indexed && !is_indexed()) {
+            mk_index(m);
+        }
+        else if (!indexed) {
+            m_sigs.reset();
+        }
+        uint64 sig = indexed ? m.signature(*t) : 0;
         unsigned i = 0;
         for ( ; i < sz; ++i, ++j) {
-            if (m.contains(*m_elems[i], *t)) {
+            uint64 sig_i = indexed ? m_sigs[i] : 0;
+            if ((sig_i & ~sig) == 0 && m.contains(*m_elems[i], *t)) {
                 found = true;
             }
-            else if (m.contains(*t, *m_elems[i])) {
+            else if ((sig & ~sig_i) == 0 && m.contains(*t, *m_elems[i])) {
                 m.deallocate(m_elems[i]);
                 --j;
                 continue;
             }
             if (i != j) {
                 m_elems[j] = m_elems[i];
+                if (indexed) m_sigs[j] = sig_i;
             } 
         }
-        if (j != sz) m_elems.resize(j);
+        if (j != sz) {
+            m_elems.resize(j);
+            if (indexed) m_sigs.shrink(j);
+        }
         if (found) {
             m.deallocate(t);
         }
         else {
             m_elems.push_back(t);
+            if (indexed) m_sigs.push_back(sig);
         }
         return !found;
     }
     void intersect(M& m, T const& t) {
         unsigned sz = size();
         unsigned j = 0;
+        bool indexed = is_indexed();
         for (unsigned i = 0; i < sz; ++i, ++j) {
             if (!m.set_and(*m_elems[i], t)) {
                 m.deallocate(m_elems[i]);
                 --j;
             }
-            else if (i != j) {
+            else {
                 m_elems[j] = m_elems[i];
+                if (indexed) m_sigs[j] = m.signature(*m_elems[j]);
             }
         }
-        if (j != sz) m_elems.resize(j);
+        if (j != sz) {
+            m_elems.resize(j);
+            if (indexed) m_sigs.shrink(j);
+        }
     }
     void insert(M& m, union_bvec const& other) {
         for (unsigned i = 0; i < other.size(); ++i) {
@@ -236,13 +286,14 @@ public:
         }
         // TBD compress?
     }
-    void subtract(M& m, T& t) {
+    void subtract(M& m, T const& t) {
         unsigned sz = size();
         union_bvec result;
         for (unsigned i = 0; i < sz; ++i) {
             m.subtract(*m_elems[i], t, result.m_elems);
         }
         std::swap(m_elems, result.m_elems);
+        m_sigs.reset();
         result.reset(m);
     }
     void complement(M& m, union_bvec& result) const {     
@@ -283,6 +334,7 @@ public:
     }
 
     void merge(M& m, unsigned lo, unsigned length, subset_ints const& equalities, bit_vector const& discard_cols) {
+        m_sigs.reset();
         unsigned j = 0;
         unsigned sz = size();
         for (unsigned i = 0; i < sz; ++i, ++j) {
@@ -36,6 +36,7 @@ Revision History:
 #include"check_relation.h"
 #include"dl_lazy_table.h"
 #include"dl_sparse_table.h"
+#include"dl_columnar_table.h"
 #include"dl_table.h"
 #include"dl_table_relation.h"
 #include"aig_exporter.h"
@@ -106,6 +107,7 @@ namespace datalog {
         relation_manager& rm = get_rmanager();
 
         rm.register_plugin(alloc(sparse_table_plugin, rm));
+        rm.register_plugin(alloc(columnar_table_plugin, rm));
         rm.register_plugin(alloc(hashtable_table_plugin, rm));
         rm.register_plugin(alloc(bitvector_table_plugin, rm));
         rm.register_plugin(alloc(equivalence_table_plugin, rm));
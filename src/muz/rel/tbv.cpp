@@ -21,6 +21,7 @@ Revision History:
 #include "tbv.h"
 #include "hashtable.h"
 #include "ast_util.h"
+#include "bit_util.h"
 
 
 static bool s_debug_alloc = false;
@@ -217,11 +218,7 @@ bool tbv_manager::set_and(tbv& dst,  tbv const& src) const {
 bool tbv_manager::is_well_formed(tbv const& dst) const {
     unsigned nw = m.num_words();
     unsigned w;
-    for (unsigned i = 0; i + 1 < nw; ++i) {
-        w = dst.get_word(i);
-        w = w | (w << 1) | 0x55555555;
-        if (w != 0xFFFFFFFF) return false;
-    }
+    if (nw > 1 && has_zero_bit_pair(nw - 1, dst.m_data)) return false;
     if (nw > 0) {        
         w = m.last_word(dst);
         w = w | (w << 1) | 0x55555555 | ~m.get_mask();
@@ -257,6 +254,17 @@ bool tbv_manager::equals(tbv const& a, tbv const& b) const {
 unsigned tbv_manager::hash(tbv const& src) const {
     return m.hash(src);
 }
+uint64 tbv_manager::signature(tbv const& src) const {
+    unsigned nw = m.num_words();
+    uint64 sig = 0;
+    for (unsigned i = 0; i + 1 < nw; ++i) {
+        sig |= static_cast<uint64>(~src.get_word(i)) << (32 * (i & 1));
+    }
+    if (nw > 0) {
+        sig |= static_cast<uint64>(~m.last_word(src) & m.get_mask()) << (32 * ((nw - 1) & 1));
+    }
+    return sig;
+}
 bool tbv_manager::contains(tbv const& a, tbv const& b) const {
     return m.contains(a, b);
 }
@@ -72,6 +72,9 @@ public:
     void complement(tbv const& src, ptr_vector<tbv>& result);
     bool equals(tbv const& a, tbv const& b) const;
     unsigned hash(tbv const& src) const;
+    // the bits that are 0 in src folded onto 64 bits: if a contains b, then
+    // the signature of a is a subset of the signature of b.
+    uint64 signature(tbv const& src) const;
     bool contains(tbv const& a, tbv const& b) const;
     bool contains(tbv const& a, unsigned_vector const& colsa,
                   tbv const& b, unsigned_vector const& colsb) const;
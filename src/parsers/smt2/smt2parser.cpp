@@ -2555,10 +2555,10 @@ namespace smt2 {
         }
 
     public:
-        parser(cmd_context & ctx, std::istream & is, bool interactive, params_ref const & p):
+        parser(cmd_context & ctx, std::istream * is, char const * begin, char const * end, bool interactive, params_ref const & p):
             m_ctx(ctx), 
             m_params(p),
-            m_scanner(ctx, is, interactive),
+            m_scanner(ctx, is, begin, end, interactive),
             m_curr(scanner::NULL_TOKEN),
             m_curr_cmd(0),
             m_num_bindings(0),
@@ -2703,7 +2703,12 @@ namespace smt2 {
 };
 
 bool parse_smt2_commands(cmd_context & ctx, std::istream & is, bool interactive, params_ref const & ps) {
-    smt2::parser p(ctx, is, interactive, ps);
+    smt2::parser p(ctx, &is, 0, 0, interactive, ps);
+    return p();
+}
+
+bool parse_smt2_commands(cmd_context & ctx, char const * begin, char const * end, params_ref const & ps) {
+    smt2::parser p(ctx, 0, begin, end, false, ps);
     return p();
 }
 
@@ -23,4 +23,9 @@ Revision History:
 
 bool parse_smt2_commands(cmd_context & ctx, std::istream & is, bool interactive = false, params_ref const & p = params_ref());
 
+/**
+   \brief Parse the commands in the buffer [begin, end). The buffer is not copied.
+*/
+bool parse_smt2_commands(cmd_context & ctx, char const * begin, char const * end, params_ref const & p = params_ref());
+
 #endif
@@ -25,16 +25,25 @@ namespace smt2 {
         if (m_cache_input)
             m_cache.push_back(m_curr);
         SASSERT(m_curr != EOF);
-        if (m_interactive) {
-            m_curr = m_stream.get();
+        if (m_stream == 0) {
+            if (m_input < m_input_end) {
+                m_curr = *m_input;
+                m_input++;
+            }
+            else {
+                m_curr = EOF;
+            }
+        }
+        else if (m_interactive) {
+            m_curr = m_stream->get();
         }
         else if (m_bpos < m_bend) {
             m_curr = m_buffer[m_bpos];
             m_bpos++;
         }
         else {
-            m_stream.read(m_buffer, SCANNER_BUFFER_SIZE);
-            m_bend = static_cast<unsigned>(m_stream.gcount());
+            m_stream->read(m_buffer, SCANNER_BUFFER_SIZE);
+            m_bend = static_cast<unsigned>(m_stream->gcount());
             m_bpos = 0;
             if (m_bpos == m_bend) {
                 m_curr = EOF;
@@ -89,7 +98,40 @@ namespace smt2 {
         }
     }
 
+    /**
+       \brief Consume the symbol characters at the current position of the input buffer
+       without going through next().
+    */
+    void scanner::skip_symbol_chars() {
+        if (m_stream != 0 || curr() == EOF)
+            return;
+        char const * begin = m_input - 1;
+        char const * it    = begin;
+        while (it < m_input_end) {
+            signed char n = m_normalized[static_cast<unsigned char>(*it)];
+            if (n != 'a' && n != '0' && n != '-')
+                break;
+            ++it;
+        }
+        if (it == begin)
+            return;
+        unsigned sz = static_cast<unsigned>(it - begin);
+        m_string.append(sz, begin);
+        if (m_cache_input)
+            m_cache.append(sz, begin);
+        m_spos += sz;
+        if (it < m_input_end) {
+            m_curr  = *it;
+            m_input = it + 1;
+        }
+        else {
+            m_curr  = EOF;
+            m_input = m_input_end;
+        }
+    }
+
     scanner::token scanner::read_symbol_core() {
+        skip_symbol_chars();
         while (true) {
             char c = curr();
             signed char n = m_normalized[static_cast<unsigned char>(c)];
@@ -116,17 +158,27 @@ namespace smt2 {
 
     scanner::token scanner::read_number() {
         SASSERT('0' <= curr() && curr() <= '9');
-        rational q(1);
-        m_number = rational(curr() - '0');
-        next();
+        // digits are accumulated in a machine integer, and
+        // moved to m_number every max_digits digits.
+        static const unsigned max_digits = 18;
+        uint64   digits     = 0;
+        unsigned num_digits = 0;
+        unsigned num_frac   = 0;
+        m_number = rational(0);
         bool is_float = false;
 
         while (true) {
             char c = curr();
             if ('0' <= c && c <= '9') {
-                m_number = rational(10)*m_number + rational(c - '0');
+                digits = 10*digits + static_cast<uint64>(c - '0');
+                num_digits++;
                 if (is_float)
-                    q *= rational(10);
+                    num_frac++;
+                if (num_digits == max_digits) {
+                    m_number = power(rational(10), max_digits) * m_number + rational(digits, rational::ui64());
+                    digits     = 0;
+                    num_digits = 0;
+                }
                 next();
             }
             else if (c == '.') {
@@ -139,8 +191,12 @@ namespace smt2 {
                 break;
             }
         }
-        if (is_float)
-            m_number /= q;
+        if (m_number.is_zero())
+            m_number = rational(digits, rational::ui64());
+        else if (num_digits > 0)
+            m_number = power(rational(10), num_digits) * m_number + rational(digits, rational::ui64());
+        if (is_float && num_frac > 0)
+            m_number /= power(rational(10), num_frac);
         TRACE("scanner", tout << "new number: " << m_number << "\n";);
         return is_float ? FLOAT_TOKEN : INT_TOKEN;
     }
@@ -237,7 +293,7 @@ namespace smt2 {
         }
     }
 
-    scanner::scanner(cmd_context & ctx, std::istream& stream, bool interactive):
+    scanner::scanner(cmd_context & ctx, std::istream * stream, char const * begin, char const * end, bool interactive):
         m_interactive(interactive),
         m_spos(0),
         m_curr(0), // avoid Valgrind warning
@@ -247,7 +303,10 @@ namespace smt2 {
         m_bpos(0),
         m_bend(0),
         m_stream(stream),
+        m_input(begin),
+        m_input_end(end),
         m_cache_input(false) {
+        SASSERT(stream != 0 || begin <= end);
 
         m_smtlib2_compliant = ctx.params().m_smtlib2_compliant;
 
@@ -48,7 +48,10 @@ namespace smt2 {
         unsigned           m_bpos;
         unsigned           m_bend;
         svector<char>      m_string;
-        std::istream&      m_stream;
+        std::istream*      m_stream;
+        // input buffer (when the scanner is not reading from a stream)
+        char const *       m_input;     // position of the character after m_curr
+        char const *       m_input_end;
         
         bool               m_cache_input;
         svector<char>      m_cache;
@@ -59,6 +62,7 @@ namespace smt2 {
         char curr() const { return m_curr; }
         void new_line() { m_line++; m_spos = 0; }
         void next();
+        void skip_symbol_chars();
         
     public:
         
@@ -75,7 +79,11 @@ namespace smt2 {
             EOF_TOKEN
         };
         
-        scanner(cmd_context & ctx, std::istream& stream, bool interactive = false);
+        /**
+           \brief Create a scanner for \c stream. If \c stream is 0, then the scanner reads the
+           characters in [begin, end) directly. The buffer must remain valid while the scanner is used.
+        */
+        scanner(cmd_context & ctx, std::istream * stream, char const * begin = 0, char const * end = 0, bool interactive = false);
         
         ~scanner() {}    
         
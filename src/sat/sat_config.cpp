@@ -75,6 +75,11 @@ namespace sat {
         m_burst_search    = p.burst_search();
         
         m_max_conflicts   = p.max_conflicts();
+        m_num_threads     = p.threads();
+        m_partition_watches = p.partition_watches();
+        m_inprocess          = p.inprocess();
+        m_inprocess_interval = p.inprocess_interval();
+        m_inprocess_effort   = p.inprocess_effort();
         
         // These parameters are not exposed
         m_simplify_mult1  = _p.get_uint("simplify_mult1", 300);
@@ -56,6 +56,11 @@ namespace sat {
         unsigned           m_random_seed;
         unsigned           m_burst_search;
         unsigned           m_max_conflicts;
+        unsigned           m_num_threads;
+        bool               m_partition_watches;
+        bool               m_inprocess;
+        unsigned           m_inprocess_interval;
+        unsigned           m_inprocess_effort;
 
         unsigned           m_simplify_mult1;
         double             m_simplify_mult2;
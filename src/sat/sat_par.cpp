@@ -0,0 +1,61 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_par.cpp
+
+Abstract:
+
+    Utilities for parallel SAT solving (cube-and-conquer).
+
+--*/
+#include"sat_par.h"
+
+namespace sat {
+
+    par::par():
+        m_num_units(0),
+        m_num_bins(0),
+        m_num_cube_lemmas(0) {
+        omp_init_lock(&m_lock);
+    }
+
+    par::~par() {
+        omp_destroy_lock(&m_lock);
+    }
+
+    void par::share_clause(unsigned owner_id, unsigned num_global, unsigned num_lits, literal const * lits) {
+        omp_set_lock(&m_lock);
+        m_buffer.push_back(owner_id);
+        m_buffer.push_back(num_lits);
+        for (unsigned i = 0; i < num_lits; ++i)
+            m_buffer.push_back(lits[i].index());
+        if (num_lits > num_global)
+            m_num_cube_lemmas++;
+        else if (num_lits == 1)
+            m_num_units++;
+        else if (num_lits == 2)
+            m_num_bins++;
+        omp_unset_lock(&m_lock);
+    }
+
+    void par::get_clauses(unsigned owner_id, unsigned & head, literal_vector & lits) {
+        lits.reset();
+        omp_set_lock(&m_lock);
+        unsigned sz = m_buffer.size();
+        while (head < sz) {
+            unsigned id       = m_buffer[head];
+            unsigned num_lits = m_buffer[head + 1];
+            head += 2;
+            if (id != owner_id) {
+                for (unsigned i = 0; i < num_lits; ++i)
+                    lits.push_back(to_literal(m_buffer[head + i]));
+                lits.push_back(null_literal);
+            }
+            head += num_lits;
+        }
+        omp_unset_lock(&m_lock);
+    }
+
+};
@@ -0,0 +1,62 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_par.h
+
+Abstract:
+
+    Utilities for parallel SAT solving (cube-and-conquer).
+
+    Worker solvers exchange short learned clauses through a shared
+    buffer: units, binaries, and clauses that are units or binaries
+    under the cube of the worker (cube lemmas).
+
+Author:
+
+Revision History:
+
+--*/
+#ifndef SAT_PAR_H_
+#define SAT_PAR_H_
+
+#include"sat_types.h"
+#include"z3_omp.h"
+
+namespace sat {
+
+    class par {
+        // The buffer is a sequence of entries of the form:
+        //    owner_id num_lits lit_1 ... lit_num_lits
+        // Entries are never removed while the workers are running,
+        // each worker keeps the position of the first entry it has not read yet.
+        unsigned_vector  m_buffer;
+        omp_lock_t       m_lock;
+        unsigned         m_num_units;
+        unsigned         m_num_bins;
+        unsigned         m_num_cube_lemmas;
+    public:
+        par();
+        ~par();
+
+        /**
+           \brief Add a learned clause produced by worker \c owner_id.
+           The first \c num_global literals are not cube literals.
+        */
+        void share_clause(unsigned owner_id, unsigned num_global, unsigned num_lits, literal const * lits);
+
+        /**
+           \brief Store in \c lits the clauses (separated by null_literal) added by other workers
+           after position \c head. Update \c head.
+        */
+        void get_clauses(unsigned owner_id, unsigned & head, literal_vector & lits);
+
+        unsigned num_units() const { return m_num_units; }
+        unsigned num_bins() const { return m_num_bins; }
+        unsigned num_cube_lemmas() const { return m_num_cube_lemmas; }
+    };
+
+};
+
+#endif
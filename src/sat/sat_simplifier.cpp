@@ -57,7 +57,8 @@ namespace sat {
 
     simplifier::simplifier(solver & _s, params_ref const & p):
         s(_s),
-        m_num_calls(0) {
+        m_num_calls(0),
+        m_incremental(false) {
         updt_params(p);
         reset_statistics();
     }
@@ -79,16 +80,43 @@ namespace sat {
 
     inline void simplifier::checkpoint() { s.checkpoint(); }
 
+    void simplifier::init_dirty() {
+        m_dirty.reset();
+        m_dirty.resize(s.num_vars(), false);
+        bool_var_set::iterator it  = m_elim_todo.begin();
+        bool_var_set::iterator end = m_elim_todo.end();
+        for (; it != end; ++it)
+            m_dirty[*it] = true;
+    }
+
+    bool simplifier::is_dirty(clause const & c) const {
+        unsigned sz = c.size();
+        for (unsigned i = 0; i < sz; i++) {
+            if (m_dirty[c[i].var()])
+                return true;
+        }
+        return false;
+    }
+
     void simplifier::register_clauses(clause_vector & cs) {
         std::stable_sort(cs.begin(), cs.end(), size_lt());
         clause_vector::iterator it  = cs.begin();
         clause_vector::iterator end = cs.end();
         for (; it != end; ++it) {
             clause & c = *(*it);
-            if (!c.frozen()) {
-                m_use_list.insert(c);
-                if (c.strengthened())
-                    m_sub_todo.insert(c);
+            if (c.frozen())
+                continue;
+            if (m_incremental && !c.strengthened() && !is_dirty(c))
+                continue;
+            m_use_list.insert(c);
+            if (c.strengthened()) {
+                m_sub_todo.insert(c);
+                if (m_incremental) {
+                    // the variables of c become candidates in the next call.
+                    unsigned sz = c.size();
+                    for (unsigned i = 0; i < sz; i++)
+                        insert_todo(c[i].var());
+                }
             }
         }
     }
@@ -130,9 +158,10 @@ namespace sat {
         m_visited.finalize();
         m_bs_cs.finalize();
         m_bs_ls.finalize();
+        m_dirty.finalize();
     }
 
-    void simplifier::operator()(bool learned) {
+    void simplifier::operator()(bool learned, bool incremental) {
         if (s.inconsistent())
             return;
         if (!m_subsumption && !m_elim_blocked_clauses && !m_resolution)
@@ -146,8 +175,11 @@ namespace sat {
         TRACE("after_cleanup", s.display(tout););
         CASSERT("sat_solver", s.check_invariant());
         m_need_cleanup = false;
+        m_incremental  = incremental;
         m_use_list.init(s.num_vars());
         init_visited();
+        if (incremental)
+            init_dirty();
         bool learned_in_use_lists = false;
         if (learned) {
             register_clauses(s.m_learned);
@@ -155,7 +187,8 @@ namespace sat {
         }
         register_clauses(s.m_clauses);
 
-        if (!learned && (m_elim_blocked_clauses || m_elim_blocked_clauses_at == m_num_calls))
+        // blocked clause elimination requires complete use lists.
+        if (!learned && !incremental && (m_elim_blocked_clauses || m_elim_blocked_clauses_at == m_num_calls))
             elim_blocked_clauses();
 
 
@@ -186,7 +219,7 @@ namespace sat {
             TRACE("after_simplifier", tout << "cleanning watches...\n";);
             cleanup_watches();
             cleanup_clauses(s.m_learned, true, vars_eliminated,  learned_in_use_lists);
-            cleanup_clauses(s.m_clauses, false, vars_eliminated, true);
+            cleanup_clauses(s.m_clauses, false, vars_eliminated, !incremental);
         }
         else {
             TRACE("after_simplifier", tout << "skipping cleanup...\n";);
@@ -1083,6 +1116,7 @@ namespace sat {
 
     void simplifier::order_vars_for_elim(bool_var_vector & r) {
         svector<bool_var_and_cost> tmp;
+        bool_var_vector            deferred;
         bool_var_set::iterator it  = m_elim_todo.begin();
         bool_var_set::iterator end = m_elim_todo.end();
         for (; it != end; ++it) {
@@ -1093,10 +1127,17 @@ namespace sat {
                 continue;
             if (value(v) != l_undef)
                 continue;
+            if (m_incremental && !m_dirty[v]) {
+                // use lists of v are incomplete.
+                deferred.push_back(v);
+                continue;
+            }
             unsigned c = get_to_elim_cost(v);
             tmp.push_back(bool_var_and_cost(v, c));
         }
         m_elim_todo.reset();
+        for (unsigned i = 0; i < deferred.size(); i++)
+            m_elim_todo.insert(deferred[i]);
         std::stable_sort(tmp.begin(), tmp.end(), bool_var_and_cost_lt());
         TRACE("elim_vars",
               svector<bool_var_and_cost>::iterator it  = tmp.begin();
@@ -55,6 +55,8 @@ namespace sat {
         unsigned               m_last_sub_trail_sz; // size of the trail since last cleanup
         bool_var_set           m_elim_todo;
         bool                   m_need_cleanup;
+        bool                   m_incremental;
+        svector<char>          m_dirty;   // variables whose use lists are complete in incremental mode
         tmp_clause             m_dummy;
 
         // simplifier extra variable fields.
@@ -104,6 +106,8 @@ namespace sat {
         void mark_all_but(clause const & c, literal l);
         void unmark_all(clause const & c);
 
+        void init_dirty();
+        bool is_dirty(clause const & c) const;
         void register_clauses(clause_vector & cs);
 
         void remove_clause_core(clause & c);
@@ -175,7 +179,13 @@ namespace sat {
         void insert_todo(bool_var v) { m_elim_todo.insert(v); }
         void reset_todo() { m_elim_todo.reset(); }
 
-        void operator()(bool learned);
+        /**
+           \brief Simplify the problem clauses (and the learned clauses if \c learned is true).
+           If \c incremental is true, then use lists are only built for clauses that were
+           strengthened or contain a variable touched since the previous call (see insert_todo),
+           and only these variables are candidates for elimination.
+        */
+        void operator()(bool learned, bool incremental = false);
 
         void updt_params(params_ref const & p);
         static void collect_param_descrs(param_descrs & d);
@@ -21,6 +21,8 @@ Revision History:
 #include"luby.h"
 #include"trace.h"
 #include"sat_bceq.h"
+#include"scoped_ptr_vector.h"
+#include<algorithm>
 
 // define to update glue during propagation
 #define UPDATE_GLUE
@@ -48,11 +50,16 @@ namespace sat {
         m_case_split_queue(m_activity),
         m_qhead(0),
         m_scope_lvl(0),
-        m_params(p) {
+        m_params(p),
+        m_par(0),
+        m_par_id(0),
+        m_par_head(0) {
         updt_params(p);
         m_conflicts_since_gc      = 0;
         m_conflicts               = 0;
         m_next_simplify           = 0;
+        m_inprocess_step          = 0;
+        m_inprocess_props         = 0;
         m_num_checkpoints         = 0;
         m_initializing_preferred  = false;
     }
@@ -87,7 +94,7 @@ namespace sat {
         {
             // copy binary clauses
             vector<watch_list>::const_iterator it  = src.m_watches.begin();
-            vector<watch_list>::const_iterator end = src.m_watches.begin();
+            vector<watch_list>::const_iterator end = src.m_watches.end();
             for (unsigned l_idx = 0; it != end; ++it, ++l_idx) {
                 watch_list const & wlist = *it;
                 literal l = ~to_literal(l_idx);
@@ -97,10 +104,20 @@ namespace sat {
                     if (!it2->is_binary_non_learned_clause())
                         continue;
                     literal l2 = it2->get_literal();
+                    if (l.index() > l2.index())
+                        continue; // each binary clause is stored in two watch lists.
                     mk_clause_core(l, l2);
                 }
             }
         }
+        {
+            // copy units
+            unsigned trail_sz = src.scope_lvl() == 0 ? src.m_trail.size() : src.m_scopes[0].m_trail_lim;
+            for (unsigned i = 0; i < trail_sz; ++i) {
+                literal l = src.m_trail[i];
+                mk_clause_core(1, &l);
+            }
+        }
         {
             literal_vector buffer;
             // copy clause
@@ -216,8 +233,14 @@ namespace sat {
                 m_clauses_to_reinit.push_back(clause_wrapper(l1, l2));
         }
         m_stats.m_mk_bin_clause++;
-        m_watches[(~l1).index()].push_back(watched(l2, learned));
-        m_watches[(~l2).index()].push_back(watched(l1, learned));
+        if (m_config.m_partition_watches) {
+            insert_partitioned(m_watches[(~l1).index()], watched(l2, learned));
+            insert_partitioned(m_watches[(~l2).index()], watched(l1, learned));
+        }
+        else {
+            m_watches[(~l1).index()].push_back(watched(l2, learned));
+            m_watches[(~l2).index()].push_back(watched(l1, learned));
+        }
     }
 
     bool solver::propagate_bin_clause(literal l1, literal l2) {
@@ -257,9 +280,16 @@ namespace sat {
 
     void solver::attach_ter_clause(clause & c, bool & reinit) {
         reinit = false;
-        m_watches[(~c[0]).index()].push_back(watched(c[1], c[2]));
-        m_watches[(~c[1]).index()].push_back(watched(c[0], c[2]));
-        m_watches[(~c[2]).index()].push_back(watched(c[0], c[1]));
+        if (m_config.m_partition_watches) {
+            insert_partitioned(m_watches[(~c[0]).index()], watched(c[1], c[2]));
+            insert_partitioned(m_watches[(~c[1]).index()], watched(c[0], c[2]));
+            insert_partitioned(m_watches[(~c[2]).index()], watched(c[0], c[1]));
+        }
+        else {
+            m_watches[(~c[0]).index()].push_back(watched(c[1], c[2]));
+            m_watches[(~c[1]).index()].push_back(watched(c[0], c[2]));
+            m_watches[(~c[2]).index()].push_back(watched(c[0], c[1]));
+        }
         if (scope_lvl() > 0) {
             if (value(c[1]) == l_false && value(c[2]) == l_false) {
                 m_stats.m_ter_propagate++;
@@ -731,6 +761,8 @@ namespace sat {
             propagate(false);
             if (check_inconsistent()) return l_false;
             cleanup();
+            if (can_check_par(num_lits)) 
+                return check_par();
             if (m_config.m_max_conflicts > 0 && m_config.m_burst_search > 0) {
                 m_restart_threshold = m_config.m_burst_search;
                 lbool r = bounded_search();
@@ -764,6 +796,7 @@ namespace sat {
                 }
 
                 restart();
+                if (check_inconsistent()) return l_false;
                 simplify_problem();
                 if (check_inconsistent()) return l_false;                
                 gc();
@@ -774,6 +807,287 @@ namespace sat {
         }
     }
 
+    // -----------------------
+    //
+    // Parallel search (cube-and-conquer)
+    //
+    // -----------------------
+
+    bool solver::can_check_par(unsigned num_lits) const {
+        return 
+            m_config.m_num_threads > 1 && 
+            m_par == 0 && 
+            m_ext == 0 &&
+            num_lits == 0 && 
+            !tracking_assumptions() &&
+            m_mc.empty() &&
+            m_config.m_max_conflicts > 0;
+    }
+
+    void solver::set_par(par * p, unsigned id) {
+        m_par      = p;
+        m_par_id   = id;
+        m_par_head = 0;
+    }
+
+    void solver::mark_par_antecedent(literal l, unsigned & num_marked) {
+        if (lvl(l) != 0 && !is_marked(l.var())) {
+            SASSERT(lvl(l) == 1);
+            mark(l.var());
+            num_marked++;
+        }
+    }
+
+    /**
+       \brief Share m_lemma with the other workers if it is short.
+
+       The cube of a worker is assumed at level 1, so most lemmas contain literals
+       of level 1. Such literals are replaced by the cube literals they depend on.
+       The resulting clause is implied by the input clauses. It is shared if
+       at most two of its literals are not cube literals.
+       Must be called before backjumping, while level 1 is assigned.
+    */
+    void solver::share_lemma() {
+        SASSERT(m_par);
+        m_par_lemma.reset();
+        unsigned num_marked = 0;
+        bool resolve = tracking_assumptions() && scope_lvl() > 0;
+        for (unsigned i = 0; i < m_lemma.size(); ++i) {
+            literal l = m_lemma[i];
+            if (resolve && lvl(l) == 1)
+                mark_par_antecedent(~l, num_marked);
+            else
+                m_par_lemma.push_back(l);
+        }
+        unsigned num_global = m_par_lemma.size();
+        bool ok = num_global <= 2;
+        unsigned begin = resolve ? m_scopes[0].m_trail_lim : 0;
+        unsigned end   = resolve && scope_lvl() > 1 ? m_scopes[1].m_trail_lim : m_trail.size();
+        for (unsigned i = end; num_marked > 0 && i-- > begin; ) {
+            literal l = m_trail[i];
+            if (!is_marked(l.var()))
+                continue;
+            reset_mark(l.var());
+            num_marked--;
+            if (!ok)
+                continue;
+            justification js = m_justification[l.var()];
+            switch (js.get_kind()) {
+            case justification::NONE:
+                // a cube literal
+                m_par_lemma.push_back(~l);
+                break;
+            case justification::BINARY:
+                mark_par_antecedent(~js.get_literal(), num_marked);
+                break;
+            case justification::TERNARY:
+                mark_par_antecedent(~js.get_literal1(), num_marked);
+                mark_par_antecedent(~js.get_literal2(), num_marked);
+                break;
+            case justification::CLAUSE: {
+                clause & c = *(m_cls_allocator.get_clause(js.get_clause_offset()));
+                for (unsigned j = 0; j < c.size(); ++j) {
+                    if (c[j] != l)
+                        mark_par_antecedent(~c[j], num_marked);
+                }
+                break;
+            }
+            default:
+                // workers have no extension.
+                ok = false;
+                break;
+            }
+        }
+        SASSERT(num_marked == 0);
+        if (ok)
+            m_par->share_clause(m_par_id, num_global, m_par_lemma.size(), m_par_lemma.c_ptr());
+    }
+
+    /**
+       \brief Import the clauses learned by other workers.
+       Clauses containing variables eliminated by this solver, or satisfied at the base level, are ignored.
+       Literals that are false at the base level are removed.
+    */
+    void solver::import_par_clauses() {
+        SASSERT(m_par);
+        SASSERT(scope_lvl() == 0);
+        m_par->get_clauses(m_par_id, m_par_head, m_par_lits);
+        literal_vector cls;
+        bool skip = false;
+        for (unsigned i = 0; i < m_par_lits.size() && !inconsistent(); ++i) {
+            literal l = m_par_lits[i];
+            if (l == null_literal) {
+                if (!skip) {
+                    m_stats.m_par_imported++;
+                    mk_clause_core(cls.size(), cls.c_ptr(), true);
+                }
+                cls.reset();
+                skip = false;
+            }
+            else if (skip || was_eliminated(l.var()) || value(l) == l_true) {
+                skip = true;
+            }
+            else if (value(l) == l_undef) {
+                cls.push_back(l);
+            }
+        }
+        if (!inconsistent())
+            propagate(false);
+    }
+
+    struct activity_gt {
+        svector<unsigned> const & m_activity;
+        activity_gt(svector<unsigned> const & a):m_activity(a) {}
+        bool operator()(bool_var v1, bool_var v2) const { return m_activity[v1] > m_activity[v2]; }
+    };
+
+    /**
+       \brief Cube-and-conquer search.
+
+       A short sequential search initializes the activity of the variables.
+       The most active variables are used to split the search space into cubes,
+       and the cubes are solved as assumptions by m_config.m_num_threads worker
+       copies of this solver. The workers exchange learned units and binary clauses.
+    */
+    lbool solver::check_par() {
+        m_restart_threshold = m_config.m_burst_search;
+        lbool r = bounded_search();
+        if (r != l_undef)
+            return r;
+        pop_reinit(scope_lvl());
+        m_conflicts_since_restart = 0;
+        m_restart_threshold       = m_config.m_restart_initial;
+
+        unsigned num_threads = m_config.m_num_threads;
+        // create a few cubes per thread for load balancing.
+        unsigned num_split   = 0;
+        while ((1u << num_split) < 4 * num_threads && num_split < 16)
+            num_split++;
+        bool_var_vector split_vars;
+        for (bool_var v = 0; v < num_vars(); ++v) {
+            if (value(v) == l_undef && !was_eliminated(v) && m_decision[v] != 0)
+                split_vars.push_back(v);
+        }
+        if (split_vars.size() > num_split) {
+            std::partial_sort(split_vars.begin(), split_vars.begin() + num_split, split_vars.end(), activity_gt(m_activity));
+            split_vars.shrink(num_split);
+        }
+        num_split = split_vars.size();
+        unsigned num_cubes = 1u << num_split;
+        IF_VERBOSE(1, verbose_stream() << "(sat.par :threads " << num_threads << " :cubes " << num_cubes << ")\n";);
+
+        par                        exchange;
+        scoped_ptr_vector<reslimit> limits;
+        scoped_ptr_vector<solver>  workers;
+        for (unsigned i = 0; i < num_threads; ++i) {
+            params_ref p(m_params);
+            p.set_uint("random_seed", m_config.m_random_seed + i);
+            p.set_uint("threads", 1);
+            reslimit * lim = alloc(reslimit);
+            limits.push_back(lim);
+            solver * w = alloc(solver, p, *lim, 0);
+            workers.push_back(w);
+            w->copy(*this);
+            for (unsigned j = 0; j < num_split; ++j)
+                w->m_external[split_vars[j]] = true; // assumptions must not be eliminated
+            w->set_par(&exchange, i);
+        }
+        for (unsigned i = 0; i < num_threads; ++i)
+            m_rlimit.push_child(limits[i]);
+
+        volatile bool found_model = false;
+        unsigned num_refuted      = 0;
+        bool failed               = false;
+        bool is_error             = false;
+        unsigned error_code       = 0;
+        std::string ex_msg;
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (int c = 0; c < static_cast<int>(num_cubes); ++c) {
+            solver & w = *workers[omp_get_thread_num() % num_threads];
+            if (found_model)
+                continue;
+            literal_vector cube;
+            for (unsigned j = 0; j < num_split; ++j)
+                cube.push_back(literal(split_vars[j], ((c >> j) & 1) != 0));
+            lbool cube_r = l_undef;
+            try {
+                cube_r = w.check(cube.size(), cube.c_ptr());
+            }
+            catch (z3_error & err) {
+                #pragma omp critical (sat_par)
+                {
+                    if (!failed) {
+                        failed     = true;
+                        is_error   = true;
+                        error_code = err.error_code();
+                    }
+                }
+            }
+            catch (z3_exception & ex) {
+                #pragma omp critical (sat_par)
+                {
+                    if (!failed) {
+                        failed = true;
+                        ex_msg = ex.msg();
+                    }
+                }
+            }
+            #pragma omp critical (sat_par)
+            {
+                if (cube_r == l_true && !found_model) {
+                    found_model = true;
+                    m_model     = w.get_model();
+                    for (unsigned i = 0; i < num_threads; ++i)
+                        limits[i]->cancel();
+                }
+                else if (cube_r == l_false) {
+                    num_refuted++;
+                }
+            }
+        }
+
+        for (unsigned i = 0; i < num_threads; ++i)
+            m_rlimit.pop_child();
+
+        m_stats.m_par_cubes          += num_cubes;
+        m_stats.m_par_refuted_cubes  += num_refuted;
+        m_stats.m_par_shared_units   += exchange.num_units();
+        m_stats.m_par_shared_bins    += exchange.num_bins();
+        m_stats.m_par_shared_cube_lemmas += exchange.num_cube_lemmas();
+        for (unsigned i = 0; i < num_threads; ++i) {
+            stats const & ws = workers[i]->m_stats;
+            IF_VERBOSE(1, verbose_stream() << "(sat.par :worker " << i 
+                       << " :conflicts " << ws.m_conflict << " :decisions " << ws.m_decision 
+                       << " :propagations " << ws.m_propagate << " :restarts " << ws.m_restart 
+                       << " :imported " << ws.m_par_imported << ")\n";);
+            m_stats.m_conflict      += ws.m_conflict;
+            m_stats.m_decision      += ws.m_decision;
+            m_stats.m_propagate     += ws.m_propagate;
+            m_stats.m_bin_propagate += ws.m_bin_propagate;
+            m_stats.m_ter_propagate += ws.m_ter_propagate;
+            m_stats.m_restart       += ws.m_restart;
+            m_stats.m_par_imported  += ws.m_par_imported;
+        }
+
+        if (found_model) {
+            m_model_is_current = true;
+            return l_true;
+        }
+        if (num_refuted == num_cubes) {
+            // every cube is unsatisfiable and there are no assumptions.
+            set_conflict(justification());
+            return l_false;
+        }
+        if (failed) {
+            // the workers are canceled only when a model is found, so this is a
+            // cancelation of this solver, a resource limit, or an error.
+            if (is_error)
+                throw z3_error(error_code);
+            throw solver_exception(ex_msg.c_str());
+        }
+        return l_undef;
+    }
+
     bool_var solver::next_var() {
         bool_var next;
 
@@ -1116,6 +1430,11 @@ namespace sat {
         m_min_core_valid = false;
         m_min_core.reset();
         TRACE("sat", display(tout););
+
+        if (m_config.m_partition_watches) {
+            // watches added by the simplifiers are not partitioned.
+            sort_watch_lits();
+        }
         
         if (m_config.m_bcd) {
             bceq bc(*this);
@@ -1128,6 +1447,11 @@ namespace sat {
 
     */
     void solver::simplify_problem() {
+        if (m_config.m_inprocess && m_next_simplify > 0) {
+            // the first global simplification has been performed.
+            inprocess();
+            return;
+        }
         if (m_conflicts < m_next_simplify) {
             return;
         }
@@ -1187,6 +1511,78 @@ namespace sat {
         }
     }
 
+    /**
+       \brief Execute one of the simplification procedures with a budget
+       proportional to the number of propagations since the previous step.
+       The use lists of the simplifier are only built for the variables
+       touched since its previous execution.
+    */
+    void solver::inprocess() {
+        if (m_stats.m_propagate < m_inprocess_props)
+            m_inprocess_props = m_stats.m_propagate; // statistics were reset
+        unsigned delta = m_stats.m_propagate - m_inprocess_props;
+        if (delta < m_config.m_inprocess_interval)
+            return;
+        m_inprocess_props = m_stats.m_propagate;
+        unsigned budget = static_cast<unsigned>(std::min(static_cast<double>(INT_MAX),
+                                                         static_cast<double>(delta) * m_config.m_inprocess_effort / 100.0));
+        m_stats.m_inprocess++;
+        unsigned step = m_inprocess_step++ % 5;
+        IF_VERBOSE(2, verbose_stream() << "(sat.inprocess :step " << step << " :budget " << budget << ")\n";);
+        TRACE("sat", tout << "inprocess " << step << " " << budget << "\n";);
+
+        pop(scope_lvl());
+        SASSERT(scope_lvl() == 0);
+
+        m_cleaner();
+        CASSERT("sat_simplify_bug", check_invariant());
+        if (inconsistent())
+            return;
+
+        params_ref p(m_params);
+        switch (step) {
+        case 0:
+            m_scc();
+            break;
+        case 1:
+            p.set_bool("resolution", false);
+            p.set_uint("subsumption.limit", budget);
+            m_simplifier.updt_params(p);
+            m_simplifier(false, true);
+            m_simplifier.updt_params(m_params);
+            sort_watch_lits();
+            break;
+        case 2:
+            p.set_bool("subsumption", false);
+            p.set_uint("resolution.limit", budget);
+            m_simplifier.updt_params(p);
+            m_simplifier(false, true);
+            m_simplifier.updt_params(m_params);
+            sort_watch_lits();
+            break;
+        case 3:
+            p.set_uint("asymm_branch.limit", budget);
+            m_asymm_branch.updt_params(p);
+            m_asymm_branch(true);
+            m_asymm_branch.updt_params(m_params);
+            break;
+        default:
+            p.set_uint("probing_limit", budget);
+            m_probing.updt_params(p);
+            m_probing(true);
+            m_probing.updt_params(m_params);
+            break;
+        }
+        CASSERT("sat_missed_prop", check_missed_propagation());
+        CASSERT("sat_simplify_bug", check_invariant());
+
+        if (m_ext) {
+            m_ext->clauses_modifed();
+            m_ext->simplify();
+        }
+        reinit_assumptions();
+    }
+
     void solver::sort_watch_lits() {
         vector<watch_list>::iterator it  = m_watches.begin();
         vector<watch_list>::iterator end = m_watches.end();
@@ -1296,7 +1692,11 @@ namespace sat {
                    << " :restarts " << m_stats.m_restart << mk_stat(*this)
                    << " :time " << std::fixed << std::setprecision(2) << m_stopwatch.get_current_seconds() << ")\n";);
         IF_VERBOSE(30, display_status(verbose_stream()););
-        pop_reinit(scope_lvl());
+        pop(scope_lvl());
+        if (m_par)
+            import_par_clauses();
+        if (!inconsistent())
+            reinit_assumptions();
         m_conflicts_since_restart = 0;
         switch (m_config.m_restart) {
         case RS_GEOMETRIC:
@@ -1756,6 +2156,8 @@ namespace sat {
 
         unsigned glue = num_diff_levels(m_lemma.size(), m_lemma.c_ptr());
 
+        if (m_par)
+            share_lemma();
         pop_reinit(m_scope_lvl - new_scope_lvl);
         TRACE("sat_conflict_detail", display(tout); tout << "assignment:\n"; display_assignment(tout););
         clause * lemma = mk_clause_core(m_lemma.size(), m_lemma.c_ptr(), true);
@@ -3131,6 +3533,13 @@ namespace sat {
         st.update("minimized lits", m_minimized_lits);
         st.update("dyn subsumption resolution", m_dyn_sub_res);
         st.update("blocked correction sets", m_blocked_corr_sets);
+        st.update("par cubes", m_par_cubes);
+        st.update("par refuted cubes", m_par_refuted_cubes);
+        st.update("par shared units", m_par_shared_units);
+        st.update("par shared binaries", m_par_shared_bins);
+        st.update("par shared cube lemmas", m_par_shared_cube_lemmas);
+        st.update("par imported clauses", m_par_imported);
+        st.update("inprocess steps", m_inprocess);
     }
 
     void stats::reset() {
@@ -3150,6 +3559,13 @@ namespace sat {
         m_dyn_sub_res = 0;
         m_non_learned_generation = 0;
         m_blocked_corr_sets = 0;
+        m_par_cubes = 0;
+        m_par_refuted_cubes = 0;
+        m_par_shared_units = 0;
+        m_par_shared_bins = 0;
+        m_par_shared_cube_lemmas = 0;
+        m_par_imported = 0;
+        m_inprocess = 0;
     }
 
     void mk_stat::display(std::ostream & out) const {
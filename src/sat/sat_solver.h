@@ -34,6 +34,7 @@ Revision History:
 #include"sat_probing.h"
 #include"sat_mus.h"
 #include"sat_sls.h"
+#include"sat_par.h"
 #include"params.h"
 #include"statistics.h"
 #include"stopwatch.h"
@@ -62,6 +63,13 @@ namespace sat {
         unsigned m_dyn_sub_res;
         unsigned m_non_learned_generation;
         unsigned m_blocked_corr_sets;
+        unsigned m_par_cubes;
+        unsigned m_par_refuted_cubes;
+        unsigned m_par_shared_units;
+        unsigned m_par_shared_bins;
+        unsigned m_par_shared_cube_lemmas;
+        unsigned m_par_imported;
+        unsigned m_inprocess;
         stats() { reset(); }
         void reset();
         void collect_statistics(statistics & st) const;
@@ -130,6 +138,13 @@ namespace sat {
         literal_set             m_assumption_set;   // set of enabled assumptions
         literal_vector          m_core;             // unsat core
 
+        // parallel solving (cube-and-conquer)
+        par *                   m_par;              // clause exchange buffer, 0 if this solver is not a worker
+        unsigned                m_par_id;
+        unsigned                m_par_head;         // first entry of m_par that was not imported yet
+        literal_vector          m_par_lits;
+        literal_vector          m_par_lemma;
+
         void del_clauses(clause * const * begin, clause * const * end);
 
         friend class integrity_checker;
@@ -297,10 +312,19 @@ namespace sat {
         unsigned m_num_checkpoints;
         double   m_min_d_tk;
         unsigned m_next_simplify;
+        unsigned m_inprocess_step;  // next inprocessing technique (round-robin)
+        unsigned m_inprocess_props; // number of propagations at the last inprocessing step
         bool decide();
         bool_var next_var();
         lbool bounded_search();
         void init_search();
+
+        bool can_check_par(unsigned num_lits) const;
+        lbool check_par();
+        void set_par(par * p, unsigned id);
+        void mark_par_antecedent(literal l, unsigned & num_marked);
+        void share_lemma();
+        void import_par_clauses();
         
         literal_vector m_min_core;
         bool           m_min_core_valid;
@@ -319,6 +343,7 @@ namespace sat {
         bool tracking_assumptions() const;
         bool is_assumption(literal l) const;
         void simplify_problem();
+        void inprocess();
         void mk_model();
         bool check_model(model const & m) const;
         void restart();
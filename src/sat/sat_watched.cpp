@@ -21,6 +21,29 @@ Revision History:
 
 namespace sat {
 
+    void insert_partitioned(watch_list & wlist, watched const & w) {
+        wlist.push_back(w);
+        if (!w.is_binary_clause() && !w.is_ternary_clause())
+            return;
+        unsigned i  = wlist.size() - 1;
+        unsigned sz = i;
+        unsigned first_ter = 0;
+        while (first_ter < sz && wlist[first_ter].is_binary_clause())
+            ++first_ter;
+        unsigned first_cls = first_ter;
+        while (first_cls < sz && wlist[first_cls].is_ternary_clause())
+            ++first_cls;
+        // move w to the beginning of the clause segment
+        if (first_cls < sz) {
+            std::swap(wlist[first_cls], wlist[i]);
+            i = first_cls;
+        }
+        // move w to the beginning of the ternary segment
+        if (w.is_binary_clause() && first_ter < first_cls) {
+            std::swap(wlist[first_ter], wlist[i]);
+        }
+    }
+
     bool erase_clause_watch(watch_list & wlist, clause_offset c) {
         watch_list::iterator it  = wlist.begin();              
         watch_list::iterator end = wlist.end();                
@@ -126,6 +126,13 @@ namespace sat {
 
     typedef vector<watched> watch_list;
 
+    /**
+       \brief Add \c w to \c wlist. If the binary, ternary and clause watches
+       of \c wlist are in contiguous segments (in this order, see watched_lt),
+       then this property is preserved.
+    */
+    void insert_partitioned(watch_list & wlist, watched const & w);
+
     bool erase_clause_watch(watch_list & wlist, clause_offset c);
     inline void erase_ternary_watch(watch_list & wlist, literal l1, literal l2) { wlist.erase(watched(l1, l2)); }
 
@@ -24,6 +24,7 @@ Revision History:
 #include"smtlib_solver.h"
 #include"timeout.h"
 #include"smt2parser.h"
+#include"mapped_file.h"
 #include"dl_cmds.h"
 #include"dbg_cmds.h"
 #include"opt_cmds.h"
@@ -119,12 +120,12 @@ unsigned read_smtlib2_commands(char const * file_name) {
 
     bool result = true;
     if (file_name) {
-        std::ifstream in(file_name);
-        if (in.bad() || in.fail()) {
+        mapped_file in;
+        if (!in.open(file_name)) {
             std::cerr << "(error \"failed to open file '" << file_name << "'\")" << std::endl;
             exit(ERR_OPEN_FILE);
         }
-        result = parse_smt2_commands(ctx, in);
+        result = parse_smt2_commands(ctx, in.begin(), in.end());
     }
     else {
         result = parse_smt2_commands(ctx, std::cin, true);
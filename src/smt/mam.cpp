@@ -240,6 +240,7 @@ namespace smt {
     struct yield : public instruction {
         quantifier *      m_qa;
         app *             m_pat;
+        unsigned          m_num_matches; // how many times the pattern was matched
         unsigned short    m_num_bindings;
         unsigned          m_bindings[0];
     };
@@ -405,6 +406,7 @@ namespace smt {
         unsigned                   m_num_choices;
         instruction *              m_root;
         enode_vector               m_candidates; 
+        unsigned                   m_num_attempts; //!< how many times the tree was executed
 #ifdef Z3DEBUG
         context *                  m_context;
         ptr_vector<app>            m_patterns;
@@ -442,6 +444,22 @@ namespace smt {
             }
         }
 
+        void collect_yields(instruction * head, ptr_vector<yield> & result) const {
+            ptr_buffer<instruction> todo;
+            todo.push_back(head);
+            while (!todo.empty()) {
+                instruction * curr = todo.back();
+                todo.pop_back();
+                while (curr != 0) {
+                    if ((curr->m_opcode == CHOOSE || curr->m_opcode == NOOP) && static_cast<choose*>(curr)->m_alt != 0)
+                        todo.push_back(static_cast<choose*>(curr)->m_alt);
+                    if (curr->m_opcode >= YIELD1 && curr->m_opcode <= YIELDN)
+                        result.push_back(static_cast<yield*>(curr));
+                    curr = curr->m_next;
+                }
+            }
+        }
+
 #ifdef Z3DEBUG
         void display_label_hashes_core(std::ostream & out, app * p) const {
             if (p->is_ground()) {
@@ -485,7 +503,8 @@ namespace smt {
             m_filter_candidates(filter_candidates),
             m_num_regs(num_args + 1),
             m_num_choices(0),
-            m_root(0) {
+            m_root(0),
+            m_num_attempts(0) {
             DEBUG_CODE(m_context = 0;);
 #ifdef _PROFILE_MAM
             m_counter = 0;
@@ -552,6 +571,33 @@ namespace smt {
             return m_candidates;
         }
 
+        void inc_num_attempts() {
+            m_num_attempts++;
+        }
+
+        unsigned get_num_attempts() const {
+            return m_num_attempts;
+        }
+
+        /**
+           \brief Display, for each pattern in the tree, the number of times the tree
+           was executed and the number of matches found for the pattern.
+        */
+        void display_pattern_stats(std::ostream & out) const {
+            ptr_vector<yield> yields;
+            collect_yields(m_root, yields);
+            ptr_vector<yield>::const_iterator it  = yields.begin();
+            ptr_vector<yield>::const_iterator end = yields.end();
+            for (; it != end; ++it) {
+                out << "[pattern_matches] ";
+                out.width(10);
+                out << (*it)->m_qa->get_qid().str().c_str() << " : ";
+                out << m_root_lbl->get_name() << " : ";
+                out.width(8);
+                out << m_num_attempts << " : " << (*it)->m_num_matches << "\n";
+            }
+        }
+
 #ifdef Z3DEBUG
         void set_context(context * ctx) {
             SASSERT(m_context == 0);
@@ -738,6 +784,7 @@ namespace smt {
             yield * y         = mk_instr<yield>(op, sizeof(yield) + num_bindings * sizeof(unsigned));
             y->m_qa           = qa;
             y->m_pat          = pat;
+            y->m_num_matches  = 0;
             y->m_num_bindings = num_bindings;
             memcpy(y->m_bindings, bindings, sizeof(unsigned) * num_bindings);
             return y;
@@ -1857,6 +1904,9 @@ namespace smt {
         unsigned            m_curr_used_enodes_size;
         ptr_vector<enode>   m_pattern_instances; // collect the pattern instances... used for computing min_top_generation and max_top_generation
 
+        unsigned            m_num_attempts;      // number of executed code trees
+        unsigned            m_num_matches;       // number of yield instructions reached
+
         pool<enode_vector>  m_pool;
 
         enode_vector * mk_enode_vector() {
@@ -1984,10 +2034,16 @@ namespace smt {
             m_context(ctx),
             m_ast_manager(ctx.get_manager()),
             m_mam(m), 
-            m_use_filters(use_filters) {
+            m_use_filters(use_filters),
+            m_num_attempts(0),
+            m_num_matches(0) {
             m_args.resize(INIT_ARGS_SIZE, 0);
         }
 
+        unsigned get_num_attempts() const { return m_num_attempts; }
+
+        unsigned get_num_matches() const { return m_num_matches; }
+
         ~interpreter() {
         }
 
@@ -2277,6 +2333,8 @@ namespace smt {
         // It doesn't make sense to process an irrelevant enode.
         TRACE("mam_execute_core", tout << "EXEC " << t->get_root_lbl()->get_name() << "\n";);
         SASSERT(m_context.is_relevant(n));
+        t->inc_num_attempts();
+        m_num_attempts++;
         m_pattern_instances.reset();
         m_pattern_instances.push_back(n);
         m_max_generation = n->get_generation();
@@ -2498,6 +2556,8 @@ namespace smt {
         case YIELD1:
             m_bindings[0] = m_registers[static_cast<const yield *>(m_pc)->m_bindings[0]];
 #define ON_MATCH(NUM)                                                                                   \
+            const_cast<yield *>(static_cast<const yield *>(m_pc))->m_num_matches++;                     \
+            m_num_matches++;                                                                            \
             m_max_generation = std::max(m_max_generation, get_max_generation(NUM, m_bindings.begin())); \
             m_mam.on_match(static_cast<const yield *>(m_pc)->m_qa,                                      \
                            static_cast<const yield *>(m_pc)->m_pat,                                     \
@@ -2818,26 +2878,43 @@ namespace smt {
         compiler &                  m_compiler;
         ptr_vector<code_tree>       m_trees;       // mapping: func_label -> tree
         mam_trail_stack &           m_trail_stack;
+        bool                        m_profile;     // display pattern statistics when a tree is deleted
 #ifdef Z3DEBUG
         context *                   m_context;
 #endif
 
         class mk_tree_trail : public mam_trail {
-            ptr_vector<code_tree> & m_trees;
-            unsigned                m_lbl_id;
+            code_tree_map & m_map;
+            unsigned        m_lbl_id;
         public:
-            mk_tree_trail(ptr_vector<code_tree> & t, unsigned id):m_trees(t), m_lbl_id(id) {}
+            mk_tree_trail(code_tree_map & t, unsigned id):m_map(t), m_lbl_id(id) {}
             virtual void undo(mam_impl & m) {
-                dealloc(m_trees[m_lbl_id]);
-                m_trees[m_lbl_id] = 0;
+                m_map.del_tree(m_map.m_trees[m_lbl_id]);
+                m_map.m_trees[m_lbl_id] = 0;
             }
         };
+
+        void del_tree(code_tree * t) {
+            if (t == 0)
+                return;
+            if (m_profile)
+                t->display_pattern_stats(verbose_stream());
+            dealloc(t);
+        }
+
+        void del_trees() {
+            ptr_vector<code_tree>::iterator it  = m_trees.begin();
+            ptr_vector<code_tree>::iterator end = m_trees.end();
+            for (; it != end; ++it)
+                del_tree(*it);
+        }
         
     public:
-        code_tree_map(ast_manager & m, compiler & c, mam_trail_stack & s):
+        code_tree_map(ast_manager & m, compiler & c, mam_trail_stack & s, bool profile):
             m_ast_manager(m),
             m_compiler(c),
-            m_trail_stack(s) {
+            m_trail_stack(s),
+            m_profile(profile) {
         }
 
 #ifdef Z3DEBUG
@@ -2845,7 +2922,7 @@ namespace smt {
 #endif
 
         ~code_tree_map() {
-            std::for_each(m_trees.begin(), m_trees.end(), delete_proc<code_tree>());
+            del_trees();
         }
 
         /**
@@ -2866,7 +2943,7 @@ namespace smt {
                 m_trees[lbl_id] = m_compiler.mk_tree(qa, mp, first_idx, false);
                 SASSERT(m_trees[lbl_id]->expected_num_args() == p->get_num_args());
                 DEBUG_CODE(m_trees[lbl_id]->set_context(m_context););
-                m_trail_stack.push(mk_tree_trail(m_trees, lbl_id));
+                m_trail_stack.push(mk_tree_trail(*this, lbl_id));
             }
             else {
                 code_tree * tree = m_trees[lbl_id];
@@ -2884,7 +2961,7 @@ namespace smt {
         }
 
         void reset() {
-            std::for_each(m_trees.begin(), m_trees.end(), delete_proc<code_tree>());
+            del_trees();
             m_trees.reset();
         }
 
@@ -3792,7 +3869,7 @@ namespace smt {
             m_ct_manager(m_lbl_hasher, m_trail_stack),
             m_compiler(ctx, m_ct_manager, m_lbl_hasher, use_filters),
             m_interpreter(ctx, *this, use_filters),
-            m_trees(m_ast_manager, m_compiler, m_trail_stack),
+            m_trees(m_ast_manager, m_compiler, m_trail_stack, ctx.get_fparams().m_qi_profile),
             m_region(m_trail_stack.get_region()),
             m_r1(0),
             m_r2(0) {
@@ -3857,6 +3934,11 @@ namespace smt {
             m_tmp_region.reset();
         }
 
+        virtual void collect_statistics(::statistics & st) const {
+            st.update("mam match attempts", m_interpreter.get_num_attempts());
+            st.update("mam matches", m_interpreter.get_num_matches());
+        }
+
         virtual void display(std::ostream& out) {
             out << "mam:\n";
             m_lbl_hasher.display(out);
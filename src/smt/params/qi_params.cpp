@@ -35,4 +35,5 @@ void qi_params::updt_params(params_ref const & _p) {
     m_qi_lazy_threshold = p.qi_lazy_threshold();
     m_qi_cost = p.qi_cost();
     m_qi_max_eager_multipatterns = p.qi_max_multi_patterns();
+    m_qi_dedup = p.qi_dedup();
 }
@@ -26,10 +26,15 @@ void smt_params::updt_local_params(params_ref const & _p) {
     m_auto_config = p.auto_config() && gparams::get_value("auto_config") == "true"; // auto-config is not scoped by smt in gparams.
     m_random_seed = p.random_seed();
     m_relevancy_lvl = p.relevancy();
+    m_compact_justifications = p.compact_justifications();
     m_ematching   = p.ematching();
     m_phase_selection = static_cast<phase_selection>(p.phase_selection());
     m_restart_strategy = static_cast<restart_strategy>(p.restart_strategy());
     m_restart_factor = p.restart_factor();
+    m_restart_glue_margin = p.restart_glue_margin();
+    m_lemma_gc_tiered = p.lemma_gc_tiered();
+    m_lemma_gc_core_glue = p.lemma_gc_core_glue();
+    m_lemma_gc_tier2_glue = p.lemma_gc_tier2_glue();
     m_case_split_strategy = static_cast<case_split_strategy>(p.case_split());
     m_delay_units = p.delay_units();
     m_delay_units_threshold = p.delay_units_threshold();
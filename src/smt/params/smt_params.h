@@ -45,7 +45,8 @@ enum restart_strategy {
     RS_IN_OUT_GEOMETRIC,
     RS_LUBY,
     RS_FIXED,
-    RS_ARITHMETIC
+    RS_ARITHMETIC,
+    RS_GLUCOSE     // restart when the glue of recent lemmas is above the global average
 };
 
 enum lemma_gc_strategy {
@@ -94,6 +95,7 @@ struct smt_params : public preprocessor_params,
     unsigned         m_phase_caching_on;
     unsigned         m_phase_caching_off;
     bool             m_minimize_lemmas;
+    bool             m_compact_justifications;
     unsigned         m_max_conflicts;
     bool             m_simplify_clauses;
     unsigned         m_tick;
@@ -136,6 +138,7 @@ struct smt_params : public preprocessor_params,
     bool             m_restart_adaptive;
     double           m_agility_factor;
     double           m_restart_agility_threshold;
+    double           m_restart_glue_margin; //!< RS_GLUCOSE: restart when recent average glue > margin * global average glue.
 
     // -----------------------------------
     //
@@ -147,6 +150,9 @@ struct smt_params : public preprocessor_params,
     unsigned          m_recent_lemmas_size;
     unsigned          m_lemma_gc_initial;
     double            m_lemma_gc_factor;
+    bool              m_lemma_gc_tiered;        //!< keep lemmas in core/tier2/local tiers based on their glue.
+    unsigned          m_lemma_gc_core_glue;     //!< lemmas with glue <= this value are never deleted.
+    unsigned          m_lemma_gc_tier2_glue;    //!< lemmas with glue <= this value are deleted only when unused.
     unsigned          m_new_old_ratio;     //!< the ratio of new and old clauses.
     unsigned          m_new_clause_activity;  
     unsigned          m_old_clause_activity;
@@ -230,6 +236,7 @@ struct smt_params : public preprocessor_params,
         m_phase_caching_on(400),
         m_phase_caching_off(100),
         m_minimize_lemmas(true),
+        m_compact_justifications(false),
         m_max_conflicts(UINT_MAX),
         m_simplify_clauses(true),
         m_tick(1000),
@@ -248,11 +255,15 @@ struct smt_params : public preprocessor_params,
         m_restart_adaptive(true),
         m_agility_factor(0.9999),
         m_restart_agility_threshold(0.18),
+        m_restart_glue_margin(1.25),
         m_lemma_gc_strategy(LGC_FIXED),
         m_lemma_gc_half(false),
         m_recent_lemmas_size(100),
         m_lemma_gc_initial(5000),
         m_lemma_gc_factor(1.1),
+        m_lemma_gc_tiered(false),
+        m_lemma_gc_core_glue(2),
+        m_lemma_gc_tier2_glue(6),
         m_new_old_ratio(16),
         m_new_clause_activity(10),
         m_old_clause_activity(500),
@@ -259,6 +259,18 @@ namespace smt {
         else {
             lemma = m_manager.mk_or(m_manager.mk_not(q), s_instance);
         }
+        if (m_params.m_qi_dedup) {
+            if (m_lemmas.contains(lemma)) {
+                // Different bindings may produce the same lemma (e.g., after simplification),
+                // and it is already asserted in the current branch.
+                TRACE("qi_queue", tout << "duplicate instance:\n" << mk_pp(lemma, m_manager) << "\n";);
+                m_stats.m_num_duplicate_instances++;
+                if (m_manager.has_trace_stream()) 
+                    m_manager.trace_stream() << "[end-of-instance]\n";
+                return;
+            }
+            m_lemmas.insert(lemma);
+        }
         m_instances.push_back(lemma);
         proof_ref pr1(m_manager);
         unsigned proof_id = 0;
@@ -341,6 +353,10 @@ namespace smt {
             m_delayed_entries[m_instantiated_trail[i]].m_instantiated = false;
         m_instantiated_trail.shrink(old_sz);
         m_delayed_entries.shrink(s.m_delayed_entries_lim);
+        if (!m_lemmas.empty()) {
+            for (unsigned i = s.m_instances_lim; i < m_instances.size(); i++)
+                m_lemmas.erase(m_instances.get(i));
+        }
         m_instances.shrink(s.m_instances_lim);
         m_new_entries.reset();
         m_scopes.shrink(new_lvl);
@@ -351,6 +367,7 @@ namespace smt {
         m_new_entries.reset();
         m_delayed_entries.reset();
         m_instances.reset();
+        m_lemmas.reset();
         m_scopes.reset();
     }
 
@@ -475,6 +492,7 @@ namespace smt {
     void qi_queue::collect_statistics(::statistics & st) const {
         st.update("quant instantiations", m_stats.m_num_instances);
         st.update("lazy quant instantiations", m_stats.m_num_lazy_instances);
+        st.update("duplicate quant instantiations", m_stats.m_num_duplicate_instances);
         st.update("missed quant instantiations", m_delayed_entries.size());
         float min, max;
         get_min_max_costs(min, max);
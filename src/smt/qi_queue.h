@@ -29,12 +29,13 @@ Revision History:
 #include"cost_evaluator.h"
 #include"cached_var_subst.h"
 #include"statistics.h"
+#include"obj_hashtable.h"
 
 namespace smt {
     class context;
 
     struct qi_queue_stats {
-        unsigned m_num_instances, m_num_lazy_instances;
+        unsigned m_num_instances, m_num_lazy_instances, m_num_duplicate_instances;
         void reset() { memset(this, 0, sizeof(qi_queue_stats)); }
         qi_queue_stats() { reset(); }
     };
@@ -63,6 +64,7 @@ namespace smt {
         svector<entry>                m_new_entries;
         svector<entry>                m_delayed_entries;
         expr_ref_vector               m_instances;
+        obj_hashtable<expr>           m_lemmas;  // lemmas stored in m_instances when qi.dedup is set, used to skip duplicate instances
         unsigned_vector               m_instantiated_trail;
         struct scope {
             unsigned   m_delayed_entries_lim;
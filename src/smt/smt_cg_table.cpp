@@ -107,7 +107,8 @@ namespace smt {
 
 #else
     // one table per func_decl implementation
-    unsigned cg_table::cg_hash::operator()(enode * n) const {
+    unsigned cg_table::cg_hash::operator()(cg_key const & k) const {
+        enode * n = k.m_node;
         SASSERT(n->get_decl()->is_flat_associative() || n->get_num_args() >= 3);
         unsigned a, b, c;
         a = b = 0x9e3779b9;
@@ -135,8 +136,11 @@ namespace smt {
         return c;
     }
 
-    bool cg_table::cg_eq::operator()(enode * n1, enode * n2) const {
-        SASSERT(n1->get_num_args() == n2->get_num_args());
+    bool cg_table::cg_eq::operator()(cg_key const & k1, cg_key const & k2) const {
+        enode * n1 = k1.m_node;
+        enode * n2 = k2.m_node;
+        if (n1->get_num_args() != n2->get_num_args())
+            return false;
         SASSERT(n1->get_decl() == n2->get_decl());
         unsigned num = n1->get_num_args();
         for (unsigned i = 0; i < num; i++) 
@@ -169,7 +173,7 @@ namespace smt {
                 return r;
             }
             else if (d->is_commutative()) {
-                r = TAG(void*, alloc(comm_table, cg_comm_hash(), cg_comm_eq(m_commutativity)), BINARY_COMM);
+                r = TAG(void*, alloc(comm_table, DEFAULT_HASHTABLE_INITIAL_CAPACITY, cg_comm_hash(), cg_comm_eq(m_commutativity)), BINARY_COMM);
                 SASSERT(GET_TAG(r) == BINARY_COMM);
                 return r;
             }
@@ -21,7 +21,6 @@ Revision History:
 
 #include"smt_enode.h"
 #include"hashtable.h"
-#include"chashtable.h"
 
 namespace smt {
 
@@ -116,66 +115,84 @@ namespace smt {
        \brief Congruence table.
     */
     class cg_table {
+        /**
+           \brief Key stored in the congruence tables: the enode and the roots of its
+           arguments at insertion time. For unary and binary applications the roots are
+           cached inline, so a probe compares entries without dereferencing the
+           arguments of the enodes in the table. The cached roots remain valid while n
+           is in the table, since the parents of a root are removed from the table
+           before it is merged (and before a merge is undone).
+        */
+        struct cg_key {
+            enode * m_node;
+            enode * m_root1;
+            enode * m_root2;
+            cg_key():m_node(0), m_root1(0), m_root2(0) {}
+            cg_key(enode * n, enode * r1, enode * r2):m_node(n), m_root1(r1), m_root2(r2) {}
+        };
+
+        /**
+           \brief Open addressing entry for core_hashtable. 
+           The hash code is cached, and 0x0 and 0x1 are used to represent HT_FREE and HT_DELETED.
+        */
+        class cg_entry {
+            unsigned   m_hash;
+            cg_key     m_key;
+        public:
+            typedef cg_key data;
+            cg_entry() {}
+            unsigned get_hash() const { return m_hash; }
+            bool is_free() const { return m_key.m_node == 0; }
+            bool is_deleted() const { return m_key.m_node == reinterpret_cast<enode *>(1); }
+            bool is_used() const { return m_key.m_node != reinterpret_cast<enode *>(0) && m_key.m_node != reinterpret_cast<enode *>(1); }
+            cg_key const & get_data() const { return m_key; }
+            cg_key & get_data() { return m_key; }
+            void set_data(cg_key const & k) { m_key = k; }
+            void set_hash(unsigned h) { m_hash = h; }
+            void mark_as_deleted() { m_key.m_node = reinterpret_cast<enode *>(1); }
+            void mark_as_free() { m_key.m_node = 0; }
+        };
+
         struct cg_unary_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 1);
-                return n->get_arg(0)->get_root()->hash();
+            unsigned operator()(cg_key const & k) const {
+                SASSERT(k.m_node->get_num_args() == 1);
+                return k.m_root1->hash();
             }
         };
 
         struct cg_unary_eq {
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 1);
-                SASSERT(n2->get_num_args() == 1);
-                SASSERT(n1->get_decl() == n2->get_decl());
-                return n1->get_arg(0)->get_root() == n2->get_arg(0)->get_root();
+            bool operator()(cg_key const & k1, cg_key const & k2) const {
+                SASSERT(k1.m_node->get_decl() == k2.m_node->get_decl());
+                return k1.m_root1 == k2.m_root1;
             }
         };
 
-        typedef chashtable<enode *, cg_unary_hash, cg_unary_eq> unary_table;
+        typedef core_hashtable<cg_entry, cg_unary_hash, cg_unary_eq> unary_table;
         
         struct cg_binary_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 2);
+            unsigned operator()(cg_key const & k) const {
+                SASSERT(k.m_node->get_num_args() == 2);
                 // too many collisions
                 // unsigned r = 17 + n->get_arg(0)->get_root()->hash();
                 // return r * 31 + n->get_arg(1)->get_root()->hash();
-                return combine_hash(n->get_arg(0)->get_root()->hash(), n->get_arg(1)->get_root()->hash());
+                return combine_hash(k.m_root1->hash(), k.m_root2->hash());
             }
         };
 
         struct cg_binary_eq {
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 2);
-                SASSERT(n2->get_num_args() == 2);
-                SASSERT(n1->get_decl() == n2->get_decl());
-#if 1
-                return 
-                    n1->get_arg(0)->get_root() == n2->get_arg(0)->get_root() &&
-                    n1->get_arg(1)->get_root() == n2->get_arg(1)->get_root();
-#else
-                bool r = 
-                    n1->get_arg(0)->get_root() == n2->get_arg(0)->get_root() &&
-                    n1->get_arg(1)->get_root() == n2->get_arg(1)->get_root();
-                static unsigned counter = 0;
-                static unsigned failed  = 0;
-                if (!r) 
-                    failed++;
-                counter++;
-                if (counter % 100000 == 0) 
-                    std::cerr << "[cg_eq] " << counter << " " << failed << "\n";
-                return r;
-#endif
+            bool operator()(cg_key const & k1, cg_key const & k2) const {
+                SASSERT(k1.m_node->get_decl() == k2.m_node->get_decl());
+                return k1.m_root1 == k2.m_root1 && k1.m_root2 == k2.m_root2;
             }
         };
 
-        typedef chashtable<enode*, cg_binary_hash, cg_binary_eq> binary_table;
+        typedef core_hashtable<cg_entry, cg_binary_hash, cg_binary_eq> binary_table;
         
         struct cg_comm_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 2);
-                unsigned h1 = n->get_arg(0)->get_root()->hash();
-                unsigned h2 = n->get_arg(1)->get_root()->hash();
+            unsigned operator()(cg_key const & k) const {
+                SASSERT(k.m_node->get_num_args() == 2);
+                unsigned h1 = k.m_root1->hash();
+                unsigned h2 = k.m_root2->hash();
                 if (h1 > h2)
                     std::swap(h1, h2);
                 return hash_u((h1 << 16) | (h2 & 0xFFFF));
@@ -185,18 +202,12 @@ namespace smt {
         struct cg_comm_eq {
             bool & m_commutativity;
             cg_comm_eq(bool & c):m_commutativity(c) {}
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 2);
-                SASSERT(n2->get_num_args() == 2);
-                SASSERT(n1->get_decl() == n2->get_decl());
-                enode * c1_1 = n1->get_arg(0)->get_root();
-                enode * c1_2 = n1->get_arg(1)->get_root();
-                enode * c2_1 = n2->get_arg(0)->get_root();
-                enode * c2_2 = n2->get_arg(1)->get_root();
-                if (c1_1 == c2_1 && c1_2 == c2_2) {
+            bool operator()(cg_key const & k1, cg_key const & k2) const {
+                SASSERT(k1.m_node->get_decl() == k2.m_node->get_decl());
+                if (k1.m_root1 == k2.m_root1 && k1.m_root2 == k2.m_root2) {
                     return true;
                 }
-                if (c1_1 == c2_2 && c1_2 == c2_1) {
+                if (k1.m_root1 == k2.m_root2 && k1.m_root2 == k2.m_root1) {
                     m_commutativity = true;
                     return true;
                 }
@@ -204,17 +215,18 @@ namespace smt {
             }
         };
 
-        typedef chashtable<enode*, cg_comm_hash, cg_comm_eq> comm_table;
+        typedef core_hashtable<cg_entry, cg_comm_hash, cg_comm_eq> comm_table;
 
+        // n-ary applications: the arguments are only visited when the cached hash codes match.
         struct cg_hash {
-            unsigned operator()(enode * n) const;
+            unsigned operator()(cg_key const & k) const;
         };
 
         struct cg_eq {
-            bool operator()(enode * n1, enode * n2) const;
+            bool operator()(cg_key const & k1, cg_key const & k2) const;
         };
 
-        typedef chashtable<enode*, cg_hash, cg_eq> table;
+        typedef core_hashtable<cg_entry, cg_hash, cg_eq> table;
 
         ast_manager &                 m_manager;
         bool                          m_commutativity; //!< true if the last found congruence used commutativity
@@ -239,6 +251,24 @@ namespace smt {
             return m_tables[tid];
         }
 
+        static cg_key mk_key(enode * n, table_kind k) {
+            switch (k) {
+            case UNARY:
+                return cg_key(n, n->get_arg(0)->get_root(), 0);
+            case BINARY:
+            case BINARY_COMM:
+                return cg_key(n, n->get_arg(0)->get_root(), n->get_arg(1)->get_root());
+            default:
+                return cg_key(n, 0, 0);
+            }
+        }
+
+        template<typename Table>
+        static enode * find_in(void * t, cg_key const & k) {
+            cg_entry * e = UNTAG(Table*, t)->find_core(k);
+            return e == 0 ? 0 : e->get_data().m_node;
+        }
+
     public:
         cg_table(ast_manager & m);
         ~cg_table();
@@ -252,89 +282,66 @@ namespace smt {
         enode_bool_pair insert(enode * n) {
             // it doesn't make sense to insert a constant.
             SASSERT(n->get_num_args() > 0);
-            enode * n_prime;
             void * t = get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
+            table_kind k = static_cast<table_kind>(GET_TAG(t));
+            cg_key key = mk_key(n, k);
+            switch (k) {
             case UNARY:
-                n_prime = UNTAG(unary_table*, t)->insert_if_not_there(n);
-                return enode_bool_pair(n_prime, false);
+                return enode_bool_pair(UNTAG(unary_table*, t)->insert_if_not_there(key).m_node, false);
             case BINARY:
-                n_prime = UNTAG(binary_table*, t)->insert_if_not_there(n);
-                return enode_bool_pair(n_prime, false);
+                return enode_bool_pair(UNTAG(binary_table*, t)->insert_if_not_there(key).m_node, false);
             case BINARY_COMM:
                 m_commutativity = false;
-                n_prime = UNTAG(comm_table*, t)->insert_if_not_there(n);
-                return enode_bool_pair(n_prime, m_commutativity);
+                return enode_bool_pair(UNTAG(comm_table*, t)->insert_if_not_there(key).m_node, m_commutativity);
             default:
-                n_prime = UNTAG(table*, t)->insert_if_not_there(n);
-                return enode_bool_pair(n_prime, false);
+                return enode_bool_pair(UNTAG(table*, t)->insert_if_not_there(key).m_node, false);
             }
         }
 
         void erase(enode * n) {
             SASSERT(n->get_num_args() > 0);
             void * t = get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
+            table_kind k = static_cast<table_kind>(GET_TAG(t));
+            cg_key key = mk_key(n, k);
+            switch (k) {
             case UNARY:
-                UNTAG(unary_table*, t)->erase(n);
+                UNTAG(unary_table*, t)->erase(key);
                 break;
             case BINARY:
-                UNTAG(binary_table*, t)->erase(n);
+                UNTAG(binary_table*, t)->erase(key);
                 break;
             case BINARY_COMM:
-                UNTAG(comm_table*, t)->erase(n);
+                UNTAG(comm_table*, t)->erase(key);
                 break;
             default:
-                UNTAG(table*, t)->erase(n);
+                UNTAG(table*, t)->erase(key);
                 break;
             }
         }
 
         bool contains(enode * n) const {
-            SASSERT(n->get_num_args() > 0);
-            void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
-            case UNARY:
-                return UNTAG(unary_table*, t)->contains(n);
-            case BINARY:
-                return UNTAG(binary_table*, t)->contains(n);
-            case BINARY_COMM:
-                return UNTAG(comm_table*, t)->contains(n);
-            default:
-                return UNTAG(table*, t)->contains(n);
-            }
+            return find(n) != 0;
         }
 
         enode * find(enode * n) const {
             SASSERT(n->get_num_args() > 0);
-            enode * r = 0;
             void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
+            table_kind k = static_cast<table_kind>(GET_TAG(t));
+            cg_key key = mk_key(n, k);
+            switch (k) {
             case UNARY:
-                return UNTAG(unary_table*, t)->find(n, r) ? r : 0;
+                return find_in<unary_table>(t, key);
             case BINARY:
-                return UNTAG(binary_table*, t)->find(n, r) ? r : 0;
+                return find_in<binary_table>(t, key);
             case BINARY_COMM:
-                return UNTAG(comm_table*, t)->find(n, r) ? r : 0;
+                return find_in<comm_table>(t, key);
             default:
-                return UNTAG(table*, t)->find(n, r) ? r : 0;
+                return find_in<table>(t, key);
             }
         }
 
         bool contains_ptr(enode * n) const {
-            enode * r;
-            SASSERT(n->get_num_args() > 0);
-            void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
-            case UNARY:
-                return UNTAG(unary_table*, t)->find(n, r) && n == r;
-            case BINARY:
-                return UNTAG(binary_table*, t)->find(n, r) && n == r;
-            case BINARY_COMM:
-                return UNTAG(comm_table*, t)->find(n, r) && n == r;
-            default:
-                return UNTAG(table*, t)->find(n, r) && n == r;
-            }
+            return find(n) == n;
         }
 
         void reset();
@@ -45,6 +45,7 @@ namespace smt {
         m_todo_js_qhead(0), 
         m_antecedents(0),
         m_watches(watches),
+        m_glue_stamp(0),
         m_new_proofs(m),
         m_lemma_proof(m)
     {
@@ -505,8 +506,15 @@ namespace smt {
             switch (js.get_kind()) {
             case b_justification::CLAUSE: {
                 clause * cls = js.get_clause();
-                if (cls->is_lemma())
+                if (cls->is_lemma()) {
                     cls->inc_clause_activity();
+                    if (m_params.m_lemma_gc_tiered && cls->get_glue() > m_params.m_lemma_gc_core_glue) {
+                        // the glue of a lemma may decrease while it is used, and promote it to a better tier.
+                        unsigned glue = compute_glue(cls->get_num_literals(), cls->begin_literals());
+                        if (glue < cls->get_glue())
+                            cls->set_glue(glue);
+                    }
+                }
                 unsigned num_lits = cls->get_num_literals();
                 unsigned i        = 0;
                 if (consequent != false_literal) {
@@ -583,6 +591,28 @@ namespace smt {
         return true;
     }
 
+    /**
+       \brief Return the number of distinct scope levels of the given literals (glue, LBD).
+    */
+    unsigned conflict_resolution::compute_glue(unsigned num_lits, literal const * lits) {
+        m_glue_stamp++;
+        if (m_glue_stamp == 0) {
+            m_glue_lvl_marks.fill(0);
+            m_glue_stamp = 1;
+        }
+        unsigned glue = 0;
+        for (unsigned i = 0; i < num_lits; i++) {
+            unsigned lvl = m_ctx.get_assign_level(lits[i]);
+            if (lvl >= m_glue_lvl_marks.size())
+                m_glue_lvl_marks.resize(lvl + 1, 0);
+            if (m_glue_lvl_marks[lvl] != m_glue_stamp) {
+                m_glue_lvl_marks[lvl] = m_glue_stamp;
+                glue++;
+            }
+        }
+        return glue;
+    }
+
     /**
        \brief Return an approximation for the set of scope levels where the literals in m_lemma
        were assigned. 
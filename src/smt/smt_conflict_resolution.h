@@ -68,6 +68,9 @@ namespace smt {
         // Reference for watch lists are used to implement subsumption resolution
         vector<watch_list> &           m_watches;     //!< per literal
 
+        unsigned_vector                m_glue_lvl_marks; //!< scope level -> stamp, used to compute glues
+        unsigned                       m_glue_stamp;
+
         // ---------------------------
         //
         // Proof generation
@@ -257,6 +260,15 @@ namespace smt {
 
         void justification2literals(justification * js, literal_vector & result);
 
+        /**
+           \brief Return the number of distinct scope levels of the given assigned literals (LBD).
+        */
+        unsigned compute_glue(unsigned num_lits, literal const * lits);
+
+        unsigned get_lemma_glue() {
+            return compute_glue(m_lemma.size(), m_lemma.c_ptr());
+        }
+
     };
 
     inline void mark_literals(conflict_resolution & cr, unsigned sz, literal const * ls) {
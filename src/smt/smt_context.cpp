@@ -683,7 +683,7 @@ namespace smt {
                         if (val == l_false && js.get_kind() == eq_justification::CONGRUENCE)
                             m_dyn_ack_manager.cg_conflict_eh(n1->get_owner(), n2->get_owner());
 
-                        assign(literal(v), mk_justification(eq_propagation_justification(lhs, rhs)));
+                        assign(literal(v), mk_eq_propagation_justification(parent));
                     }
                     // It is not necessary to reinsert the equality to the congruence table
                     continue;
@@ -2662,7 +2662,9 @@ namespace smt {
        \brief Delete low activity lemmas
     */
     inline void context::del_inactive_lemmas() {
-        if (m_fparams.m_lemma_gc_half)
+        if (m_fparams.m_lemma_gc_tiered)
+            del_inactive_lemmas3();
+        else if (m_fparams.m_lemma_gc_half)
             del_inactive_lemmas1();
         else
             del_inactive_lemmas2();
@@ -2778,6 +2780,85 @@ namespace smt {
         IF_VERBOSE(2, verbose_stream() << " :num-deleted-clauses " << num_del_cls << ")" << std::endl;);
     }
 
+    /**
+       \brief Glue based version of del_inactive_lemmas. Lemmas are divided in three tiers:
+       core lemmas (glue <= m_lemma_gc_core_glue) are never deleted, tier2 lemmas
+       (glue <= m_lemma_gc_tier2_glue) are deleted if they were not used in conflict
+       resolution since the last collection, and half of the remaining (local) lemmas,
+       the ones with lower activity, are deleted. The most recent lemmas are kept.
+       The activity of the retained lemmas is reset.
+    */
+    void context::del_inactive_lemmas3() {
+        unsigned sz            = m_lemmas.size();
+        unsigned start_at      = m_base_lvl == 0 ? 0 : m_base_scopes[m_base_lvl - 1].m_lemmas_lim;
+        SASSERT(start_at <= sz);
+        if (start_at + m_fparams.m_recent_lemmas_size >= sz)
+            return;
+        IF_VERBOSE(2, verbose_stream() << "(smt.delete-inactive-lemmas"; verbose_stream().flush(););
+        unsigned end_at        = sz - m_fparams.m_recent_lemmas_size;
+        unsigned i             = start_at;
+        unsigned j             = i;
+        unsigned num_del_cls   = 0;
+        unsigned num_core      = 0;
+        unsigned num_tier2     = 0;
+        ptr_buffer<clause> local;
+        for (; i < end_at; i++) {
+            clause * cls = m_lemmas[i];
+            if (can_delete(cls)) {
+                if (cls->deleted() || 
+                    (cls->get_glue() > m_fparams.m_lemma_gc_core_glue && 
+                     cls->get_glue() <= m_fparams.m_lemma_gc_tier2_glue && 
+                     cls->get_activity() == 0)) {
+                    del_clause(cls);
+                    num_del_cls++;
+                    continue;
+                }
+                if (cls->get_glue() > m_fparams.m_lemma_gc_tier2_glue) {
+                    local.push_back(cls);
+                    continue;
+                }
+            }
+            if (cls->get_glue() <= m_fparams.m_lemma_gc_core_glue)
+                num_core++;
+            else
+                num_tier2++;
+            m_lemmas[j] = cls;
+            j++;
+        }
+        std::stable_sort(local.begin(), local.end(), clause_lt());
+        unsigned num_keep = local.size() / 2;
+        for (unsigned k = 0; k < local.size(); k++) {
+            clause * cls = local[k];
+            if (k >= num_keep) {
+                TRACE("del_inactive_lemmas", tout << "deleting: "; display_clause(tout, cls); tout << ", activity: " << 
+                      cls->get_activity() << ", glue: " << cls->get_glue() << "\n";);
+                del_clause(cls);
+                num_del_cls++;
+            }
+            else {
+                m_lemmas[j] = cls;
+                j++;
+            }
+        }
+        // keep recent clauses
+        for (; i < sz; i++) {
+            clause * cls = m_lemmas[i];
+            if (cls->deleted() && can_delete(cls)) {
+                del_clause(cls);
+                num_del_cls++;
+            }
+            else {
+                m_lemmas[j] = cls;
+                j++;
+            }
+        }
+        m_lemmas.shrink(j);
+        for (i = start_at; i < j; i++) 
+            m_lemmas[i]->set_activity(0);
+        IF_VERBOSE(2, verbose_stream() << " :num-deleted-clauses " << num_del_cls 
+                   << " :core " << num_core << " :tier2 " << num_tier2 << ")" << std::endl;);
+    }
+
     /**
        \brief Return true if "cls" has more than (or equal to) k unassigned literals.
     */
@@ -3229,6 +3310,9 @@ namespace smt {
         m_agility                      = 0.0;
         m_luby_idx                     = 1;
         m_lemma_gc_threshold           = m_fparams.m_lemma_gc_initial;
+        m_glues_sum                    = 0.0;
+        m_num_glues                    = 0;
+        reset_recent_glues();
         m_last_search_failure          = OK;
         m_unsat_proof                  = 0;
         m_unsat_core                   .reset();
@@ -3272,6 +3356,49 @@ namespace smt {
             }
         }
         m_num_conflicts_since_restart = 0;
+        if (m_fparams.m_restart_strategy == RS_GLUCOSE)
+            reset_recent_glues();
+    }
+
+    /**
+       \brief Number of lemmas used to compute the recent average glue in RS_GLUCOSE.
+    */
+    static const unsigned RECENT_GLUES_SIZE = 50;
+
+    void context::reset_recent_glues() {
+        m_recent_glues.reset();
+        m_recent_glues_head = 0;
+        m_recent_glues_sum  = 0;
+    }
+
+    void context::update_glue_averages(unsigned glue) {
+        m_glues_sum += glue;
+        m_num_glues++;
+        if (m_recent_glues.size() < RECENT_GLUES_SIZE) {
+            m_recent_glues.push_back(glue);
+        }
+        else {
+            m_recent_glues_sum -= m_recent_glues[m_recent_glues_head];
+            m_recent_glues[m_recent_glues_head] = glue;
+            m_recent_glues_head = (m_recent_glues_head + 1) % RECENT_GLUES_SIZE;
+        }
+        m_recent_glues_sum += glue;
+    }
+
+    /**
+       \brief Return true if the search should be restarted.
+       For RS_GLUCOSE, restart when the lemmas produced recently have a higher glue than
+       the average: the solver is producing lemmas of poor quality.
+    */
+    bool context::restart_limit_reached() const {
+        if (m_fparams.m_restart_strategy == RS_GLUCOSE) {
+            if (m_num_conflicts_since_restart < RECENT_GLUES_SIZE || m_recent_glues.size() < RECENT_GLUES_SIZE)
+                return false;
+            double recent_avg = static_cast<double>(m_recent_glues_sum) / RECENT_GLUES_SIZE;
+            double global_avg = m_glues_sum / m_num_glues;
+            return recent_avg > m_fparams.m_restart_glue_margin * global_avg;
+        }
+        return m_num_conflicts_since_restart > m_restart_threshold;
     }
 
     struct context::scoped_mk_model {
@@ -3444,7 +3571,7 @@ namespace smt {
                     if (get_cancel_flag())
                         return l_undef;
                     
-                    if (m_num_conflicts_since_restart > m_restart_threshold && m_scope_lvl - m_base_lvl > 2) {
+                    if (restart_limit_reached() && m_scope_lvl - m_base_lvl > 2) {
                         TRACE("search_bug", tout << "bounded-search return undef, inconsistent: " << inconsistent() << "\n";);
                         return l_undef; // restart
                     }
@@ -3665,6 +3792,16 @@ namespace smt {
                 new_lvl = conflict_lvl - 1;
             }
 
+            // the glue must be computed before backtracking, while all literals are assigned.
+            // It is only used by the tiered lemma gc and the glucose restarts.
+            bool use_glue = m_fparams.m_lemma_gc_tiered || m_fparams.m_restart_strategy == RS_GLUCOSE;
+            unsigned glue = 0;
+            if (use_glue) {
+                glue = m_conflict_resolution->get_lemma_glue();
+                if (m_fparams.m_restart_strategy == RS_GLUCOSE)
+                    update_glue_averages(glue);
+            }
+
             // Some of the literals/enodes of the conflict clause will be destroyed during
             // backtracking, and will need to be recreated. However, I want to keep
             // the generation number for enodes that are going to be recreated. See 
@@ -3794,7 +3931,9 @@ namespace smt {
                 }
             }
 #endif
-            mk_clause(num_lits, lits, js, CLS_LEARNED);
+            clause * cls = mk_clause(num_lits, lits, js, CLS_LEARNED);
+            if (cls != 0 && use_glue)
+                cls->set_glue(glue);
             if (delay_forced_restart) {
                 SASSERT(num_lits == 1);
                 expr * unit     = bool_var2expr(lits[0].var());
@@ -113,6 +113,7 @@ namespace smt {
         enode *                     m_false_enode;
         app2enode_t                 m_app2enode;    // app -> enode
         ptr_vector<enode>           m_enodes;
+        ptr_vector<justification>   m_eq_propagation_js; // equality atom id -> justification shared by all its propagations
         plugin_manager<theory>      m_theories;     // mapping from theory_id -> theory
         ptr_vector<theory>          m_theory_set;   // set of theories for fast traversal
         vector<enode_vector>        m_decl2enodes;  // decl -> enode (for decls with arity > 0)
@@ -821,6 +822,27 @@ namespace smt {
             return js;
         }
 
+        /**
+           \brief Return a justification for assigning the equality atom \c eq to true
+           because its arguments are in the same equivalence class.
+           With compact justifications, the object is created on the first propagation
+           of the atom, and then shared by all its propagations until the enode is deleted.
+           It is allocated in the heap, since the scope of the first propagation may be
+           backtracked before the enode is deleted.
+        */
+        justification * mk_eq_propagation_justification(enode * eq) {
+            SASSERT(eq->is_eq());
+            if (!m_fparams.m_compact_justifications || m_manager.proofs_enabled())
+                return mk_justification(eq_propagation_justification(eq->get_arg(0), eq->get_arg(1)));
+            unsigned id = eq->get_owner_id();
+            justification * js = m_eq_propagation_js.get(id, 0);
+            if (js == 0) {
+                js = alloc(eq_propagation_justification, eq->get_arg(0), eq->get_arg(1), false);
+                m_eq_propagation_js.setx(id, js, 0);
+            }
+            return js;
+        }
+
         // -----------------------------------
         //
         // Engine
@@ -840,6 +862,18 @@ namespace smt {
         unsigned           m_luby_idx; 
         double             m_agility;
         unsigned           m_lemma_gc_threshold;
+        // glue (LBD) of recent lemmas, used by RS_GLUCOSE
+        unsigned_vector    m_recent_glues;        //!< ring buffer with the glue of the last lemmas
+        unsigned           m_recent_glues_head;
+        unsigned           m_recent_glues_sum;
+        double             m_glues_sum;           //!< sum of the glue of all lemmas created in the current search
+        unsigned           m_num_glues;
+
+        void reset_recent_glues();
+
+        void update_glue_averages(unsigned glue);
+
+        bool restart_limit_reached() const;
         
         void assign_core(literal l, b_justification j, bool decision = false);
         void trace_assign(literal l, b_justification j, bool decision) const;
@@ -1032,6 +1066,8 @@ namespace smt {
 
         void del_inactive_lemmas2();
 
+        void del_inactive_lemmas3();
+
         bool more_than_k_unassigned_literals(clause * cls, unsigned k);
 
         void internalize_assertions();
@@ -924,7 +924,7 @@ namespace smt {
         if (e->get_num_args() > 0) {
             if (e->is_true_eq()) {
                 bool_var v = enode2bool_var(e);
-                assign(literal(v), mk_justification(eq_propagation_justification(e->get_arg(0), e->get_arg(1))));
+                assign(literal(v), mk_eq_propagation_justification(e));
                 e->m_cg    = e;
             }
             else {
@@ -975,6 +975,10 @@ namespace smt {
         SASSERT(is_app(n));
         enode * e             = m_app2enode[n_id];
         m_app2enode[n_id]     = 0;
+        if (e->is_eq() && n_id < m_eq_propagation_js.size() && m_eq_propagation_js[n_id] != 0) {
+            dealloc(m_eq_propagation_js[n_id]);
+            m_eq_propagation_js[n_id] = 0;
+        }
         if (e->is_cgr() && !e->is_true_eq() && e->is_cgc_enabled()) {
             SASSERT(m_cg_table.contains_ptr(e));
             m_cg_table.erase(e);
@@ -180,7 +180,8 @@ namespace smt {
         enode *         m_node1;
         enode *         m_node2;
     public:
-        eq_propagation_justification(enode * n1, enode * n2):m_node1(n1), m_node2(n2) {
+        eq_propagation_justification(enode * n1, enode * n2, bool in_region = true):
+            justification(in_region), m_node1(n1), m_node2(n2) {
         }
 
         virtual void get_antecedents(conflict_resolution & cr);
@@ -372,6 +372,7 @@ namespace smt {
 
     void quantifier_manager::collect_statistics(::statistics & st) const {
         m_imp->m_qi_queue.collect_statistics(st);
+        m_imp->m_plugin->collect_statistics(st);
     }
 
     void quantifier_manager::reset_statistics() {
@@ -472,6 +473,11 @@ namespace smt {
                 m_model_finder->pop_scope(num_scopes);
             }
         }
+
+        virtual void collect_statistics(::statistics & st) const {
+            m_mam->collect_statistics(st);
+            m_lazy_mam->collect_statistics(st);
+        }
         
         virtual void init_search_eh() {
             m_lazy_matching_idx = 0;
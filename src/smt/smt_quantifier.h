@@ -164,6 +164,8 @@ namespace smt {
         
         virtual void push() = 0;
         virtual void pop(unsigned num_scopes) = 0;
+
+        virtual void collect_statistics(::statistics & st) const {}
         
     };
 };
@@ -45,6 +45,7 @@ namespace smt {
         unsigned m_conflicts, m_add_rows, m_pivots, m_diseq_cs, m_gomory_cuts, m_branches, m_gcd_tests;
         unsigned m_assert_lower, m_assert_upper, m_assert_diseq, m_core2th_eqs, m_core2th_diseqs;
         unsigned m_th2core_eqs, m_th2core_diseqs, m_bound_props, m_offset_eqs, m_fixed_eqs, m_offline_eqs;
+        unsigned m_bound_prop_rows, m_bound_prop_skipped;
         unsigned m_max_min; 
         unsigned m_gb_simplify, m_gb_superpose, m_gb_compute_basis, m_gb_num_processed;
         unsigned m_nl_branching, m_nl_linear, m_nl_bounds, m_nl_cross_nested;
@@ -149,7 +150,13 @@ namespace smt {
             unsigned          m_size;      // the real size, m_entries contains dead row_entries.
             int               m_base_var;
             int               m_first_free_idx; // first available position.
+            // Number of monomials that do not have the bound needed to imply a lower (upper) bound
+            // for the other monomials. See is_row_useful_for_bound_prop.
+            // UINT_MAX if unknown. The counters are reset when the row is modified.
+            unsigned          m_num_missing[2];
             row();
+            bool has_missing_info() const { return m_num_missing[0] != UINT_MAX; }
+            void reset_missing_info() { m_num_missing[0] = m_num_missing[1] = UINT_MAX; }
             unsigned size() const { return m_size; }
             unsigned num_entries() const { return m_entries.size(); }
             void reset();
@@ -576,7 +583,12 @@ namespace smt {
             return is_free(get_context().get_enode(n)->get_th_var(get_id())); 
         }
         bool is_fixed(theory_var v) const;
-        void set_bound_core(theory_var v, bound * new_bound, bool upper) { m_bounds[static_cast<unsigned>(upper)][v] = new_bound; }
+        void set_bound_core(theory_var v, bound * new_bound, bool upper) { 
+            bound * & b = m_bounds[static_cast<unsigned>(upper)][v];
+            if ((b == 0) != (new_bound == 0))
+                update_missing_info(v, upper, new_bound == 0);
+            b = new_bound; 
+        }
         void restore_bound(theory_var v, bound * new_bound, bool upper) { set_bound_core(v, new_bound, upper); }
         void restore_nl_propagated_flag(unsigned old_trail_size);
         void set_bound(bound * new_bound, bool upper);
@@ -782,6 +794,9 @@ namespace smt {
         // -----------------------------------
         void mark_row_for_bound_prop(unsigned r1);
         void mark_rows_for_bound_prop(theory_var v);
+        void compute_missing_info(row const & r, unsigned * num_missing) const;
+        void update_missing_info(theory_var v, bool upper, bool missing);
+        bool get_bound_prop_idxs(row & r, int & lower_idx, int & upper_idx);
         void is_row_useful_for_bound_prop(row const & r, int & lower_idx, int & upper_idx) const;
         void imply_bound_for_monomial(row const & r, int idx, bool lower);
         void imply_bound_for_all_monomials(row const & r, bool lower);
@@ -1145,6 +1160,7 @@ namespace smt {
         bool valid_assignment() const;
         bool valid_row_assignment() const;
         bool valid_row_assignment(row const & r) const;
+        bool valid_missing_info(row const & r) const;
         bool satisfy_bounds() const;
         bool satisfy_integrality() const;
 #endif
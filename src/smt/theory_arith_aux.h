@@ -38,6 +38,7 @@ namespace smt {
         m_size(0),
         m_base_var(null_theory_var),
         m_first_free_idx(-1) {
+        reset_missing_info();
     }
     
     template<typename Ext>
@@ -46,6 +47,7 @@ namespace smt {
         m_size           = 0;
         m_base_var       = -1;
         m_first_free_idx = -1;
+        reset_missing_info();
     }
     
     /**
@@ -55,6 +57,7 @@ namespace smt {
     template<typename Ext>
     typename theory_arith<Ext>::row_entry & theory_arith<Ext>::row::add_row_entry(int & pos_idx) {
         m_size++;
+        reset_missing_info();
         if (m_first_free_idx == -1) {
             pos_idx = m_entries.size();
             m_entries.push_back(row_entry());
@@ -79,6 +82,7 @@ namespace smt {
         t.m_next_free_row_entry_idx = m_first_free_idx;
         t.m_var = null_theory_var;
         m_size--;
+        reset_missing_info();
         SASSERT(t.is_dead());
     }
 
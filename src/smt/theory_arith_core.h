@@ -215,6 +215,7 @@ namespace smt {
     void theory_arith<Ext>::add_row_entry(unsigned r_id, numeral const & coeff, theory_var v) {
         row    & r          = m_rows[r_id];
         column & c          = m_columns[v];
+        r.reset_missing_info();
         if (row_vars().contains(v)) {
             typename vector<row_entry>::iterator it = r.begin_entries();
             typename vector<row_entry>::iterator end = r.end_entries();
@@ -1674,6 +1675,7 @@ namespace smt {
             mark_row_for_bound_prop(rid1);
         row & r1 = m_rows[rid1];
         row & r2 = m_rows[rid2];
+        r1.reset_missing_info();
         CASSERT("row_assignment_bug", valid_row_assignment(r1));
         CASSERT("row_assignment_bug", valid_row_assignment(r2));
         r1.compress_if_needed(m_columns);
@@ -1875,6 +1877,7 @@ namespace smt {
         row & r  = m_rows[r_id];
         
         SASSERT(r.is_coeff_of(x_j, a_ij));
+        r.reset_missing_info();
 
 #define DIVIDE_ROW(_ADJUST_COEFF_)                                      \
     typename vector<row_entry>::iterator it  = r.begin_entries();       \
@@ -2506,6 +2509,84 @@ namespace smt {
         }
     }
 
+    /**
+       \brief Compute the number of monomials in r that prevent r from implying lower and upper bounds.
+       
+       num_missing[0] is the number of monomials a_i * x_i such that (a_i > 0 and upper(x_i) == 0) 
+       or (a_i < 0 and lower(x_i) == 0). num_missing[1] is the dual for upper bounds.
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::compute_missing_info(row const & r, unsigned * num_missing) const {
+        num_missing[0] = 0;
+        num_missing[1] = 0;
+        typename vector<row_entry>::const_iterator it  = r.begin_entries();
+        typename vector<row_entry>::const_iterator end = r.end_entries();
+        for (; it != end; ++it) {
+            if (!it->is_dead()) {
+                bool is_pos = it->m_coeff.is_pos();
+                if (lower(it->m_var) == 0) 
+                    num_missing[is_pos]++;
+                if (upper(it->m_var) == 0) 
+                    num_missing[!is_pos]++;
+            }
+        }
+    }
+
+    /**
+       \brief Update the counters of the rows containing v, when 
+       the lower (upper) bound of v is removed (missing == true) or set (missing == false).
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::update_missing_info(theory_var v, bool upper, bool missing) {
+        column const & c = m_columns[v];
+        typename svector<col_entry>::const_iterator it  = c.begin_entries();
+        typename svector<col_entry>::const_iterator end = c.end_entries();
+        for (; it != end; ++it) {
+            if (!it->is_dead()) {
+                row & r = m_rows[it->m_row_id];
+                if (r.has_missing_info()) {
+                    bool is_pos = r[it->m_row_idx].m_coeff.is_pos();
+                    unsigned & num_missing = r.m_num_missing[upper ? !is_pos : is_pos];
+                    if (missing) {
+                        num_missing++;
+                    }
+                    else {
+                        SASSERT(num_missing > 0);
+                        num_missing--;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+       \brief Store in lower_idx and upper_idx the monomials of r for which bounds can be implied.
+       See is_row_useful_for_bound_prop.
+       The row is not traversed when the counters of missing bounds show it is not needed.
+       Return false if no bound can be implied.
+    */
+    template<typename Ext>
+    bool theory_arith<Ext>::get_bound_prop_idxs(row & r, int & lower_idx, int & upper_idx) {
+        if (!r.has_missing_info())
+            compute_missing_info(r, r.m_num_missing);
+        SASSERT(valid_missing_info(r));
+        unsigned num_missing_lower = r.m_num_missing[0];
+        unsigned num_missing_upper = r.m_num_missing[1];
+        if (num_missing_lower > 1 && num_missing_upper > 1) {
+            m_stats.m_bound_prop_skipped++;
+            return false;
+        }
+        m_stats.m_bound_prop_rows++;
+        if (skip_big_coeffs() || num_missing_lower == 1 || num_missing_upper == 1) {
+            is_row_useful_for_bound_prop(r, lower_idx, upper_idx);
+        }
+        else {
+            lower_idx = num_missing_lower == 0 ? -1 : -2;
+            upper_idx = num_missing_upper == 0 ? -1 : -2;
+        }
+        return true;
+    }
+
     /**
        \brief Given a row:
        a_1 * x_1 + ... + a_n * x_n = 0
@@ -2952,20 +3033,20 @@ namespace smt {
                 if (r.size() < max_lemma_size()) { // Ignore big rows.
                     int lower_idx;
                     int upper_idx;
-                    is_row_useful_for_bound_prop(r, lower_idx, upper_idx);
-                    
-                    if (lower_idx >= 0) {
-                        imply_bound_for_monomial(r, lower_idx, true);
-                    }
-                    else if (lower_idx == -1) {
-                        imply_bound_for_all_monomials(r, true);
-                    }
-                    
-                    if (upper_idx >= 0) {
-                        imply_bound_for_monomial(r, upper_idx, false);
-                    }
-                    else if (upper_idx == -1) {
-                        imply_bound_for_all_monomials(r, false);
+                    if (get_bound_prop_idxs(r, lower_idx, upper_idx)) {
+                        if (lower_idx >= 0) {
+                            imply_bound_for_monomial(r, lower_idx, true);
+                        }
+                        else if (lower_idx == -1) {
+                            imply_bound_for_all_monomials(r, true);
+                        }
+                        
+                        if (upper_idx >= 0) {
+                            imply_bound_for_monomial(r, upper_idx, false);
+                        }
+                        else if (upper_idx == -1) {
+                            imply_bound_for_all_monomials(r, false);
+                        }
                     }
                     
                     // sneaking cheap eq detection in this loop 
@@ -189,6 +189,17 @@ namespace smt {
         return true;
     }
 
+    template<typename Ext>
+    bool theory_arith<Ext>::valid_missing_info(row const & r) const {
+        if (r.has_missing_info()) {
+            unsigned num_missing[2];
+            compute_missing_info(r, num_missing);
+            SASSERT(num_missing[0] == r.m_num_missing[0]);
+            SASSERT(num_missing[1] == r.m_num_missing[1]);
+        }
+        return true;
+    }
+
     template<typename Ext>
     bool theory_arith<Ext>::satisfy_bounds() const {
         int num = get_num_vars();
@@ -456,6 +456,7 @@ namespace smt {
     }
 
     void theory_bv::fixed_var_eh(theory_var v) {
+        propagate_lazy_parents(v);
         numeral val;
         bool r      = get_fixed_value(v, val);
         SASSERT(r);
@@ -843,6 +844,10 @@ namespace smt {
         if (approximate_term(term)) {
             return false;
         }
+        if (is_lazy_term(term)) {
+            internalize_lazy(term);
+            return true;
+        }
         switch (term->get_decl_kind()) {
         case OP_BV_NUM:         internalize_num(term); return true;
         case OP_BADD:           internalize_add(term); return true;
@@ -1077,6 +1082,331 @@ namespace smt {
 
     }
 
+    //
+    // Multipliers, dividers and shifts are not bit-blasted when bv.lazy_blast is set.
+    // Their bits are fresh atoms, and the circuit is only created in final_check_eh 
+    // if the term is relevant and the assignment of its bits is not the 
+    // result of the operator applied to the assignment of the bits of its arguments.
+    // A term whose simplification caused a conflict is bit-blasted at the next 
+    // restart: such a propagation only rules out one assignment of the arguments.
+    //
+    bool theory_bv::is_lazy_term(app * n) const {
+        if (!m_params.m_bv_lazy_blast) 
+            return false;
+        switch (n->get_decl_kind()) {
+        case OP_BMUL:
+        case OP_BSDIV_I:
+        case OP_BUDIV_I:
+        case OP_BSREM_I:
+        case OP_BUREM_I:
+        case OP_BSMOD_I:
+            return true;
+        case OP_BSHL:
+        case OP_BLSHR:
+        case OP_BASHR:
+            // shifting by a constant does not create any gate.
+            return !m_util.is_numeral(n->get_arg(1));
+        default:
+            return false;
+        }
+    }
+
+    void theory_bv::internalize_lazy(app * n) {
+        SASSERT(!get_context().e_internalized(n));
+        process_args(n);
+        enode * e    = mk_enode(n);
+        theory_var v = e->get_th_var(get_id());
+        for (unsigned i = 0; i < n->get_num_args(); ++i) 
+            get_arg_var(e, i);
+        mk_bits(v);
+        m_lazy_terms.push_back(v);
+        m_lazy_blasted.push_back(false);
+        m_lazy_conflict.push_back(false);
+        m_trail_stack.push(push_back_vector<theory_bv, svector<theory_var> >(m_lazy_terms));
+        m_trail_stack.push(push_back_vector<theory_bv, svector<bool> >(m_lazy_blasted));
+        m_trail_stack.push(push_back_vector<theory_bv, svector<bool> >(m_lazy_conflict));
+        // constant arguments were fixed by internalize_num before n had an enode.
+        if (m_params.m_bv_reflect) {
+            propagate_lazy_term(v);
+            if (get_context().inconsistent())
+                mark_lazy_conflict(v);
+        }
+    }
+
+    /**
+       \brief Store in bits the bit-blasted circuit of the lazy term e. 
+       If use_values is true, the bits of the arguments are replaced with their current assignment,
+       and false is returned if one of them is unassigned.
+    */
+    bool theory_bv::mk_lazy_bits(enode * e, bool use_values, expr_ref_vector & bits) {
+        context & ctx     = get_context();
+        ast_manager & m   = get_manager();
+        app * n           = e->get_owner();
+        unsigned num_args = n->get_num_args();
+        expr_ref_vector arg_bits(m), new_bits(m);
+        bits.reset();
+        unsigned i = num_args;
+        while (i > 0) {
+            --i;
+            arg_bits.reset();
+            if (use_values) {
+                literal_vector const & lits = m_bits[get_arg_var(e, i)];
+                for (unsigned j = 0; j < lits.size(); ++j) {
+                    lbool val = ctx.get_assignment(lits[j]);
+                    if (val == l_undef)
+                        return false;
+                    arg_bits.push_back(val == l_true ? m.mk_true() : m.mk_false());
+                }
+            }
+            else {
+                get_arg_bits(e, i, arg_bits);
+            }
+            if (i + 1 == num_args) {
+                bits.swap(arg_bits);
+                continue;
+            }
+            SASSERT(arg_bits.size() == bits.size());
+            unsigned sz = bits.size();
+            new_bits.reset();
+            switch (n->get_decl_kind()) {
+            case OP_BMUL:    m_bb.mk_multiplier(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BSDIV_I: m_bb.mk_sdiv(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BUDIV_I: m_bb.mk_udiv(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BSREM_I: m_bb.mk_srem(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BUREM_I: m_bb.mk_urem(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BSMOD_I: m_bb.mk_smod(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BSHL:    m_bb.mk_shl(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BLSHR:   m_bb.mk_lshr(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            case OP_BASHR:   m_bb.mk_ashr(sz, arg_bits.c_ptr(), bits.c_ptr(), new_bits); break;
+            default: UNREACHABLE();
+            }
+            bits.swap(new_bits);
+        }
+        return true;
+    }
+
+    /**
+       \brief Return true if the assignment of the bits of the lazy term v 
+       is the value of the term under the assignment of the bits of its arguments.
+    */
+    bool theory_bv::is_lazy_term_consistent(theory_var v) {
+        context & ctx   = get_context();
+        ast_manager & m = get_manager();
+        expr_ref_vector bits(m);
+        if (!mk_lazy_bits(get_enode(v), true, bits))
+            return false;
+        literal_vector const & lits = m_bits[v];
+        SASSERT(lits.size() == bits.size());
+        for (unsigned i = 0; i < lits.size(); ++i) {
+            lbool val = ctx.get_assignment(lits[i]);
+            if (m.is_true(bits.get(i)) ? val != l_true : (!m.is_false(bits.get(i)) || val != l_false))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+       \brief Create the circuit for the lazy term v, and assert that
+       its bits are equivalent to the outputs of the circuit.
+    */
+    void theory_bv::blast_lazy_term(theory_var v) {
+        context & ctx   = get_context();
+        ast_manager & m = get_manager();
+        TRACE("bv", tout << "blasting: " << mk_bounded_pp(get_enode(v)->get_owner(), m) << "\n";);
+        m_stats.m_num_lazy_blast++;
+        expr_ref_vector bits(m);
+        mk_lazy_bits(get_enode(v), false, bits);
+        literal_vector const & lits = m_bits[v];
+        SASSERT(lits.size() == bits.size());
+        for (unsigned i = 0; i < bits.size(); ++i) {
+            expr_ref s_bit(m);
+            simplify_bit(bits.get(i), s_bit);
+            ctx.internalize(s_bit, true);
+            literal l = ctx.get_literal(s_bit.get());
+            ctx.mark_as_relevant(l);
+            ctx.mk_th_axiom(get_id(), ~lits[i], l);
+            ctx.mk_th_axiom(get_id(), lits[i], ~l);
+        }
+    }
+
+    /**
+       \brief Bit-blast the relevant lazy terms that are inconsistent with the current assignment.
+       Return true if at least one term was bit-blasted.
+    */
+    bool theory_bv::blast_lazy_terms() {
+        context & ctx = get_context();
+        bool result   = false;
+        for (unsigned i = 0; i < m_lazy_terms.size(); ++i) {
+            theory_var v = m_lazy_terms[i];
+            if (m_lazy_blasted[i] || !ctx.is_relevant(get_enode(v)) || is_lazy_term_consistent(v))
+                continue;
+            m_trail_stack.push(vector_value_trail<theory_bv, bool, false>(m_lazy_blasted, i));
+            m_lazy_blasted[i] = true;
+            blast_lazy_term(v);
+            result = true;
+        }
+        return result;
+    }
+
+    /**
+       \brief Record that the simplification of the lazy term v caused a conflict.
+       The flag is not restored on backtracking.
+    */
+    void theory_bv::mark_lazy_conflict(theory_var v) {
+        for (unsigned i = 0; i < m_lazy_terms.size(); ++i) {
+            if (m_lazy_terms[i] == v) {
+                m_lazy_conflict[i] = true;
+                return;
+            }
+        }
+    }
+
+    /**
+       \brief Bit-blast the lazy terms that caused a conflict. The context is at the search
+       level, so the circuits are kept by the following restarts.
+    */
+    void theory_bv::restart_eh() {
+        for (unsigned i = 0; i < m_lazy_terms.size(); ++i) {
+            if (!m_lazy_conflict[i] || m_lazy_blasted[i])
+                continue;
+            m_trail_stack.push(vector_value_trail<theory_bv, bool, false>(m_lazy_blasted, i));
+            m_lazy_blasted[i] = true;
+            blast_lazy_term(m_lazy_terms[i]);
+        }
+    }
+
+    //
+    // Simplifications of lazy terms.
+    // When a lazy term is internalized, and whenever one of its arguments becomes fixed, 
+    // the bits of the term that are determined by the values of the fixed arguments are 
+    // propagated without bit-blasting. These rules only apply to the lazy terms, and
+    // only to arguments that are fixed: no interval or known-bits information is 
+    // maintained for the bit-vector variables.
+    // - all arguments are fixed: the value of the term is propagated.
+    // - (bvmul ... 0 ...) is 0.
+    // - (bvshl x k) and (bvlshr x k) are 0 if k >= sz.
+    // - (bvurem x k) <= k - 1 if k > 0.
+    // - (bvudiv x k) <= (2^sz - 1) div k if k > 0.
+    // The last two bounds are only propagated as the high bits of the term that must be 0,
+    // e.g., (bvurem x 7) <= 6 only yields (bvurem x 7) <= 7.
+    //
+    void theory_bv::propagate_lazy_parents(theory_var v) {
+        // the arguments of a term are not enodes when bv.reflect is false
+        if (m_lazy_terms.empty() || !m_params.m_bv_reflect)
+            return;
+        context & ctx = get_context();
+        enode * r     = get_enode(v)->get_root();
+        enode_vector::const_iterator it  = r->begin_parents();
+        enode_vector::const_iterator end = r->end_parents();
+        for (; it != end && !ctx.inconsistent(); ++it) {
+            enode * p    = *it;
+            theory_var w = p->get_th_var(get_id());
+            if (w != null_theory_var && p->get_owner()->get_family_id() == get_id() && is_lazy_term(p->get_owner())) {
+                propagate_lazy_term(w);
+                if (ctx.inconsistent())
+                    mark_lazy_conflict(w);
+            }
+        }
+    }
+
+    void theory_bv::propagate_lazy_term(theory_var v) {
+        ast_manager & m   = get_manager();
+        enode * e         = get_enode(v);
+        app * n           = e->get_owner();
+        unsigned sz       = get_bv_size(v);
+        unsigned num_args = n->get_num_args();
+        unsigned num_fixed = 0;
+        numeral val;
+        for (unsigned i = 0; i < num_args; ++i) {
+            if (get_fixed_value(get_arg_var(e, i), val))
+                num_fixed++;
+        }
+        if (num_fixed == 0)
+            return;
+        literal_vector ante;
+        if (num_fixed == num_args) {
+            expr_ref_vector bits(m);
+            VERIFY(mk_lazy_bits(e, true, bits));
+            for (unsigned i = 0; i < num_args; ++i)
+                get_fixed_bits(get_arg_var(e, i), ante);
+            literal_vector const & lits = m_bits[v];
+            for (unsigned i = 0; i < sz && !get_context().inconsistent(); ++i) {
+                if (m.is_true(bits.get(i)))
+                    propagate_lazy_bit(lits[i], ante);
+                else if (m.is_false(bits.get(i)))
+                    propagate_lazy_bit(~lits[i], ante);
+            }
+            return;
+        }
+        switch (n->get_decl_kind()) {
+        case OP_BMUL:
+            for (unsigned i = 0; i < num_args; ++i) {
+                theory_var arg = get_arg_var(e, i);
+                if (get_fixed_value(arg, val) && val.is_zero()) {
+                    get_fixed_bits(arg, ante);
+                    propagate_zero_bits(v, 0, ante);
+                    return;
+                }
+            }
+            break;
+        case OP_BSHL:
+        case OP_BLSHR:
+            if (get_fixed_value(get_arg_var(e, 1), val) && val >= numeral(sz)) {
+                get_fixed_bits(get_arg_var(e, 1), ante);
+                propagate_zero_bits(v, 0, ante);
+            }
+            break;
+        case OP_BUREM_I:
+            if (get_fixed_value(get_arg_var(e, 1), val) && val.is_pos()) {
+                get_fixed_bits(get_arg_var(e, 1), ante);
+                val -= numeral(1);
+                propagate_zero_bits(v, val.is_zero() ? 0 : val.get_num_bits(), ante);
+            }
+            break;
+        case OP_BUDIV_I:
+            if (get_fixed_value(get_arg_var(e, 1), val) && val.is_pos()) {
+                get_fixed_bits(get_arg_var(e, 1), ante);
+                val = div(m_bb.power(sz) - numeral(1), val);
+                propagate_zero_bits(v, val.is_zero() ? 0 : val.get_num_bits(), ante);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+       \brief Append to lits the assigned bits of the fixed variable v.
+    */
+    void theory_bv::get_fixed_bits(theory_var v, literal_vector & lits) const {
+        context & ctx = get_context();
+        literal_vector const & bits = m_bits[v];
+        for (unsigned i = 0; i < bits.size(); ++i) {
+            literal l = bits[i];
+            if (l == true_literal || l == false_literal)
+                continue;
+            SASSERT(ctx.get_assignment(l) != l_undef);
+            lits.push_back(ctx.get_assignment(l) == l_true ? l : ~l);
+        }
+    }
+
+    void theory_bv::propagate_zero_bits(theory_var v, unsigned lo, literal_vector const & ante) {
+        literal_vector const & lits = m_bits[v];
+        for (unsigned i = lo; i < lits.size() && !get_context().inconsistent(); ++i)
+            propagate_lazy_bit(~lits[i], ante);
+    }
+
+    void theory_bv::propagate_lazy_bit(literal consequent, literal_vector const & ante) {
+        context & ctx = get_context();
+        if (ctx.get_assignment(consequent) == l_true)
+            return;
+        TRACE("bv", tout << "lazy propagation: " << consequent << "\n";);
+        m_stats.m_num_lazy_prop++;
+        region & r = ctx.get_region();
+        ctx.assign(consequent, ctx.mk_justification(ext_theory_propagation_justification(get_id(), r, ante.size(), ante.c_ptr(), 
+                                                                                          0, 0, consequent)));
+    }
+
     void theory_bv::apply_sort_cnstr(enode * n, sort * s) {
         if (!is_attached_to_var(n) && !approximate_term(n->get_owner())) {
             theory_var v = mk_var(n);
@@ -1316,6 +1646,9 @@ namespace smt {
 
     final_check_status theory_bv::final_check_eh() {
         SASSERT(check_invariant());
+        if (!m_lazy_terms.empty() && blast_lazy_terms()) {
+            return FC_CONTINUE;
+        }
         if (m_approximates_large_bvs) {
             return FC_GIVEUP;
         }
@@ -1648,6 +1981,8 @@ namespace smt {
         st.update("bv bit2core", m_stats.m_num_bit2core);
         st.update("bv->core eq", m_stats.m_num_th2core_eq);
         st.update("bv dynamic eqs", m_stats.m_num_eq_dynamic);
+        st.update("bv lazy blast", m_stats.m_num_lazy_blast);
+        st.update("bv lazy propagations", m_stats.m_num_lazy_prop);
     }
 
 #ifdef Z3DEBUG
@@ -34,7 +34,7 @@ namespace smt {
     
     struct theory_bv_stats {
         unsigned   m_num_diseq_static, m_num_diseq_dynamic, m_num_bit2core, m_num_th2core_eq, m_num_conflicts;
-        unsigned   m_num_eq_dynamic;
+        unsigned   m_num_eq_dynamic, m_num_lazy_blast, m_num_lazy_prop;
         void reset() { memset(this, 0, sizeof(theory_bv_stats)); }
         theory_bv_stats() { reset(); }
     };
@@ -131,6 +131,9 @@ namespace smt {
         literal_vector           m_tmp_literals;
         svector<var_pos>         m_prop_queue;
         bool                     m_approximates_large_bvs;
+        svector<theory_var>      m_lazy_terms;   // terms whose bit-blasting was delayed, see bv.lazy_blast
+        svector<bool>            m_lazy_blasted; // m_lazy_blasted[i] is true if m_lazy_terms[i] was already bit-blasted
+        svector<bool>            m_lazy_conflict; // m_lazy_conflict[i] is true if the simplification of m_lazy_terms[i] caused a conflict
 
         theory_var find(theory_var v) const { return m_find.find(v); }
         theory_var next(theory_var v) const { return m_find.next(v); }
@@ -208,6 +211,19 @@ namespace smt {
 
         bool approximate_term(app* n);
 
+        bool is_lazy_term(app * n) const;
+        void internalize_lazy(app * n);
+        bool mk_lazy_bits(enode * e, bool use_values, expr_ref_vector & bits);
+        bool is_lazy_term_consistent(theory_var v);
+        void blast_lazy_term(theory_var v);
+        bool blast_lazy_terms();
+        void mark_lazy_conflict(theory_var v);
+        void propagate_lazy_parents(theory_var v);
+        void propagate_lazy_term(theory_var v);
+        void get_fixed_bits(theory_var v, literal_vector & lits) const;
+        void propagate_zero_bits(theory_var v, unsigned lo, literal_vector const & ante);
+        void propagate_lazy_bit(literal consequent, literal_vector const & ante);
+
         template<bool Signed>
         void internalize_le(app * atom);
         bool internalize_xor3(app * n, bool gate_ctx);
@@ -238,6 +254,7 @@ namespace smt {
         virtual void push_scope_eh();
         virtual void pop_scope_eh(unsigned num_scopes);
         virtual final_check_status final_check_eh();
+        virtual void restart_eh();
         virtual void reset_eh();
         virtual bool include_func_interp(func_decl* f);
         svector<theory_var>   m_merge_aux[2]; //!< auxiliary vector used in merge_zero_one_bits
@@ -19,6 +19,7 @@ Revision History:
 #include"goal.h"
 #include"ast_ll_pp.h"
 #include"ast_smt2_pp.h"
+#include"ast_binary.h"
 #include"for_each_expr.h"
 #include"well_sorted.h"
 
@@ -422,6 +423,25 @@ void goal::display_ll(std::ostream & out) const {
     }
 }
 
+void goal::display_binary(std::ostream & out) const {
+    ptr_buffer<ast> fmls;
+    unsigned sz = size();
+    for (unsigned i = 0; i < sz; i++)
+        fmls.push_back(form(i));
+    ast_to_binary(m(), fmls.size(), fmls.c_ptr(), out);
+}
+
+void goal::assert_binary(char const * begin, char const * end) {
+    ast_ref_vector fmls(m());
+    ast_from_binary(m(), begin, end, fmls);
+    for (unsigned i = 0; i < fmls.size(); i++) {
+        ast * f = fmls.get(i);
+        if (!is_expr(f) || !m().is_bool(to_expr(f)))
+            throw default_exception("binary input contains a term that is not a formula");
+        assert_expr(to_expr(f));
+    }
+}
+
 /**
    \brief Assumes that the formula is already in CNF.
 */
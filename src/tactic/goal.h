@@ -108,6 +108,8 @@ public:
     void assert_expr(expr * f, expr_dependency * d);
     void assert_expr(expr * f, expr * d) { assert_expr(f, m().mk_leaf(d)); }
     void assert_expr(expr * f) { assert_expr(f, static_cast<expr_dependency*>(0)); }
+    // Assert the formulas stored in [begin, end) by display_binary.
+    void assert_binary(char const * begin, char const * end);
     
     unsigned size() const { return m().size(m_forms); }
 
@@ -130,6 +132,9 @@ public:
     void display_ll(std::ostream & out) const;
     void display_as_and(std::ostream & out) const;
     void display_dimacs(std::ostream & out) const;
+    // Write the formulas in the binary format of ast_binary.h.
+    // Proofs and dependencies are not saved.
+    void display_binary(std::ostream & out) const;
     void display_with_dependencies(ast_printer & prn, std::ostream & out) const;
     void display_with_dependencies(ast_printer_context & ctx) const;
     void display_with_dependencies(std::ostream & out) const;
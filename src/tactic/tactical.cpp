@@ -143,76 +143,99 @@ public:
             if (cores_enabled) core = m.mk_join(core1.get(), core); 
         }
         else {
-            if (cores_enabled) core = core1;
-            proof_converter_ref_buffer pc_buffer;                                                           
-            model_converter_ref_buffer mc_buffer;                                                           
-            sbuffer<unsigned>          sz_buffer;                                                           
-            goal_ref_buffer            r2;                                                                  
-            for (unsigned i = 0; i < r1_size; i++) {                                                        
-                goal_ref g = r1[i];                                                                         
-                r2.reset();                                                                                 
-                model_converter_ref mc2;                                                                   
-                proof_converter_ref pc2;                                                                   
-                expr_dependency_ref  core2(m);                                                              
-                m_t2->operator()(g, r2, mc2, pc2, core2);                                              
-                if (is_decided(r2)) {
-                    SASSERT(r2.size() == 1);
-                    if (is_decided_sat(r2)) {                                                          
-                        // found solution...                                                                
-                        result.push_back(r2[0]);
-                        if (models_enabled) {
-                            // mc2 contains the actual model                                                    
-                            model_ref md;     
-                            md = alloc(model, m);
-                            apply(mc2, md, 0);
-                            apply(mc1, md, i);
-                            mc   = model2model_converter(md.get());                                             
-                        }
-                        SASSERT(!pc); SASSERT(!core);
-                        return;                                                                             
-                    }                                                                                   
-                    else {                                                                                  
-                        SASSERT(is_decided_unsat(r2));                                                 
-                        // the proof and unsat core of a decided_unsat goal are stored in the node itself.
-                        // pc2 and core2 must be 0.
-                        SASSERT(!pc2);
-                        SASSERT(!core2);
-                        if (models_enabled) mc_buffer.push_back(0);
-                        if (proofs_enabled) pc_buffer.push_back(proof2proof_converter(m, r2[0]->pr(0)));
-                        if (models_enabled || proofs_enabled) sz_buffer.push_back(0);
-                        if (cores_enabled) core = m.mk_join(core.get(), r2[0]->dep(0));
-                    }                                                                         
-                }                                                                                       
-                else {                                                                                      
-                    result.append(r2.size(), r2.c_ptr());
-                    if (models_enabled) mc_buffer.push_back(mc2.get());
-                    if (proofs_enabled) pc_buffer.push_back(pc2.get());
-                    if (models_enabled || proofs_enabled) sz_buffer.push_back(r2.size()); 
-                    if (cores_enabled) core = m.mk_join(core.get(), core2.get());
-                }                                                                                           
-            }
-            
-            if (result.empty()) {                                                                           
-                // all subgoals were shown to be unsat.                                                     
-                // create an decided_unsat goal with the proof
-                in->reset_all();
-                proof_ref pr(m);
-                if (proofs_enabled)
-                    apply(m, pc1, pc_buffer, pr);
-                SASSERT(cores_enabled || core == 0);
-                in->assert_expr(m.mk_false(), pr, core);
-                core = 0;
-                result.push_back(in.get());
-                SASSERT(!mc); SASSERT(!pc); SASSERT(!core);
-            }
-            else {
-                if (models_enabled) mc = concat(mc1.get(), mc_buffer.size(), mc_buffer.c_ptr(), sz_buffer.c_ptr());                 
-                if (proofs_enabled) pc = concat(pc1.get(), pc_buffer.size(), pc_buffer.c_ptr(), sz_buffer.c_ptr()); 
-                SASSERT(cores_enabled || core == 0);
-            }
+            apply_t2(in, r1, mc1, pc1, core1, result, mc, pc, core);
+        }
+    }
+
+protected:
+    /**
+       \brief Apply m_t2 to each subgoal in r1 produced by m_t1 on \c in,
+       and combine the results, converters and cores.
+    */
+    void apply_t2(goal_ref const & in,
+                  goal_ref_buffer & r1,
+                  model_converter_ref & mc1,
+                  proof_converter_ref & pc1,
+                  expr_dependency_ref & core1,
+                  goal_ref_buffer & result, 
+                  model_converter_ref & mc, 
+                  proof_converter_ref & pc, 
+                  expr_dependency_ref & core) {
+        bool models_enabled = in->models_enabled();
+        bool proofs_enabled = in->proofs_enabled();
+        bool cores_enabled  = in->unsat_core_enabled();
+        ast_manager & m = in->m();
+        unsigned r1_size = r1.size();
+        if (cores_enabled) core = core1;
+        proof_converter_ref_buffer pc_buffer;                                                           
+        model_converter_ref_buffer mc_buffer;                                                           
+        sbuffer<unsigned>          sz_buffer;                                                           
+        goal_ref_buffer            r2;                                                                  
+        for (unsigned i = 0; i < r1_size; i++) {                                                        
+            goal_ref g = r1[i];                                                                         
+            r2.reset();                                                                                 
+            model_converter_ref mc2;                                                                   
+            proof_converter_ref pc2;                                                                   
+            expr_dependency_ref  core2(m);                                                              
+            m_t2->operator()(g, r2, mc2, pc2, core2);                                              
+            if (is_decided(r2)) {
+                SASSERT(r2.size() == 1);
+                if (is_decided_sat(r2)) {                                                          
+                    // found solution...                                                                
+                    result.push_back(r2[0]);
+                    if (models_enabled) {
+                        // mc2 contains the actual model                                                    
+                        model_ref md;     
+                        md = alloc(model, m);
+                        apply(mc2, md, 0);
+                        apply(mc1, md, i);
+                        mc   = model2model_converter(md.get());                                             
+                    }
+                    SASSERT(!pc); SASSERT(!core);
+                    return;                                                                             
+                }                                                                                   
+                else {                                                                                  
+                    SASSERT(is_decided_unsat(r2));                                                 
+                    // the proof and unsat core of a decided_unsat goal are stored in the node itself.
+                    // pc2 and core2 must be 0.
+                    SASSERT(!pc2);
+                    SASSERT(!core2);
+                    if (models_enabled) mc_buffer.push_back(0);
+                    if (proofs_enabled) pc_buffer.push_back(proof2proof_converter(m, r2[0]->pr(0)));
+                    if (models_enabled || proofs_enabled) sz_buffer.push_back(0);
+                    if (cores_enabled) core = m.mk_join(core.get(), r2[0]->dep(0));
+                }                                                                         
+            }                                                                                       
+            else {                                                                                      
+                result.append(r2.size(), r2.c_ptr());
+                if (models_enabled) mc_buffer.push_back(mc2.get());
+                if (proofs_enabled) pc_buffer.push_back(pc2.get());
+                if (models_enabled || proofs_enabled) sz_buffer.push_back(r2.size()); 
+                if (cores_enabled) core = m.mk_join(core.get(), core2.get());
+            }                                                                                           
+        }
+        
+        if (result.empty()) {                                                                           
+            // all subgoals were shown to be unsat.                                                     
+            // create an decided_unsat goal with the proof
+            in->reset_all();
+            proof_ref pr(m);
+            if (proofs_enabled)
+                apply(m, pc1, pc_buffer, pr);
+            SASSERT(cores_enabled || core == 0);
+            in->assert_expr(m.mk_false(), pr, core);
+            core = 0;
+            result.push_back(in.get());
+            SASSERT(!mc); SASSERT(!pc); SASSERT(!core);
+        }
+        else {
+            if (models_enabled) mc = concat(mc1.get(), mc_buffer.size(), mc_buffer.c_ptr(), sz_buffer.c_ptr());                 
+            if (proofs_enabled) pc = concat(pc1.get(), pc_buffer.size(), pc_buffer.c_ptr(), sz_buffer.c_ptr()); 
+            SASSERT(cores_enabled || core == 0);
         }
     }
 
+public:
     virtual tactic * translate(ast_manager & m) {
         return translate_core<and_then_tactical>(m);
     }
@@ -460,6 +483,52 @@ enum par_exception_kind {
     ERROR_EX
 };
 
+/**
+   \brief Worker threads reserved by a parallel tactical.
+
+   Parallel tacticals may be nested (e.g., par-or inside par-then).
+   All of them share a process-wide budget of threads. A parallel tactical
+   reserves workers from this budget before opening a (nested) OpenMP
+   parallel region, and executes its tasks sequentially when no worker
+   is available. The reservation is released when the object is destroyed.
+   In particular, par-then processes its subgoals as and-then, without copying
+   them, when no worker is available.
+*/
+class par_workers {
+    static unsigned g_num_active; // number of worker threads in use, excluding the main thread.
+    unsigned        m_num_extra;
+public:
+    par_workers(unsigned num_tasks, unsigned max_threads):m_num_extra(0) {
+        if (num_tasks <= 1 || max_threads <= 1)
+            return;
+        #pragma omp critical (par_workers)
+        {
+            unsigned available = max_threads > g_num_active + 1 ? max_threads - g_num_active - 1 : 0;
+            m_num_extra   = std::min(num_tasks - 1, available);
+            g_num_active += m_num_extra;
+        }
+    }
+
+    ~par_workers() {
+        if (m_num_extra == 0)
+            return;
+        #pragma omp critical (par_workers)
+        {
+            g_num_active -= m_num_extra;
+        }
+    }
+
+    int num_threads() const { return static_cast<int>(m_num_extra + 1); }
+
+    static unsigned default_max_threads() { return static_cast<unsigned>(omp_get_num_procs()); }
+
+    static void collect_param_descrs(param_descrs & r) {
+        r.insert("threads", CPK_UINT, "(default: number of processors) maximum number of threads used by par-or and par-then combinators, including nested ones.");
+    }
+};
+
+unsigned par_workers::g_num_active = 0;
+
 class par_tactical : public or_else_tactical {
 
     struct scoped_limits {
@@ -470,25 +539,33 @@ class par_tactical : public or_else_tactical {
         void push_child(reslimit* lim) { m_limit.push_child(lim); ++m_sz; }
     };
 
+    unsigned m_max_threads;
+
 public:
-    par_tactical(unsigned num, tactic * const * ts):or_else_tactical(num, ts) {}
+    par_tactical(unsigned num, tactic * const * ts):
+        or_else_tactical(num, ts),
+        m_max_threads(par_workers::default_max_threads()) {}
     virtual ~par_tactical() {}
 
-    
+    virtual void updt_params(params_ref const & p) {
+        m_max_threads = p.get_uint("threads", par_workers::default_max_threads());
+        or_else_tactical::updt_params(p);
+    }
+
+    virtual void collect_param_descrs(param_descrs & r) {
+        par_workers::collect_param_descrs(r);
+        or_else_tactical::collect_param_descrs(r);
+    }
 
     virtual void operator()(goal_ref const & in, 
                             goal_ref_buffer & result, 
                             model_converter_ref & mc, 
                             proof_converter_ref & pc, 
                             expr_dependency_ref & core) {
-        bool use_seq;
-#ifdef _NO_OMP_
-        use_seq = true;
-#else
-        use_seq = 0 != omp_in_parallel();
-#endif
-        if (use_seq) {
-            // execute tasks sequentially
+        par_workers workers(m_ts.size(), m_max_threads);
+        int num_threads = workers.num_threads();
+        if (num_threads <= 1) {
+            // no worker threads available: execute tasks sequentially
             or_else_tactical::operator()(in, result, mc, pc, core);
             return;
         }
@@ -514,7 +591,7 @@ public:
         std::string        ex_msg;
         unsigned           error_code = 0;
         
-        #pragma omp parallel for
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
         for (int i = 0; i < static_cast<int>(sz); i++) {
             goal_ref_buffer     _result;
             model_converter_ref _mc; 
@@ -580,7 +657,11 @@ public:
         }
     }    
 
-    virtual tactic * translate(ast_manager & m) { return translate_core<par_tactical>(m); }
+    virtual tactic * translate(ast_manager & m) { 
+        par_tactical * r = static_cast<par_tactical*>(translate_core<par_tactical>(m));
+        r->m_max_threads = m_max_threads;
+        return r;
+    }
 };
 
 tactic * par(unsigned num, tactic * const * ts) {
@@ -603,10 +684,24 @@ tactic * par(tactic * t1, tactic * t2, tactic * t3, tactic * t4) {
 }
 
 class par_and_then_tactical : public and_then_tactical {
+    unsigned m_max_threads;
+
 public:
-    par_and_then_tactical(tactic * t1, tactic * t2):and_then_tactical(t1, t2) {}
+    par_and_then_tactical(tactic * t1, tactic * t2):
+        and_then_tactical(t1, t2),
+        m_max_threads(par_workers::default_max_threads()) {}
     virtual ~par_and_then_tactical() {}
 
+    virtual void updt_params(params_ref const & p) {
+        m_max_threads = p.get_uint("threads", par_workers::default_max_threads());
+        and_then_tactical::updt_params(p);
+    }
+
+    virtual void collect_param_descrs(param_descrs & r) {
+        par_workers::collect_param_descrs(r);
+        and_then_tactical::collect_param_descrs(r);
+    }
+
     virtual void operator()(goal_ref const & in, 
                             goal_ref_buffer & result, 
                             model_converter_ref & mc, 
@@ -616,10 +711,10 @@ public:
 #ifdef _NO_OMP_
         use_seq = true;
 #else
-        use_seq = 0 != omp_in_parallel();
+        use_seq = m_max_threads <= 1;
 #endif
         if (use_seq) {
-            // execute tasks sequentially
+            // execute tasks sequentially, without copying the subgoals
             and_then_tactical::operator()(in, result, mc, pc, core);
             return;
         }
@@ -656,6 +751,13 @@ public:
             if (cores_enabled) core = m.mk_join(core1.get(), core); 
         }                                                                                     
         else {                                                                                              
+            par_workers workers(r1_size, m_max_threads);
+            int num_threads = workers.num_threads();
+            if (num_threads <= 1) {
+                // no worker threads available: process the subgoals sequentially, without copying them
+                apply_t2(in, r1, mc1, pc1, core1, result, mc, pc, core);
+                return;
+            }
             if (cores_enabled) core = core1;  
 
             scoped_ptr_vector<ast_manager> managers;
@@ -686,7 +788,7 @@ public:
             unsigned error_code = 0;
             std::string  ex_msg;
 
-            #pragma omp parallel for
+            #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
             for (int i = 0; i < static_cast<int>(r1_size); i++) { 
                 ast_manager & new_m = *(managers[i]);
                 goal_ref new_g = g_copies[i];
@@ -787,7 +889,7 @@ public:
                             if (models_enabled) mc_buffer.set(i, 0);
                             if (proofs_enabled) {
                                 proof * pr = r2[0]->pr(0);
-                                pc_buffer.push_back(proof2proof_converter(m, pr));
+                                pc_buffer.set(i, proof2proof_converter(new_m, pr));
                             }
                             if (cores_enabled && r2[0]->dep(0) != 0) {
                                 expr_dependency_ref * new_dep = alloc(expr_dependency_ref, new_m);
@@ -871,7 +973,9 @@ public:
     }
 
     virtual tactic * translate(ast_manager & m) {
-        return translate_core<and_then_tactical>(m);
+        par_and_then_tactical * r = static_cast<par_and_then_tactical*>(translate_core<par_and_then_tactical>(m));
+        r->m_max_threads = m_max_threads;
+        return r;
     }
 
 };
@@ -17,6 +17,8 @@ Revision History:
 
 --*/
 #include "ast.h"
+#include "uint_set.h"
+#include "z3_omp.h"
 
 static void tst1() {
     ast_manager m;
@@ -131,6 +133,55 @@ static void tst5() {
     m.del(arr3);
 }
 
+// Several threads build the same terms in a manager in concurrent mode.
+static void tst6() {
+    ast_manager m;
+    unsigned num_asts = m.get_num_asts();
+    int const num_threads = 4;
+    unsigned const num_terms = 500;
+    ptr_vector<expr_ref_vector> terms;
+    for (int t = 0; t < num_threads; ++t)
+        terms.push_back(alloc(expr_ref_vector, m));
+    m.set_concurrent(true);
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < num_threads; ++t) {
+        expr_ref_vector & r = *terms[t];
+        sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+        func_decl_ref f(m.mk_func_decl(symbol("f"), s, s), m);
+        func_decl_ref g(m.mk_func_decl(symbol("g"), s, s, s), m);
+        func_decl_ref p(m.mk_func_decl(symbol("p"), s, m.mk_bool_sort()), m);
+        expr_ref a(m.mk_const(symbol("a"), s), m);
+        expr_ref b(m.mk_const(symbol("b"), s), m);
+        expr_ref x(a, m);
+        for (unsigned i = 0; i < num_terms; ++i) {
+            x = m.mk_app(g, m.mk_app(f, x.get()), i % 2 == 0 ? a.get() : b.get());
+            r.push_back(m.mk_or(m.mk_not(m.mk_app(p, x.get())), m.mk_app(p, a.get())));
+        }
+        r.push_back(m.mk_fresh_const("k", s));
+    }
+    VERIFY(m.is_concurrent());
+    uint_set ids;
+    for (unsigned i = 0; i < num_terms; ++i) {
+        expr * e = terms[0]->get(i);
+        for (int t = 1; t < num_threads; ++t)
+            VERIFY(terms[t]->get(i) == e);
+        VERIFY(e->get_ref_count() == static_cast<unsigned>(num_threads));
+        VERIFY(!ids.contains(e->get_id()));
+        ids.insert(e->get_id());
+    }
+    for (int t = 0; t < num_threads; ++t) {
+        expr * k = terms[t]->back();
+        VERIFY(!ids.contains(k->get_id()));
+        ids.insert(k->get_id());
+    }
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < num_threads; ++t)
+        dealloc(terms[t]);
+    // the nodes released in concurrent mode are deleted when the mode is disabled.
+    VERIFY(m.get_num_asts() > num_asts);
+    m.set_concurrent(false);
+    VERIFY(m.get_num_asts() == num_asts);
+}
 
 struct foo {
     unsigned       m_id; 
@@ -153,5 +204,6 @@ void tst_ast() {
     tst3();
     tst4();
     tst5();
+    tst6();
 }
 
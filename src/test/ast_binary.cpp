@@ -0,0 +1,233 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Test the binary format for AST DAGs.
+
+Author:
+
+Revision History:
+
+--*/
+#include<sstream>
+#include<fstream>
+#include<stdio.h>
+#include"ast_binary.h"
+#include"ast_translation.h"
+#include"ast_pp.h"
+#include"arith_decl_plugin.h"
+#include"bv_decl_plugin.h"
+#include"reg_decl_plugins.h"
+#include"z3_exception.h"
+#include"cmd_context.h"
+#include"smt2parser.h"
+#include"solver.h"
+#include"smt_strategic_solver.h"
+
+static void mk_formulas(ast_manager & m, expr_ref_vector & fmls) {
+    arith_util a(m);
+    bv_util    bv(m);
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    sort_ref int_s(a.mk_int(), m);
+    sort_ref bv8(bv.mk_sort(8), m);
+    func_decl_ref f(m.mk_func_decl(symbol("f"), int_s.get(), int_s.get()), m);
+    func_decl_ref g(m.mk_func_decl(symbol(3), s.get(), int_s.get()), m);
+    expr_ref x(m.mk_const(symbol("x"), int_s), m);
+    expr_ref y(m.mk_const(symbol("y"), a.mk_real()), m);
+    expr_ref c(m.mk_const(symbol("c"), s), m);
+    expr_ref b(m.mk_const(symbol("b"), bv8), m);
+    expr_ref fx(m.mk_app(f, x.get()), m);
+    // shared subterm f(x)
+    fmls.push_back(a.mk_gt(a.mk_add(fx, fx), a.mk_numeral(rational(-7), true)));
+    fmls.push_back(a.mk_le(y, a.mk_numeral(rational("123456789012345678901234567890/7"), false)));
+    fmls.push_back(m.mk_eq(m.mk_app(g, c.get()), fx));
+    fmls.push_back(m.mk_eq(bv.mk_extract(3, 0, b), bv.mk_numeral(rational(5), 4)));
+    // forall v:Int. f(v) > 0  with pattern f(v)
+    expr_ref v(m.mk_var(0, int_s), m);
+    expr_ref fv(m.mk_app(f, v.get()), m);
+    app * pat_args[1] = { to_app(fv) };
+    app_ref pat(m.mk_pattern(1, pat_args), m);
+    sort * sorts[1] = { int_s };
+    symbol names[1] = { symbol("v") };
+    expr * pats[1] = { pat };
+    fmls.push_back(m.mk_forall(1, sorts, names, a.mk_gt(fv, a.mk_numeral(rational(0), true)), 0, symbol("q1"), symbol::null, 1, pats));
+}
+
+static void tst_same_manager() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector fmls(m);
+    mk_formulas(m, fmls);
+    std::ostringstream out;
+    ast_to_binary(m, fmls.size(), reinterpret_cast<ast * const *>(fmls.c_ptr()), out);
+    std::string data = out.str();
+    std::cout << "binary size: " << data.size() << "\n";
+    SASSERT(is_ast_binary(data.c_str(), data.c_str() + data.size()));
+    ast_ref_vector result(m);
+    ast_from_binary(m, data.c_str(), data.c_str() + data.size(), result);
+    SASSERT(result.size() == fmls.size());
+    for (unsigned i = 0; i < fmls.size(); ++i) {
+        std::cout << mk_pp(result.get(i), m) << "\n";
+        SASSERT(result.get(i) == fmls.get(i));
+    }
+}
+
+static void tst_other_manager() {
+    ast_manager m1;
+    reg_decl_plugins(m1);
+    expr_ref_vector fmls(m1);
+    mk_formulas(m1, fmls);
+    std::ostringstream out;
+    ast_to_binary(m1, fmls.size(), reinterpret_cast<ast * const *>(fmls.c_ptr()), out);
+    std::string data = out.str();
+
+    ast_manager m2;
+    reg_decl_plugins(m2);
+    ast_ref_vector result(m2);
+    ast_from_binary(m2, data.c_str(), data.c_str() + data.size(), result);
+    SASSERT(result.size() == fmls.size());
+    ast_translation tr(m1, m2);
+    for (unsigned i = 0; i < fmls.size(); ++i) {
+        SASSERT(result.get(i) == tr(fmls.get(i)));
+    }
+}
+
+static void tst_invalid_input() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    expr_ref_vector fmls(m);
+    mk_formulas(m, fmls);
+    std::ostringstream out;
+    ast_to_binary(m, fmls.size(), reinterpret_cast<ast * const *>(fmls.c_ptr()), out);
+    std::string data = out.str();
+    // every truncation of the input must be rejected
+    for (unsigned sz = 0; sz < data.size(); ++sz) {
+        ast_ref_vector result(m);
+        bool ok = true;
+        try {
+            ast_from_binary(m, data.c_str(), data.c_str() + sz, result);
+        }
+        catch (z3_exception &) {
+            ok = false;
+        }
+        VERIFY(!ok);
+    }
+}
+
+// declarations with info but without a family: fresh and skolem constants and assoc/comm functions.
+static void tst_null_family() {
+    ast_manager m1;
+    reg_decl_plugins(m1);
+    arith_util a(m1);
+    sort_ref int_s(a.mk_int(), m1);
+    expr_ref k(m1.mk_fresh_const("k", int_s), m1);
+    func_decl_info info(null_family_id, null_decl_kind);
+    info.set_skolem(true);
+    func_decl_ref sk(m1.mk_func_decl(symbol("sk"), int_s.get(), int_s.get(), info), m1);
+    func_decl_ref h(m1.mk_func_decl(symbol("h"), int_s.get(), int_s.get(), int_s.get(), true, true), m1);
+    SASSERT(to_app(k)->get_decl()->is_skolem() && sk->is_skolem());
+    expr_ref_vector fmls(m1);
+    fmls.push_back(a.mk_gt(m1.mk_app(sk, k.get()), k));
+    fmls.push_back(m1.mk_eq(m1.mk_app(h, k.get(), m1.mk_app(sk, k.get())), k));
+    std::ostringstream out;
+    ast_to_binary(m1, fmls.size(), reinterpret_cast<ast * const *>(fmls.c_ptr()), out);
+    std::string data = out.str();
+
+    ast_ref_vector result1(m1);
+    ast_from_binary(m1, data.c_str(), data.c_str() + data.size(), result1);
+    VERIFY(result1.size() == fmls.size());
+    for (unsigned i = 0; i < fmls.size(); ++i)
+        VERIFY(result1.get(i) == fmls.get(i));
+
+    ast_manager m2;
+    reg_decl_plugins(m2);
+    ast_ref_vector result2(m2);
+    ast_from_binary(m2, data.c_str(), data.c_str() + data.size(), result2);
+    VERIFY(result2.size() == fmls.size());
+    ast_translation tr(m1, m2);
+    for (unsigned i = 0; i < fmls.size(); ++i)
+        VERIFY(result2.get(i) == tr(fmls.get(i)));
+    func_decl * h2 = to_app(to_app(result2.get(1))->get_arg(0))->get_decl();
+    VERIFY(h2->get_family_id() == null_family_id);
+    VERIFY(h2->is_associative() && h2->is_commutative() && !h2->is_skolem());
+    func_decl * k2 = to_app(to_app(to_app(result2.get(1))->get_arg(0))->get_arg(0))->get_decl();
+    VERIFY(k2->is_skolem() && k2->get_family_id() == null_family_id);
+}
+
+static lbool run_smt2(cmd_context & ctx, char const * cmds) {
+    std::istringstream in(cmds);
+    VERIFY(parse_smt2_commands(ctx, in));
+    check_sat_result * r = ctx.get_check_sat_result();
+    return r ? r->status() : l_undef;
+}
+
+// the declarations of a loaded file can be used by the following commands.
+static void tst_load_binary_cmd() {
+    char const * file_name = "ast_binary_test.bin";
+    {
+        cmd_context ctx;
+        run_smt2(ctx,
+                 "(declare-sort U)\n"
+                 "(declare-const x Int)\n"
+                 "(declare-const u U)\n"
+                 "(declare-fun f (Int) Int)\n"
+                 "(assert (> (f x) 0))\n"
+                 "(assert (= u u))\n"
+                 "(save-binary \"ast_binary_test.bin\")\n");
+    }
+    {
+        cmd_context ctx;
+        ctx.set_solver_factory(mk_smt_strategic_solver_factory());
+        VERIFY(run_smt2(ctx,
+                        "(load-binary \"ast_binary_test.bin\")\n"
+                        "(assert (= x 2))\n"
+                        "(declare-const v U)\n"
+                        "(assert (not (= u v)))\n"
+                        "(check-sat)\n") == l_true);
+        // loading again, or next to existing declarations, does not redeclare anything.
+        VERIFY(run_smt2(ctx,
+                        "(load-binary \"ast_binary_test.bin\")\n"
+                        "(assert (= (f 2) 0))\n"
+                        "(check-sat)\n") == l_false);
+    }
+    {
+        cmd_context ctx;
+        ctx.set_solver_factory(mk_smt_strategic_solver_factory());
+        run_smt2(ctx,
+                 "(declare-const x Int)\n"
+                 "(assert (> x 0))\n"
+                 "(save-binary \"ast_binary_test.bin\")\n");
+        VERIFY(run_smt2(ctx,
+                        "(load-binary \"ast_binary_test.bin\")\n"
+                        "(assert (< x 0))\n"
+                        "(check-sat)\n") == l_false);
+    }
+    {
+        // a file with a non-Boolean term is rejected.
+        ast_manager m;
+        reg_decl_plugins(m);
+        arith_util a(m);
+        ast * t = a.mk_add(m.mk_const(symbol("x"), a.mk_int()), a.mk_numeral(rational(1), true));
+        ast_ref t_ref(t, m);
+        std::ofstream out(file_name, std::ios::out | std::ios::binary);
+        ast_to_binary(m, 1, &t, out);
+        out.close();
+        cmd_context ctx;
+        std::istringstream in("(load-binary \"ast_binary_test.bin\")\n");
+        VERIFY(!parse_smt2_commands(ctx, in));
+    }
+    remove(file_name);
+}
+
+void tst_ast_binary() {
+    tst_load_binary_cmd();
+    tst_same_manager();
+    tst_other_manager();
+    tst_invalid_input();
+    tst_null_family();
+}
@@ -0,0 +1,96 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    bench_util.cpp
+
+Abstract:
+
+    Helpers shared by the benchmark tests.
+
+Author:
+
+Revision History:
+
+--*/
+#include<fstream>
+#include<sstream>
+#include<string.h>
+#include"bench_util.h"
+#include"statistics.h"
+#include"stopwatch.h"
+#include"cmd_context.h"
+#include"smt2parser.h"
+#include"smt_kernel.h"
+#include"smt_params.h"
+
+// options of the test driver (see parse_cmd_line_args in main.cpp).
+// Other arguments starting with '/' are absolute file names.
+static bool is_test_option(char const * arg) {
+    if (arg[0] == '-')
+        return true;
+    if (arg[0] != '/')
+        return false;
+    char const * opt = arg + 1;
+    char const * colon = strchr(opt, ':');
+    size_t len = colon ? static_cast<size_t>(colon - opt) : strlen(opt);
+    static char const * const opts[] = { "h", "?", "v", "w", "a", "tr", "dbg" };
+    for (unsigned j = 0; j < sizeof(opts) / sizeof(opts[0]); ++j) {
+        if (strlen(opts[j]) == len && strncmp(opt, opts[j], len) == 0)
+            return true;
+    }
+    return false;
+}
+
+void for_each_bench_file(char ** argv, int argc, int & i, bench_file_proc proc) {
+    while (i + 1 < argc && !is_test_option(argv[i + 1])) {
+        proc(argv[i + 1]);
+        ++i;
+    }
+}
+
+unsigned get_uint_stat(statistics const & st, char const * key) {
+    for (unsigned i = 0; i < st.size(); ++i) {
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            return st.get_uint_value(i);
+    }
+    return 0;
+}
+
+bool parse_bench_smt2_file(cmd_context & ctx, char const * file_name) {
+    std::ifstream in(file_name);
+    if (in.bad() || in.fail()) {
+        std::cerr << "(error \"failed to open file '" << file_name << "'\")\n";
+        return false;
+    }
+    ctx.set_ignore_check(true);
+    if (!parse_smt2_commands(ctx, in)) {
+        std::cerr << "(error \"failed to parse file '" << file_name << "'\")\n";
+        return false;
+    }
+    return true;
+}
+
+bool parse_bench_smt2_string(cmd_context & ctx, char const * spec) {
+    std::istringstream in(spec);
+    ctx.set_ignore_check(true);
+    return parse_smt2_commands(ctx, in);
+}
+
+lbool check_bench_assertions(cmd_context & ctx, smt_params & fp, statistics & st, double & seconds) {
+    smt::kernel k(ctx.m(), fp);
+    ptr_vector<expr>::const_iterator it  = ctx.begin_assertions();
+    ptr_vector<expr>::const_iterator end = ctx.end_assertions();
+    for (; it != end; ++it)
+        k.assert_expr(*it);
+    stopwatch sw;
+    sw.start();
+    lbool r = k.check();
+    sw.stop();
+    seconds = sw.get_seconds();
+    k.collect_statistics(st);
+    VERIFY(!(r == l_true && ctx.get_status() == cmd_context::UNSAT));
+    VERIFY(!(r == l_false && ctx.get_status() == cmd_context::SAT));
+    return r;
+}
@@ -0,0 +1,59 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    bench_util.h
+
+Abstract:
+
+    Helpers shared by the benchmark tests (TST_ARGV) that
+    take a list of files on the command line.
+
+Author:
+
+Revision History:
+
+--*/
+#ifndef BENCH_UTIL_H_
+#define BENCH_UTIL_H_
+
+#include"lbool.h"
+
+class statistics;
+class cmd_context;
+struct smt_params;
+
+typedef void (*bench_file_proc)(char const * file_name);
+
+/**
+   \brief Apply proc to the arguments following argv[i] up to the next
+   option of the test driver (such as -v:2 or /tr:tag), and advance i past them.
+   Absolute file names are not options.
+*/
+void for_each_bench_file(char ** argv, int argc, int & i, bench_file_proc proc);
+
+/**
+   \brief Return the value of the unsigned statistic key, or 0 if st does not contain it.
+*/
+unsigned get_uint_stat(statistics const & st, char const * key);
+
+/**
+   \brief Parse the SMT-LIB2 file file_name in ctx, ignoring check-sat commands.
+   Return false and report an error if the file could not be opened or parsed.
+*/
+bool parse_bench_smt2_file(cmd_context & ctx, char const * file_name);
+
+/**
+   \brief Parse the SMT-LIB2 commands spec in ctx, ignoring check-sat commands.
+*/
+bool parse_bench_smt2_string(cmd_context & ctx, char const * spec);
+
+/**
+   \brief Check the assertions of ctx with an smt::kernel configured by fp.
+   Store in st the statistics of the kernel, and in seconds the time spent in check.
+   If ctx has an expected status (set-info :status), the result must not contradict it.
+*/
+lbool check_bench_assertions(cmd_context & ctx, smt_params & fp, statistics & st, double & seconds);
+
+#endif /* BENCH_UTIL_H_ */
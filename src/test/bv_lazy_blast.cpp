@@ -0,0 +1,125 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    bv_lazy_blast.cpp
+
+Abstract:
+
+    Test lazy bit-blasting of multipliers, dividers and shifts (smt.bv.lazy_blast).
+    The search must finish within a small conflict budget, and agree 
+    with eager bit-blasting.
+
+Author:
+
+Revision History:
+
+--*/
+
+#include"smt_params.h"
+#include"cmd_context.h"
+#include"statistics.h"
+#include"bench_util.h"
+
+static lbool check(char const * spec, smt_params & fp, statistics & st) {
+    cmd_context ctx;
+    VERIFY(parse_bench_smt2_string(ctx, spec));
+    double seconds;
+    return check_bench_assertions(ctx, fp, st, seconds);
+}
+
+static lbool check(char const * spec, bool lazy, unsigned & conflicts) {
+    smt_params fp;
+    fp.m_bv_lazy_blast = lazy;
+    fp.m_max_conflicts = 20000;
+    statistics st;
+    lbool r = check(spec, fp, st);
+    conflicts = get_uint_stat(st, "conflicts");
+    return r;
+}
+
+static void tst_spec(char const * spec) {
+    unsigned c_eager = 0, c_lazy = 0;
+    lbool r_eager = check(spec, false, c_eager);
+    lbool r_lazy  = check(spec, true, c_lazy);
+    std::cout << "eager: " << r_eager << " (" << c_eager << " conflicts) "
+              << "lazy: " << r_lazy << " (" << c_lazy << " conflicts)\n";
+    VERIFY(r_eager != l_undef);
+    VERIFY(r_lazy == r_eager);
+}
+
+// The simplifications of the lazy terms alone refute these specs, so no circuit is created.
+// Preprocessing is disabled, since it rewrites the terms with constant arguments
+// (and only bvule is internalized without it).
+static void tst_lazy_simplifications() {
+    char const * decls = 
+        "(declare-const x (_ BitVec 16))\n"
+        "(declare-const y (_ BitVec 16))\n";
+    char const * specs[] = {
+        // constant arguments
+        "(assert (not (= (bvmul x #x0000) #x0000)))\n",
+        "(assert (not (bvule (bvudiv_i x #x0010) #x0fff)))\n",
+        "(assert (bvule #x0008 (bvurem_i x #x0008)))\n",
+        // arguments fixed during the search
+        "(assert (not (= (bvlshr x (bvadd y #x0010)) #x0000)))\n"
+        "(assert (= y #x0000))\n",
+        "(assert (bvule x #x0000))\n"
+        "(assert (not (= (bvmul y x) #x0000)))\n",
+        // the bound of the remainder is a number of high bits that are 0, 
+        // so it is exact only for a power of 2 (see the spec with y = 7 below).
+        "(assert (bvule y #x0004))\n"
+        "(assert (bvule #x0004 y))\n"
+        "(assert (bvule #x0004 (bvurem_i x y)))\n",
+        "(assert (bvule x #x0003))\n"
+        "(assert (bvule #x0003 x))\n"
+        "(assert (bvule y #x0005))\n"
+        "(assert (bvule #x0005 y))\n"
+        "(assert (not (= (bvmul x y) #x000f)))\n",
+    };
+    for (unsigned i = 0; i < sizeof(specs) / sizeof(specs[0]); ++i) {
+        std::string spec(decls);
+        spec += specs[i];
+        smt_params fp;
+        fp.m_bv_lazy_blast = true;
+        fp.m_preprocess    = false;
+        statistics st;
+        VERIFY(check(spec.c_str(), fp, st) == l_false);
+        std::cout << "lazy propagations: " << get_uint_stat(st, "bv lazy propagations") << "\n";
+        VERIFY(get_uint_stat(st, "bv lazy propagations") > 0);
+        VERIFY(get_uint_stat(st, "bv lazy blast") == 0);
+    }
+}
+
+void tst_bv_lazy_blast() {
+    tst_lazy_simplifications();
+    char const * decls = 
+        "(declare-const x (_ BitVec 16))\n"
+        "(declare-const y (_ BitVec 16))\n";
+    char const * specs[] = {
+        // the simplifications only rule out one assignment of x and y per conflict.
+        "(assert (= (bvmul x y) #x0f0f))\n"
+        "(assert (bvugt x #x0003))\n"
+        "(assert (bvugt y #x0003))\n",
+        // unsat: the product of an even and any number is even.
+        "(assert (= (bvmul x y) #x0f0f))\n"
+        "(assert (= ((_ extract 0 0) x) #b0))\n"
+        "(assert (bvugt y #x0003))\n",
+        "(assert (= (bvurem x y) #x0007))\n"
+        "(assert (bvult y #x0008))\n",
+        "(assert (= (bvudiv x y) #x0101))\n"
+        "(assert (bvugt y #x0010))\n"
+        "(assert (bvult x #x8000))\n",
+        // unsat, but the remainder must be bit-blasted to refute it.
+        "(assert (bvule y #x0007))\n"
+        "(assert (bvule #x0007 y))\n"
+        "(assert (bvule #x0007 (bvurem_i x y)))\n",
+        "(assert (= (bvshl x y) #x8000))\n"
+        "(assert (= ((_ extract 0 0) x) #b1))\n",
+    };
+    for (unsigned i = 0; i < sizeof(specs) / sizeof(specs[0]); ++i) {
+        std::string spec(decls);
+        spec += specs[i];
+        tst_spec(spec.c_str());
+    }
+}
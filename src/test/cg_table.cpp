@@ -0,0 +1,100 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    cg_table.cpp
+
+Abstract:
+
+    Test the congruence table on random congruence closure problems,
+    and benchmark congruence closure on QF_UF files.
+
+    Usage: test-z3 cg_table_bench <file.smt2> [<file.smt2> ...]
+
+--*/
+
+#include"smt_kernel.h"
+#include"smt_params.h"
+#include"cmd_context.h"
+#include"reg_decl_plugins.h"
+#include"statistics.h"
+#include"util.h"
+#include"bench_util.h"
+
+static unsigned find_root(unsigned_vector & parent, unsigned i) {
+    while (parent[i] != i)
+        i = parent[i];
+    return i;
+}
+
+// Assert random equalities between constants, and a disequality between
+// two unary, binary or ternary applications. The problem is unsat iff the
+// arguments of the applications are pairwise equal.
+static void tst_random_problem(random_gen & r, unsigned num_consts, unsigned num_eqs) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt_params fp;
+    smt::kernel k(m, fp);
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    sort * domain[3] = { s.get(), s.get(), s.get() };
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 1, domain, s), m);
+    func_decl_ref g(m.mk_func_decl(symbol("g"), 2, domain, s), m);
+    func_decl_ref h(m.mk_func_decl(symbol("h"), 3, domain, s), m);
+    expr_ref_vector cs(m);
+    unsigned_vector parent;
+    for (unsigned i = 0; i < num_consts; ++i) {
+        cs.push_back(m.mk_fresh_const("c", s));
+        parent.push_back(i);
+    }
+    for (unsigned i = 0; i < num_eqs; ++i) {
+        unsigned a = r(num_consts), b = r(num_consts);
+        k.assert_expr(m.mk_eq(cs.get(a), cs.get(b)));
+        parent[find_root(parent, a)] = find_root(parent, b);
+    }
+    // nested applications t(i) = g(f(c_i), h(c_i, c_x, c_y)), so that congruences
+    // are propagated through several levels and tables.
+    unsigned x = r(num_consts), y = r(num_consts);
+    expr_ref_vector ts(m);
+    for (unsigned i = 0; i < num_consts; ++i) {
+        expr * args[3] = { cs.get(i), cs.get(x), cs.get(y) };
+        ts.push_back(m.mk_app(g, m.mk_app(f, args[0]), m.mk_app(h, 3, args)));
+    }
+    // populate the congruence tables with all terms, d is fresh.
+    expr_ref d(m.mk_fresh_const("d", s), m);
+    for (unsigned i = 0; i < num_consts; ++i) 
+        k.assert_expr(m.mk_not(m.mk_eq(ts.get(i), d)));
+    unsigned a = r(num_consts), b = r(num_consts);
+    k.assert_expr(m.mk_not(m.mk_eq(ts.get(a), ts.get(b))));
+    lbool expected = find_root(parent, a) == find_root(parent, b) ? l_false : l_true;
+    lbool result   = k.check();
+    std::cout << "consts: " << num_consts << " eqs: " << num_eqs << " result: " << result << "\n";
+    VERIFY(result == expected);
+}
+
+void tst_cg_table() {
+    random_gen r(0);
+    for (unsigned i = 0; i < 40; ++i) {
+        tst_random_problem(r, 10 + r(20), r(30));
+    }
+}
+
+static void bench_file(char const * file_name) {
+    cmd_context ctx;
+    if (!parse_bench_smt2_file(ctx, file_name))
+        return;
+    smt_params fp;
+    statistics st;
+    double secs;
+    lbool r = check_bench_assertions(ctx, fp, st, secs);
+    unsigned eqs = get_uint_stat(st, "added eqs");
+    std::cout << file_name
+              << " result: " << r
+              << " time: " << secs << "s"
+              << " merges: " << eqs
+              << " merges/s: " << (secs > 0 ? eqs / secs : 0.0) << "\n";
+}
+
+void tst_cg_table_bench(char ** argv, int argc, int & i) {
+    for_each_bench_file(argv, argc, i, bench_file);
+}
@@ -10,6 +10,8 @@ Copyright (c) 2015 Microsoft Corporation
 #include "dl_context.h"
 #include "smt_params.h"
 #include "dl_register_engine.h"
+#include "dl_base.h"
+#include <sstream>
 
 using namespace datalog;
 
@@ -73,6 +75,55 @@ void dl_context_saturate_file(params_ref & params, const char * f) {
     std::cerr << "Done\n";
 }
 
+static unsigned dl_context_closure_size(unsigned num_threads, unsigned num_nodes, unsigned num_edges) {
+    ast_manager m;
+    smt_params fparams;
+    register_engine re;
+    context ctx(m, re, fparams);
+    params_ref params;
+    params.set_uint("datalog.threads", num_threads);
+    ctx.updt_params(params);
+
+    // several independent rules per stratum, so that joins are evaluated concurrently.
+    // T and S are output predicates, otherwise their rules are sliced away.
+    std::stringstream problem;
+    problem << "N 64\n\nE(x:N, y:N)\nF(x:N, y:N)\nT(x:N, y:N) printtuples\nS(x:N, y:N) printtuples\n"
+            << "T(x,y) :- E(x,y).\n"
+            << "T(x,z) :- T(x,y), E(y,z).\n"
+            << "T(x,z) :- F(x,y), T(y,z).\n"
+            << "S(x,y) :- F(x,y).\n"
+            << "S(x,z) :- S(x,y), F(y,z).\n"
+            << "S(x,z) :- E(x,y), T(y,z), S(z,x).\n";
+    random_gen r(0);
+    for (unsigned i = 0; i < num_edges; ++i) {
+        problem << (i % 2 == 0 ? "E" : "F") << "(\"n" << r(num_nodes) << "\",\"n" << r(num_nodes) << "\").\n";
+    }
+    parser* p = parser::create(ctx, m);
+    TRUSTME( p->parse_string(problem.str().c_str()) );
+    dealloc(p);
+    ctx.get_rel_context()->saturate();
+    unsigned sz = 0;
+    char const * preds[2] = { "T", "S" };
+    for (unsigned i = 0; i < 2; ++i) {
+        func_decl * pred = ctx.try_get_predicate_decl(symbol(preds[i]));
+        SASSERT(pred);
+        sz += ctx.get_rel_context()->get_relation(pred).get_size_estimate_rows();
+    }
+    return sz;
+}
+
+void tst_dl_context_threads() {
+    unsigned const expected[4] = { 57, 393, 898, 1615 };
+    for (unsigned i = 0; i < 4; ++i) {
+        unsigned num_nodes = 10 + 10 * i, num_edges = 20 + 30 * i;
+        unsigned sz1 = dl_context_closure_size(1, num_nodes, num_edges);
+        unsigned sz4 = dl_context_closure_size(4, num_nodes, num_edges);
+        std::cout << "nodes: " << num_nodes << " edges: " << num_edges << " facts: " << sz1 << " " << sz4 << "\n";
+        VERIFY(sz1 == expected[i]);
+        VERIFY(sz4 == expected[i]);
+    }
+}
+
 void tst_dl_context() {
     symbol relations[] = { symbol("tr_skip"), symbol("tr_sparse"), symbol("tr_hashtable"), symbol("smt_relation2")  };
     const unsigned rel_cnt = sizeof(relations)/sizeof(symbol);
@@ -1,12 +1,219 @@
 /*++
 Copyright (c) 2015 Microsoft Corporation
 --*/
-#if defined(_WINDOWS) || defined(_CYGWIN)
-
 #include "dl_context.h"
 #include "dl_table.h"
 #include "dl_register_engine.h"
 #include "dl_relation_manager.h"
+#include "dl_sparse_table.h"
+
+static datalog::table_base* mk_random_table(datalog::relation_manager& m, datalog::table_signature& sig, 
+                                            random_gen& r, unsigned num_rows) {
+    datalog::table_base* t = m.get_table_plugin(symbol("sparse"))->mk_empty(sig);
+    datalog::table_fact row;
+    for (unsigned i = 0; i < num_rows; ++i) {
+        row.reset();
+        for (unsigned j = 0; j < sig.size(); ++j) {
+            row.push_back(r(static_cast<unsigned>(sig[j])));
+        }
+        t->add_fact(row);
+    }
+    return t;
+}
+
+static bool is_subset(datalog::table_base const& t1, datalog::table_base const& t2) {
+    datalog::table_fact row;
+    datalog::table_base::iterator it = t1.begin(), end = t1.end();
+    for (; it != end; ++it) {
+        it->get_fact(row);
+        if (!t2.contains_fact(row)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// compare joins of sparse tables evaluated by indexing and by partitioning
+static void test_sparse_join(unsigned num_rows, unsigned col_cnt) {
+    datalog::table_signature sig;
+    sig.push_back(256);
+    sig.push_back(64);
+    sig.push_back(1000);
+    unsigned cols1[2] = { 0, 1 };
+    unsigned cols2[2] = { 1, 0 };
+    random_gen r(num_rows);
+    ast_manager ast_m;
+    smt_params fparams;
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, fparams);
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_base* t1 = mk_random_table(m, sig, r, num_rows);
+    datalog::table_base* t2 = mk_random_table(m, sig, r, num_rows);
+    datalog::table_join_fn * join = m.mk_join_fn(*t1, *t2, col_cnt, cols1, cols2);
+
+    params_ref p;
+    p.set_uint("datalog.join_partition_threshold", 0);
+    ctx.updt_params(p);
+    datalog::table_base* indexed = (*join)(*t1, *t2);
+    unsigned thresholds[2] = { 1, num_rows / 2 };
+    unsigned threads[3] = { 1, 2, 3 };
+    for (unsigned i = 0; i < 2; ++i) {
+        for (unsigned j = 0; j < 3; ++j) {
+            p.set_uint("datalog.join_partition_threshold", thresholds[i]);
+            p.set_uint("datalog.threads", threads[j]);
+            ctx.updt_params(p);
+            datalog::table_base* partitioned = (*join)(*t1, *t2);
+            std::cout << "rows: " << num_rows << " cols: " << col_cnt << " threads: " << threads[j] 
+                      << " join: " << indexed->get_size_estimate_rows() << " " 
+                      << partitioned->get_size_estimate_rows() << "\n";
+            VERIFY(indexed->get_size_estimate_rows() == partitioned->get_size_estimate_rows());
+            VERIFY(is_subset(*indexed, *partitioned));
+            partitioned->deallocate();
+        }
+    }
+    dealloc(join);
+    indexed->deallocate();
+    t1->deallocate();
+    t2->deallocate();
+}
+
+void tst_dl_table_join() {
+    test_sparse_join(10, 1);
+    test_sparse_join(3000, 1);
+    test_sparse_join(3000, 2);
+    test_sparse_join(20000, 2);
+}
+
+static void check_same_facts(datalog::table_base const& t1, datalog::table_base const& t2) {
+    std::cout << "rows: " << t1.get_size_estimate_rows() << " " << t2.get_size_estimate_rows() << "\n";
+    VERIFY(t1.get_size_estimate_rows() == t2.get_size_estimate_rows());
+    VERIFY(is_subset(t1, t2));
+    VERIFY(is_subset(t2, t1));
+}
+
+// compare a columnar table with a sparse table holding the same facts
+static void test_columnar_table(unsigned num_rows) {
+    datalog::table_signature sig;
+    sig.push_back(2);
+    sig.push_back(300);
+    sig.push_back(1 << 20);
+    sig.push_back(70000);
+    sig.push_back(300);
+    random_gen r(num_rows);
+    ast_manager ast_m;
+    smt_params fparams;
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, fparams);
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_base* ct = m.get_table_plugin(symbol("columnar"))->mk_empty(sig);
+    datalog::table_base* st = m.get_table_plugin(symbol("sparse"))->mk_empty(sig);
+    datalog::table_fact row;
+    row.resize(5);
+    for (unsigned i = 0; i < num_rows; ++i) {
+        row[0] = r(2);
+        row[1] = r(300);
+        row[2] = r(3) == 0 ? row[1] : r(300);
+        row[3] = 1000 * r(60);
+        row[4] = r(3) == 0 ? row[1] : r(300);
+        ct->add_fact(row);
+        st->add_fact(row);
+        if (r(5) == 0) {
+            ct->remove_fact(row);
+            st->remove_fact(row);
+        }
+    }
+    check_same_facts(*ct, *st);
+    datalog::table_base* ct2 = ct->clone();
+    datalog::table_base* st2 = st->clone();
+
+    unsigned removed[2] = { 0, 2 };
+    datalog::table_transformer_fn * cproject = m.mk_project_fn(*ct, 2, removed);
+    datalog::table_transformer_fn * sproject = m.mk_project_fn(*st, 2, removed);
+    datalog::table_base* cp = (*cproject)(*ct);
+    datalog::table_base* sp = (*sproject)(*st);
+    check_same_facts(*cp, *sp);
+
+    scoped_ptr<datalog::table_mutator_fn> cfilter = m.mk_filter_equal_fn(*ct, 7000, 3);
+    scoped_ptr<datalog::table_mutator_fn> sfilter = m.mk_filter_equal_fn(*st, 7000, 3);
+    (*cfilter)(*ct);
+    (*sfilter)(*st);
+    check_same_facts(*ct, *st);
+    cfilter = m.mk_filter_equal_fn(*ct, 1, 0);
+    sfilter = m.mk_filter_equal_fn(*st, 1, 0);
+    (*cfilter)(*ct);
+    (*sfilter)(*st);
+    check_same_facts(*ct, *st);
+
+    // hash join of the table with a projection of itself, on a plain and a dictionary column
+    unsigned cols1[2] = { 1, 3 };
+    unsigned cols2[2] = { 0, 1 };
+    unsigned removed2[3] = { 0, 2, 5 };
+    scoped_ptr<datalog::table_join_fn> cjoin = m.mk_join_project_fn(*ct2, *cp, 2, cols1, cols2, 3, removed2);
+    scoped_ptr<datalog::table_join_fn> sjoin = m.mk_join_project_fn(*st2, *sp, 2, cols1, cols2, 3, removed2);
+    datalog::table_base* cj = (*cjoin)(*ct2, *cp);
+    datalog::table_base* sj = (*sjoin)(*st2, *sp);
+    check_same_facts(*cj, *sj);
+    cj->deallocate();
+    sj->deallocate();
+    cjoin = m.mk_join_fn(*cp, *ct2, 2, cols2, cols1);
+    sjoin = m.mk_join_fn(*sp, *st2, 2, cols2, cols1);
+    cj = (*cjoin)(*cp, *ct2);
+    sj = (*sjoin)(*sp, *st2);
+    check_same_facts(*cj, *sj);
+    cj->deallocate();
+    sj->deallocate();
+
+    // union of the filtered table into the original one, the delta gets the new facts
+    datalog::table_base* ct3 = ct2->clone();
+    datalog::table_base* st3 = st2->clone();
+    datalog::table_base* cdelta = m.get_table_plugin(symbol("columnar"))->mk_empty(sig);
+    datalog::table_base* sdelta = m.get_table_plugin(symbol("sparse"))->mk_empty(sig);
+    row[0] = 0; row[1] = 1; row[2] = 1 << 19; row[3] = 69999; row[4] = 299;
+    ct->add_fact(row);
+    st->add_fact(row);
+    scoped_ptr<datalog::table_union_fn> cunion = m.mk_union_fn(*ct3, *ct, cdelta);
+    scoped_ptr<datalog::table_union_fn> sunion = m.mk_union_fn(*st3, *st, sdelta);
+    (*cunion)(*ct3, *ct, cdelta);
+    (*sunion)(*st3, *st, sdelta);
+    check_same_facts(*ct3, *st3);
+    check_same_facts(*cdelta, *sdelta);
+    VERIFY(!cdelta->empty());
+    ct3->deallocate();
+    st3->deallocate();
+    cdelta->deallocate();
+    sdelta->deallocate();
+
+    // columns 1 and 4 are bit-packed with the same width, column 2 is dictionary encoded
+    unsigned identical[2] = { 1, 4 };
+    cfilter = m.mk_filter_identical_fn(*ct2, 2, identical);
+    sfilter = m.mk_filter_identical_fn(*st2, 2, identical);
+    (*cfilter)(*ct2);
+    (*sfilter)(*st2);
+    check_same_facts(*ct2, *st2);
+    identical[1] = 2;
+    cfilter = m.mk_filter_identical_fn(*ct2, 2, identical);
+    sfilter = m.mk_filter_identical_fn(*st2, 2, identical);
+    (*cfilter)(*ct2);
+    (*sfilter)(*st2);
+    check_same_facts(*ct2, *st2);
+
+    dealloc(cproject);
+    dealloc(sproject);
+    ct->deallocate();
+    st->deallocate();
+    ct2->deallocate();
+    st2->deallocate();
+    cp->deallocate();
+    sp->deallocate();
+}
+
+void tst_dl_columnar_table() {
+    test_columnar_table(10);
+    test_columnar_table(1000);
+    test_columnar_table(50000);
+}
+
+#if defined(_WINDOWS) || defined(_CYGWIN)
 
 typedef datalog::table_base* (*mk_table_fn)(datalog::relation_manager& m, datalog::table_signature& sig);
 
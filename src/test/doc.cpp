@@ -17,6 +17,7 @@ Copyright (c) 2015 Microsoft Corporation
 #include "ast_util.h"
 #include "expr_safe_replace.h"
 #include "th_rewriter.h"
+#include "stopwatch.h"
 
 
 static void tst_doc1(unsigned n) {
@@ -476,7 +477,69 @@ public:
 };
 
 
+// insert without subsumption signatures
+static void naive_insert(tbv_manager& m, ptr_vector<tbv>& ts, tbv* t) {
+    unsigned j = 0;
+    bool found = false;
+    for (unsigned i = 0; i < ts.size(); ++i, ++j) {
+        if (m.contains(*ts[i], *t)) {
+            found = true;
+        }
+        else if (m.contains(*t, *ts[i])) {
+            m.deallocate(ts[i]);
+            --j;
+            continue;
+        }
+        ts[j] = ts[i];
+    }
+    ts.shrink(j);
+    if (found) {
+        m.deallocate(t);
+    }
+    else {
+        ts.push_back(t);
+    }
+}
+
+static void tst_union_index(unsigned num_bits, unsigned num_tbvs) {
+    tbv_manager m(num_bits);
+    random_gen r(num_bits);
+    utbv u;
+    ptr_vector<tbv> ts;
+    for (unsigned k = 0; k < num_tbvs; ++k) {
+        tbv* t = m.allocateX();
+        // mostly prefixes, as in network reachability problems
+        unsigned len = r(2) == 0 ? r(num_bits) : r(8);
+        for (unsigned i = 0; i < len; ++i) {
+            m.set(*t, num_bits - i - 1, r(4) == 0 ? BIT_1 : BIT_0);
+        }
+        naive_insert(m, ts, m.allocate(*t));
+        u.insert(m, t);
+        VERIFY(u.contains(m, *ts.back()));
+        if (k % 50 == 0) {
+            tbv_ref mask(m, m.allocate(*ts[r(ts.size())]));
+            u.intersect(m, *mask);
+            unsigned j = 0;
+            for (unsigned i = 0; i < ts.size(); ++i) {
+                if (m.set_and(*ts[i], *mask)) ts[j++] = ts[i];
+                else m.deallocate(ts[i]);
+            }
+            ts.shrink(j);
+        }
+    }
+    std::cout << "bits: " << num_bits << " union size: " << u.size() << "\n";
+    VERIFY(u.size() == ts.size());
+    for (unsigned i = 0; i < ts.size(); ++i) {
+        VERIFY(m.equals(u[i], *ts[i]));
+        m.deallocate(ts[i]);
+    }
+    u.reset(m);
+}
+
 void tst_doc() {
+    tst_union_index(20, 500);
+    tst_union_index(64, 2000);
+    tst_union_index(200, 2000);
 
     test_doc_cls tp(4);
     tp.test_project1();
@@ -490,3 +553,64 @@ void tst_doc() {
     tst_doc1(10);
     tst_doc1(70);
 }
+
+// tbv with num_fixed random positions set to 0 or 1, and x elsewhere.
+static tbv* mk_sparse_tbv(tbv_manager& m, random_gen& r, unsigned num_fixed) {
+    tbv* t = m.allocateX();
+    for (unsigned i = 0; i < num_fixed; ++i) {
+        m.set(*t, r(m.num_tbits()), r(2) == 0 ? BIT_0 : BIT_1);
+    }
+    return t;
+}
+
+// Measure the subsumption sweeps of union_bvec::insert and set_and on docs 
+// with 64 to 1024 bits.
+// Usage: test-z3 doc_bench [num_docs]
+void tst_doc_bench(char** argv, int argc, int& i) {
+    unsigned num_docs = 2000;
+    if (i + 1 < argc) {
+        num_docs = atoi(argv[i + 1]);
+        ++i;
+    }
+    for (unsigned num_bits = 64; num_bits <= 1024; num_bits *= 2) {
+        doc_manager dm(num_bits);
+        tbv_manager& tm = dm.tbvm();
+        random_gen r(0);
+        ptr_vector<doc> ds;
+        for (unsigned k = 0; k < num_docs; ++k) {
+            tbv_ref t(tm, mk_sparse_tbv(tm, r, 1 + r(6)));
+            ds.push_back(dm.allocate(*t));
+        }
+
+        stopwatch sw;
+        sw.start();
+        udoc u;
+        for (unsigned k = 0; k < num_docs; ++k) {
+            u.insert(dm, dm.allocate(*ds[k]));
+        }
+        sw.stop();
+        double insert_time = sw.get_seconds();
+        unsigned num_kept = u.size();
+        u.reset(dm);
+
+        sw.reset();
+        sw.start();
+        unsigned num_nonempty = 0;
+        for (unsigned k = 0; k < num_docs; ++k) {
+            for (unsigned l = 0; l < 100; ++l) {
+                doc_ref d(dm, dm.allocate(*ds[k]));
+                num_nonempty += dm.set_and(*d, *ds[(k + l + 1) % num_docs]);
+            }
+        }
+        sw.stop();
+        double and_time = sw.get_seconds();
+
+        std::cout << "bits: " << num_bits
+                  << " insert: " << num_docs / insert_time << " docs/s (" << num_kept << " kept)"
+                  << " set_and: " << num_docs * 100.0 / and_time / 1e6 << " Mops/s"
+                  << " (" << num_nonempty << " nonempty)\n";
+        for (unsigned k = 0; k < num_docs; ++k) {
+            dm.deallocate(ds[k]);
+        }
+    }
+}
@@ -133,16 +133,20 @@ int main(int argc, char ** argv) {
     TST(symbol_table);
     TST(region);
     TST(symbol);
+    TST_ARGV(symbol_bench);
     TST(heap);
     TST(hashtable);
     TST(rational);
     TST(inf_rational);
     TST(ast);
+    TST(ast_binary);
     TST(optional);
     TST(bit_vector);
     TST(fixed_bit_vector);
     TST(tbv);
+    TST_ARGV(tbv_bench);
     TST(doc);
+    TST_ARGV(doc_bench);
     TST(udoc_relation);
     TST(string_buffer);
     TST(map);
@@ -156,6 +160,7 @@ int main(int argc, char ** argv) {
     TST(simplifier);
     TST(bv_simplifier_plugin);
     TST(bit_blaster);
+    TST(bv_lazy_blast);
     TST(var_subst);
     TST(simple_parser);
     TST(api);
@@ -165,11 +170,15 @@ int main(int argc, char ** argv) {
     TST(matcher);
     TST(object_allocator);
     TST(mpz);
+    TST_ARGV(mpz_bench);
     TST(mpq);
     TST(mpf);
     TST(total_order);
     TST(dl_table);
+    TST(dl_table_join);
+    TST(dl_columnar_table);
     TST(dl_context);
+    TST(dl_context_threads);
     TST(dl_util);
     TST(dl_product_relation);
     TST(dl_relation);
@@ -178,6 +187,8 @@ int main(int argc, char ** argv) {
     TST(escaped);
     TST(buffer);
     TST(chashtable);
+    TST(cg_table);
+    TST_ARGV(cg_table_bench);
     TST(ex);
     TST(nlarith_util);
     TST(api_bug);
@@ -189,6 +200,7 @@ int main(int argc, char ** argv) {
     TST(model_based_opt);
     TST(factor_rewriter);
     TST(smt2print_parse);
+    TST_ARGV(smt2_parse_bench);
     TST(substitution);
     TST(polynomial);
     TST(upolynomial);
@@ -213,10 +225,12 @@ int main(int argc, char ** argv) {
     TST(karr);
     TST(no_overflow);
     TST(memory);
+    TST_ARGV(memory_bench);
     TST(datalog_parser);
     TST_ARGV(datalog_parser_file);
     TST(dl_query);
     TST(quant_solve);
+    TST(qi_queue);
     TST(rcf);
     TST(polynorm);
     TST(qe_arith);
@@ -225,6 +239,13 @@ int main(int argc, char ** argv) {
     TST(theory_pb);
     TST(simplex);
     TST(sat_user_scope);
+    TST(sat_watches);
+    TST(sat_par);
+    TST(sat_inprocess);
+    TST(par_tactical);
+    TST_ARGV(sat_watches_bench);
+    TST(smt_justification);
+    TST_ARGV(smt_justification_bench);
     TST(pdr);
     TST_ARGV(ddnf);
     TST(model_evaluator);
@@ -64,3 +64,50 @@ void tst_memory() {
 void tst_memory() {    
 }
 #endif
+
+#include "z3.h"
+#include "z3_omp.h"
+#include <iostream>
+#include <stdlib.h>
+
+// Stress benchmark for the memory manager: each thread repeatedly creates a
+// context, builds and simplifies bit-vector terms, and deletes the context.
+// Usage: test-z3 memory_bench [num_threads [num_rounds]]
+void tst_memory_bench(char** argv, int argc, int& i) {
+    int num_threads = omp_get_num_procs();
+    int num_rounds  = 20;
+    if (i + 1 < argc) {
+        num_threads = atoi(argv[i + 1]);
+        ++i;
+    }
+    if (i + 1 < argc) {
+        num_rounds = atoi(argv[i + 1]);
+        ++i;
+    }
+    if (num_threads <= 0)
+        num_threads = 1;
+#ifndef _NO_OMP_
+    double wall_start = omp_get_wtime();
+#endif
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < num_threads; ++t) {
+        for (int r = 0; r < num_rounds; ++r) {
+            Z3_config cfg = Z3_mk_config();
+            Z3_context ctx = Z3_mk_context(cfg);
+            Z3_del_config(cfg);
+            Z3_sort bv = Z3_mk_bv_sort(ctx, 64);
+            Z3_ast acc = Z3_mk_int64(ctx, t, bv);
+            for (unsigned k = 0; k < 2000; ++k) {
+                Z3_ast c = Z3_mk_unsigned_int(ctx, k, bv);
+                acc = Z3_mk_bvadd(ctx, Z3_mk_bvmul(ctx, acc, c), Z3_mk_bvxor(ctx, acc, c));
+            }
+            Z3_simplify(ctx, acc);
+            Z3_del_context(ctx);
+        }
+    }
+    std::cout << "threads: " << num_threads << " rounds: " << num_rounds;
+#ifndef _NO_OMP_
+    std::cout << " wall time: " << (omp_get_wtime() - wall_start) << "s";
+#endif
+    std::cout << "\n";
+}
@@ -159,7 +159,55 @@ static void tst_prev_power_2() {
     tst_prev_power_2((1ll << 60), 3, 58);
 }
 
+// Check the machine word fast path of add, sub and mul against
+// the same operations computed on numerators and denominators.
+static void tst_small_rat_ops(unsynch_mpq_manager & m, mpq const & a, mpq const & b) {
+    scoped_mpz n1(m), n2(m), d(m), t(m);
+    scoped_mpq r(m), e(m);
+    m.mul(a.numerator(), b.denominator(), n1);
+    m.mul(b.numerator(), a.denominator(), n2);
+    m.mul(a.denominator(), b.denominator(), d);
+    m.add(n1, n2, t);
+    m.set(e, t, d);
+    m.add(a, b, r);
+    VERIFY(m.eq(r, e));
+    m.sub(n1, n2, t);
+    m.set(e, t, d);
+    m.sub(a, b, r);
+    VERIFY(m.eq(r, e));
+    m.mul(a.numerator(), b.numerator(), t);
+    m.set(e, t, d);
+    m.mul(a, b, r);
+    VERIFY(m.eq(r, e));
+    // in place
+    m.set(r, a);
+    m.add(r, b, r);
+    m.sub(r, b, r);
+    VERIFY(m.eq(r, a));
+}
+
+static void tst_small_rat_ops() {
+    unsynch_mpq_manager m;
+    random_gen rand(0);
+    int64 vals[] = { 0, 1, 2, 3, 6, 1000003, (1ll << 31) - 1, 1ll << 32, (1ll << 62) + 1, INT64_MAX };
+    unsigned num_vals = sizeof(vals)/sizeof(int64);
+    scoped_mpq a(m), b(m);
+    for (unsigned i = 0; i < 10000; ++i) {
+        int64 an = vals[rand(num_vals)], bn = vals[rand(num_vals)];
+        int64 ad = vals[rand(num_vals)], bd = vals[rand(num_vals)];
+        if (rand(2) == 0) { an = rand(100); bn = rand(100); ad = rand(20); bd = rand(20); }
+        if (rand(2) == 0) an = -an;
+        if (rand(2) == 0) bn = -bn;
+        if (ad == 0) ad = 1;
+        if (bd == 0) bd = 1;
+        m.set(a, an, static_cast<uint64>(ad));
+        m.set(b, bn, static_cast<uint64>(bd));
+        tst_small_rat_ops(m, a, b);
+    }
+}
+
 void tst_mpq() {
+    tst_small_rat_ops();
     tst_prev_power_2();
     set_str_bug();
     bug2();
@@ -17,10 +17,14 @@ Revision History:
 
 --*/
 
+#include<string.h>
 #include"mpz.h"
 #include"rational.h"
 #include"timeit.h"
 #include"scoped_numeral.h"
+#include"stopwatch.h"
+#include"z3.h"
+#include"bench_util.h"
 
 static void tst1() {
     synch_mpz_manager m;
@@ -280,7 +284,7 @@ void tst_int_min_bug() {
     mpz big;
     mpz expected;
     mpz r;
-    m.set(big, UINT64_MAX);
+    m.set(big, static_cast<uint64>(UINT64_MAX));
     m.set(expected, "18446744075857035263");
     m.sub(big, intmin, r);
     std::cout << "r: " << m.to_string(r) << "\nexpected: " << m.to_string(expected) << "\n";
@@ -488,8 +492,54 @@ static void tst_pw2() {
     }
 }
 
+#ifndef _MPZ_SMALL_INT
+static void tst_int64_boundary() {
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m), expected(m);
+    // values beyond the int range are small
+    m.set(a, "1099511627776"); // 2^40
+    SASSERT(m.is_small(a));
+    m.mul(a, a, c);            // 2^80
+    m.set(expected, "1208925819614629174706176");
+    SASSERT(!m.is_small(c) && m.eq(c, expected));
+    m.machine_div(c, a, b);
+    SASSERT(m.is_small(b) && m.eq(b, a));
+    // INT64_MAX + 1 and INT64_MIN are not small
+    m.set(a, static_cast<int64>(INT64_MAX));
+    SASSERT(m.is_small(a));
+    m.inc(a);
+    m.set(expected, "9223372036854775808");
+    SASSERT(!m.is_small(a) && m.eq(a, expected));
+    m.neg(a);
+    m.set(b, static_cast<int64>(INT64_MIN));
+    SASSERT(!m.is_small(b) && m.eq(a, b) && m.hash(a) == m.hash(b));
+    m.dec(a);
+    m.set(expected, "-9223372036854775809");
+    SASSERT(m.eq(a, expected));
+    // going back to small numbers
+    m.add(a, mpz(2), a);
+    SASSERT(m.is_small(a) && m.get_int64(a) == -INT64_MAX);
+    m.set(a, static_cast<int64>(3037000499ll));
+    m.mul(a, a, c);
+    SASSERT(m.is_small(c) && m.get_int64(c) == 9223372030926249001ll);
+    m.set(b, static_cast<int64>(3037000500ll));
+    m.mul(b, b, c);
+    m.set(expected, "9223372037000250000");
+    SASSERT(!m.is_small(c) && m.eq(c, expected));
+    m.gcd(c, a, b);
+    SASSERT(m.is_one(b));
+    m.set(a, static_cast<int64>(-INT64_MAX));
+    m.sub(a, mpz(1), c);
+    SASSERT(!m.is_small(c) && m.is_int64(c) && m.get_int64(c) == INT64_MIN);
+    std::cout << "c: " << c << "\n";
+}
+#endif
+
 void tst_mpz() {
     disable_trace("mpz");
+#ifndef _MPZ_SMALL_INT
+    tst_int64_boundary();
+#endif
     enable_trace("mpz_2k");
     tst_pw2();
     tst5();
@@ -510,3 +560,85 @@ void tst_mpz() {
     tst2();
     tst2b();
 }
+
+static void bench_mpz_ops(unsigned num_iterations, unsigned bits) {
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), g(m), q(m), r(m), acc(m);
+    unsigned num_small = 0;
+    random_gen rand(0);
+    stopwatch sw;
+    sw.start();
+    for (unsigned i = 0; i < num_iterations; i++) {
+        // random coefficients of the given bit size, similar to a pivoting step:
+        // normalize by the gcd and accumulate a*b + r
+        m.set(a, static_cast<uint64>(rand()) | 1);
+        m.mul2k(a, bits - 15);
+        m.add(a, mpz(rand()), a);
+        m.set(b, static_cast<int64>(rand()) - 16384);
+        m.mul2k(b, bits - 15);
+        m.add(b, mpz(rand()), b);
+        m.gcd(a, b, g);
+        m.div(a, g, q);
+        m.rem(b, mpz(rand() + 1), r);
+        m.addmul(r, q, b, acc);
+        m.mod(acc, a, acc);
+        if (m.lt(acc, mpz(0)))
+            m.neg(acc);
+        if (m.is_small(acc))
+            num_small++;
+    }
+    sw.stop();
+    std::cout << "mpz ops (" << bits << " bits): " << sw.get_seconds() << "s, small results: " << num_small << "/" << num_iterations << "\n";
+}
+
+static void bench_smt2_file(char const * file_name) {
+    Z3_config cfg = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context(cfg);
+    Z3_del_config(cfg);
+    Z3_ast f = Z3_parse_smtlib2_file(ctx, file_name, 0, 0, 0, 0, 0, 0);
+    if (Z3_get_error_code(ctx) != Z3_OK) {
+        std::cerr << "(error \"failed to parse file '" << file_name << "'\")\n";
+        Z3_del_context(ctx);
+        return;
+    }
+    Z3_solver s = Z3_mk_solver(ctx);
+    Z3_solver_inc_ref(ctx, s);
+    Z3_solver_assert(ctx, s, f);
+    stopwatch sw;
+    sw.start();
+    Z3_lbool res = Z3_solver_check(ctx, s);
+    sw.stop();
+    Z3_stats st = Z3_solver_get_statistics(ctx, s);
+    Z3_stats_inc_ref(ctx, st);
+    unsigned pivots = 0;
+    for (unsigned j = 0; j < Z3_stats_size(ctx, st); j++) {
+        if (Z3_stats_is_uint(ctx, st, j) && strcmp(Z3_stats_get_key(ctx, st, j), "pivots") == 0)
+            pivots = Z3_stats_get_uint_value(ctx, st, j);
+    }
+    Z3_stats_dec_ref(ctx, st);
+    Z3_solver_dec_ref(ctx, s);
+    Z3_del_context(ctx);
+    double secs = sw.get_seconds();
+    std::cout << file_name << " result: " << (res == Z3_L_TRUE ? "sat" : res == Z3_L_FALSE ? "unsat" : "unknown")
+              << " time: " << secs << "s"
+              << " pivots: " << pivots
+              << " pivots/s: " << (secs > 0 ? pivots / secs : 0.0) << "\n";
+}
+
+/**
+   Usage: test-z3 mpz_bench [<file.smt2> ...]
+
+   Run arithmetic on numbers of 32-62 bits, and solve the given (pivot heavy) benchmarks.
+   Build with -D_MPZ_SMALL_INT to measure the 32-bit representation of small numbers.
+*/
+void tst_mpz_bench(char ** argv, int argc, int & i) {
+#ifdef _MPZ_SMALL_INT
+    std::cout << "small numbers: int\n";
+#else
+    std::cout << "small numbers: int64\n";
+#endif
+    bench_mpz_ops(1000000, 32);
+    bench_mpz_ops(1000000, 48);
+    bench_mpz_ops(1000000, 62);
+    for_each_bench_file(argv, argc, i, bench_smt2_file);
+}
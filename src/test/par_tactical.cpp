@@ -0,0 +1,121 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    par_tactical.cpp
+
+Abstract:
+
+    Test that par-then runs as and-then, without copying its subgoals
+    to other managers, when no worker thread is available, and that
+    par-then nested in par-or processes its subgoals in parallel when
+    the thread budget allows it.
+
+Author:
+
+Revision History:
+
+--*/
+#include"tactical.h"
+#include"split_clause_tactic.h"
+#include"reg_decl_plugins.h"
+#include"z3_omp.h"
+
+struct manager_log {
+    ptr_vector<ast_manager> m_in;   // managers of the goals given to par-then
+    ptr_vector<ast_manager> m_out;  // managers of the subgoals processed by par-then
+    svector<int>            m_team; // size of the thread team that processed each subgoal
+};
+
+// Record the manager of the goals it receives, and return them unchanged.
+class log_manager_tactic : public tactic {
+    manager_log & m_log;
+    bool          m_out;
+public:
+    log_manager_tactic(manager_log & log, bool out):m_log(log), m_out(out) {}
+
+    virtual void operator()(goal_ref const & in, 
+                            goal_ref_buffer & result, 
+                            model_converter_ref & mc, 
+                            proof_converter_ref & pc, 
+                            expr_dependency_ref & core) {
+        #pragma omp critical (log_manager_tactic)
+        {
+            (m_out ? m_log.m_out : m_log.m_in).push_back(&in->m());
+#ifndef _NO_OMP_
+            if (m_out)
+                m_log.m_team.push_back(omp_get_level() > 1 ? omp_get_num_threads() : 1);
+#endif
+        }
+        mc = 0; pc = 0; core = 0;
+        result.push_back(in.get());
+    }
+
+    virtual void cleanup() {}
+
+    virtual tactic * translate(ast_manager & m) { return alloc(log_manager_tactic, m_log, m_out); }
+};
+
+static tactic * mk_logged_par_then(manager_log & log) {
+    return and_then(alloc(log_manager_tactic, log, false),
+                    par_and_then(mk_split_clause_tactic(), alloc(log_manager_tactic, log, true)));
+}
+
+static void tst_par_then(tactic * t, manager_log & log, unsigned expected_goals, bool parallel) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    tactic_ref tr(t);
+    goal_ref g = alloc(goal, m);
+    expr_ref a(m.mk_const(symbol("a"), m.mk_bool_sort()), m);
+    expr_ref b(m.mk_const(symbol("b"), m.mk_bool_sort()), m);
+    g->assert_expr(m.mk_or(a, b));
+    goal_ref_buffer     result;
+    model_converter_ref mc;
+    proof_converter_ref pc;
+    expr_dependency_ref core(m);
+    (*tr)(g, result, mc, pc, core);
+    std::cout << "subgoals: " << result.size() << " par-then calls: " << log.m_in.size() 
+              << " processed subgoals: " << log.m_out.size() << "\n";
+    VERIFY(result.size() == expected_goals);
+    VERIFY(!log.m_out.empty());
+    if (parallel) {
+#ifndef _NO_OMP_
+        // some subgoals are processed by a nested team of threads.
+        bool found = false;
+        for (unsigned i = 0; i < log.m_team.size(); ++i) 
+            found |= log.m_team[i] > 1;
+        VERIFY(found);
+#endif
+        return;
+    }
+    // every subgoal is processed in the manager of the goal given to par-then.
+    for (unsigned i = 0; i < log.m_out.size(); ++i) 
+        VERIFY(log.m_in.contains(log.m_out[i]));
+}
+
+void tst_par_tactical() {
+    {
+        manager_log log;
+        params_ref p;
+        p.set_uint("threads", 1);
+        tactic * t = using_params(mk_logged_par_then(log), p);
+        tst_par_then(t, log, 2, false);
+    }
+    {
+        // par-or uses the only worker thread, par-then runs sequentially.
+        manager_log log;
+        params_ref p;
+        p.set_uint("threads", 2);
+        tactic * t = using_params(par(mk_logged_par_then(log), mk_logged_par_then(log)), p);
+        tst_par_then(t, log, 2, false);
+    }
+    {
+        // par-or uses one worker thread, and each par-then gets another one.
+        manager_log log;
+        params_ref p;
+        p.set_uint("threads", 4);
+        tactic * t = using_params(par(mk_logged_par_then(log), mk_logged_par_then(log)), p);
+        tst_par_then(t, log, 2, true);
+    }
+}
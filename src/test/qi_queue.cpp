@@ -0,0 +1,60 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    qi_queue.cpp
+
+Abstract:
+
+    Test the quantifier instantiation queue with qi.dedup.
+    Different bindings of the quantifier below produce the same lemma
+    after simplification, which is asserted only once with qi.dedup.
+
+Author:
+
+Revision History:
+
+--*/
+
+#include<string>
+#include"smt_params.h"
+#include"cmd_context.h"
+#include"statistics.h"
+#include"bench_util.h"
+
+static lbool check(char const * spec, bool dedup, statistics & st) {
+    cmd_context ctx;
+    VERIFY(parse_bench_smt2_string(ctx, spec));
+    smt_params fp;
+    fp.m_qi_dedup = dedup;
+    double seconds;
+    return check_bench_assertions(ctx, fp, st, seconds);
+}
+
+static void tst_spec(char const * spec, lbool expected) {
+    statistics st1, st2;
+    VERIFY(check(spec, false, st1) == expected);
+    VERIFY(check(spec, true, st2) == expected);
+    unsigned inst1 = get_uint_stat(st1, "quant instantiations");
+    unsigned inst2 = get_uint_stat(st2, "quant instantiations");
+    unsigned dup1  = get_uint_stat(st1, "duplicate quant instantiations");
+    unsigned dup2  = get_uint_stat(st2, "duplicate quant instantiations");
+    std::cout << "instances: " << inst1 << " " << inst2 << " duplicates: " << dup1 << " " << dup2 << "\n";
+    VERIFY(dup1 == 0);
+    VERIFY(dup2 > 0);
+    VERIFY(inst2 < inst1);
+}
+
+void tst_qi_queue() {
+    std::string decls =
+        "(declare-fun f (Int) Int)\n"
+        "(declare-fun g (Int) Int)\n"
+        "(declare-fun h (Int) Int)\n"
+        "(assert (forall ((x Int)) (! (> (g (div x 8)) 0) :pattern ((f x)))))\n"
+        "(assert (forall ((x Int)) (! (> (h x) (g x)) :pattern ((h x)))))\n"
+        "(assert (= (+ (f 1) (h 1) (f 2) (h 2) (f 3)) 3))\n";
+    tst_spec(decls.c_str(), l_true);
+    std::string unsat = decls + "(assert (< (h 0) 0))\n";
+    tst_spec(unsat.c_str(), l_false);
+}
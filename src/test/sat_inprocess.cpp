@@ -0,0 +1,108 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_inprocess.cpp
+
+Abstract:
+
+    Test the budgeted inprocessing of the SAT solver (sat.inprocess)
+    on random 3-SAT problems. Each problem is solved twice, and clauses
+    are added between the two checks, so the incremental simplifier
+    runs again on a changed clause set.
+
+Author:
+
+Revision History:
+
+--*/
+
+#include"sat_solver.h"
+#include"statistics.h"
+#include"util.h"
+#include"bench_util.h"
+
+typedef vector<sat::literal_vector> clauses_t;
+
+// add num_clauses random 3-clauses over the variables vs to clauses.
+static void mk_random_3sat(random_gen & r, sat::bool_var_vector const & vs, unsigned num_clauses, clauses_t & clauses) {
+    for (unsigned i = 0; i < num_clauses; ++i) {
+        sat::literal_vector cls;
+        while (cls.size() < 3) {
+            sat::literal l(vs[r(vs.size())], r(2) == 0);
+            if (!cls.contains(l) && !cls.contains(~l))
+                cls.push_back(l);
+        }
+        clauses.push_back(cls);
+    }
+}
+
+static lbool check(sat::solver & s, clauses_t const & clauses, unsigned first) {
+    for (unsigned i = first; i < clauses.size(); ++i)
+        s.mk_clause(clauses[i].size(), const_cast<sat::literal*>(clauses[i].c_ptr()));
+    lbool r = s.check();
+    if (r == l_true) {
+        // the model satisfies every clause.
+        sat::model const & m = s.get_model();
+        for (unsigned i = 0; i < clauses.size(); ++i) {
+            bool sat = false;
+            for (unsigned j = 0; j < clauses[i].size(); ++j) {
+                sat::literal l = clauses[i][j];
+                sat |= m[l.var()] == (l.sign() ? l_false : l_true);
+            }
+            VERIFY(sat);
+        }
+    }
+    return r;
+}
+
+void tst_sat_inprocess() {
+    random_gen r(0);
+    unsigned max_steps = 0;
+    unsigned num_vars  = 200;
+    for (unsigned i = 0; i < 8; ++i) {
+        params_ref p1, p2;
+        p2.set_bool("inprocess", true);
+        p2.set_uint("inprocess.interval", 100);
+        reslimit rlim1, rlim2;
+        sat::solver s1(p1, rlim1, 0);
+        sat::solver s2(p2, rlim2, 0);
+        sat::bool_var_vector vs;
+        for (unsigned v = 0; v < num_vars; ++v) {
+            s1.mk_var();
+            s2.mk_var();
+            vs.push_back(v);
+        }
+        clauses_t clauses;
+        // just below the 3-SAT threshold: hard enough for several inprocessing
+        // steps, and the first check is usually satisfiable.
+        mk_random_3sat(r, vs, 4 * num_vars - r(num_vars / 5), clauses);
+        lbool r1 = check(s1, clauses, 0);
+        lbool r2 = check(s2, clauses, 0);
+        VERIFY(r1 == r2);
+        VERIFY(r1 != l_undef);
+        if (r1 == l_true) {
+            // add clauses over the variables that neither solver eliminated.
+            sat::bool_var_vector active;
+            for (unsigned v = 0; v < num_vars; ++v) {
+                if (!s1.was_eliminated(v) && !s2.was_eliminated(v))
+                    active.push_back(v);
+            }
+            unsigned first = clauses.size();
+            mk_random_3sat(r, active, active.size() / 4 + 1, clauses);
+            r1 = check(s1, clauses, first);
+            r2 = check(s2, clauses, first);
+            VERIFY(r1 == r2);
+            VERIFY(r1 != l_undef);
+        }
+        statistics st;
+        s2.collect_statistics(st);
+        unsigned steps = get_uint_stat(st, "inprocess steps");
+        std::cout << "clauses: " << clauses.size() << " result: " << r1 << " inprocess steps: " << steps << "\n";
+        max_steps = std::max(max_steps, steps);
+    }
+    // in some solver, the incremental subsumption (steps 1 and 6) and
+    // variable elimination (steps 2 and 7) ran at least twice.
+    VERIFY(max_steps >= 8);
+}
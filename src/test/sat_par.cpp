@@ -0,0 +1,90 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_par.cpp
+
+Abstract:
+
+    Test the cube-and-conquer parallel mode of the SAT solver
+    on random 3-SAT problems.
+
+Author:
+
+Revision History:
+
+--*/
+
+#include"sat_solver.h"
+#include"statistics.h"
+#include"util.h"
+#include"bench_util.h"
+
+typedef vector<sat::literal_vector> clauses_t;
+
+static void mk_random_3sat(random_gen & r, unsigned num_vars, unsigned num_clauses, clauses_t & clauses) {
+    for (unsigned i = 0; i < num_clauses; ++i) {
+        sat::literal_vector cls;
+        while (cls.size() < 3) {
+            sat::literal l(r(num_vars), r(2) == 0);
+            if (!cls.contains(l) && !cls.contains(~l))
+                cls.push_back(l);
+        }
+        clauses.push_back(cls);
+    }
+}
+
+static lbool check(unsigned num_vars, clauses_t & clauses, unsigned num_threads, statistics & st) {
+    params_ref p;
+    p.set_uint("threads", num_threads);
+    reslimit rlim;
+    sat::solver s(p, rlim, 0);
+    for (unsigned i = 0; i < num_vars; ++i)
+        s.mk_var();
+    for (unsigned i = 0; i < clauses.size(); ++i)
+        s.mk_clause(clauses[i]);
+    lbool r = s.check();
+    if (r == l_true) {
+        // the model satisfies every clause.
+        sat::model const & m = s.get_model();
+        for (unsigned i = 0; i < clauses.size(); ++i) {
+            bool sat = false;
+            for (unsigned j = 0; j < clauses[i].size(); ++j) {
+                sat::literal l = clauses[i][j];
+                sat |= m[l.var()] == (l.sign() ? l_false : l_true);
+            }
+            VERIFY(sat);
+        }
+    }
+    s.collect_statistics(st);
+    return r;
+}
+
+void tst_sat_par() {
+    random_gen r(0);
+    unsigned num_sat = 0, num_unsat = 0;
+    unsigned num_cubes = 0, num_imported = 0;
+    for (unsigned i = 0; i < 12; ++i) {
+        unsigned num_vars = 150;
+        clauses_t clauses;
+        // around the 3-SAT threshold, so that both results occur.
+        mk_random_3sat(r, num_vars, 4 * num_vars + r(num_vars / 2), clauses);
+        statistics st1, st4;
+        lbool r1 = check(num_vars, clauses, 1, st1);
+        lbool r4 = check(num_vars, clauses, 4, st4);
+        std::cout << "clauses: " << clauses.size() << " sequential: " << r1 << " parallel: " << r4
+                  << " cubes: " << get_uint_stat(st4, "par cubes")
+                  << " imported: " << get_uint_stat(st4, "par imported clauses") << "\n";
+        VERIFY(r1 == r4);
+        VERIFY(r1 != l_undef);
+        if (r1 == l_true) num_sat++; else num_unsat++;
+        num_cubes    += get_uint_stat(st4, "par cubes");
+        num_imported += get_uint_stat(st4, "par imported clauses");
+    }
+    std::cout << "sat: " << num_sat << " unsat: " << num_unsat << " imported: " << num_imported << "\n";
+    VERIFY(num_sat > 0 && num_unsat > 0);
+    // the parallel mode is used, and the workers learn from each other.
+    VERIFY(num_cubes > 0);
+    VERIFY(num_imported > 0);
+}
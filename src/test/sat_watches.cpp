@@ -0,0 +1,85 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    sat_watches.cpp
+
+Abstract:
+
+    Test watch list partitioning and benchmark unit propagation
+    on DIMACS files.
+
+    Usage: test-z3 sat_watches_bench <file.cnf> [<file.cnf> ...]
+
+--*/
+
+#include<fstream>
+#include"sat_solver.h"
+#include"dimacs.h"
+#include"statistics.h"
+#include"stopwatch.h"
+#include"util.h"
+#include"bench_util.h"
+
+static void check_partitioned(sat::watch_list const & wlist) {
+    unsigned i = 0, sz = wlist.size();
+    while (i < sz && wlist[i].is_binary_clause()) ++i;
+    while (i < sz && wlist[i].is_ternary_clause()) ++i;
+    for (; i < sz; ++i) {
+        SASSERT(!wlist[i].is_binary_clause() && !wlist[i].is_ternary_clause());
+    }
+}
+
+void tst_sat_watches() {
+    random_gen r(0);
+    sat::watch_list wlist;
+    unsigned num_bin = 0, num_ter = 0, num_cls = 0;
+    for (unsigned i = 0; i < 1000; ++i) {
+        sat::literal l1(r(100), r(2) == 0);
+        sat::literal l2(r(100), r(2) == 0);
+        switch (r(3)) {
+        case 0: sat::insert_partitioned(wlist, sat::watched(l1, false)); ++num_bin; break;
+        case 1: sat::insert_partitioned(wlist, sat::watched(l1, l2)); ++num_ter; break;
+        default: sat::insert_partitioned(wlist, sat::watched(l1, i)); ++num_cls; break;
+        }
+        check_partitioned(wlist);
+    }
+    SASSERT(wlist.size() == num_bin + num_ter + num_cls);
+    std::cout << "binary: " << num_bin << " ternary: " << num_ter << " clause: " << num_cls << "\n";
+}
+
+static void bench_file(char const * file_name, bool partition) {
+    std::ifstream in(file_name);
+    if (in.bad() || in.fail()) {
+        std::cerr << "(error \"failed to open file '" << file_name << "'\")\n";
+        return;
+    }
+    params_ref p;
+    p.set_bool("partition_watches", partition);
+    reslimit rlim;
+    sat::solver solver(p, rlim, 0);
+    parse_dimacs(in, solver);
+    stopwatch sw;
+    sw.start();
+    lbool r = solver.check();
+    sw.stop();
+    statistics st;
+    solver.collect_statistics(st);
+    unsigned props = get_uint_stat(st, "propagations");
+    double secs = sw.get_seconds();
+    std::cout << file_name << " partition_watches: " << (partition ? "true " : "false")
+              << " result: " << r
+              << " time: " << secs << "s"
+              << " propagations: " << props
+              << " props/s: " << (secs > 0 ? props / secs : 0.0) << "\n";
+}
+
+static void bench_file(char const * file_name) {
+    bench_file(file_name, false);
+    bench_file(file_name, true);
+}
+
+void tst_sat_watches_bench(char ** argv, int argc, int & i) {
+    for_each_bench_file(argv, argc, i, bench_file);
+}
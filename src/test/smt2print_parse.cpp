@@ -9,6 +9,16 @@ Copyright (c) 2015 Microsoft Corporation
 
 #include "z3.h"
 #include <iostream>
+#include <fstream>
+#include <string.h>
+#include "cmd_context.h"
+#include "smt2parser.h"
+#include "mapped_file.h"
+#include "stopwatch.h"
+#include "bench_util.h"
+#ifndef _WINDOWS
+#include <unistd.h>
+#endif
 
 void test_print(Z3_context ctx, Z3_ast a) {
     Z3_set_ast_print_mode(ctx, Z3_PRINT_SMTLIB2_COMPLIANT);
@@ -48,7 +58,34 @@ void test_parseprint(char const* spec) {
     Z3_del_context(ctx);
 }
 
+#ifndef _WINDOWS
+// Files that cannot be mapped, such as pipes, are read into a buffer.
+static void test_mapped_pipe() {
+    char const * spec = "(declare-const x Int)\n(assert (> x 0))\n";
+    int fds[2];
+    VERIFY(pipe(fds) == 0);
+    VERIFY(write(fds[1], spec, strlen(spec)) == static_cast<ssize_t>(strlen(spec)));
+    ::close(fds[1]);
+    char file_name[64];
+    sprintf(file_name, "/dev/fd/%d", fds[0]);
+    mapped_file in;
+    VERIFY(in.open(file_name));
+    ::close(fds[0]);
+    VERIFY(in.size() == strlen(spec));
+    VERIFY(strncmp(in.begin(), spec, in.size()) == 0);
+    cmd_context ctx;
+    VERIFY(parse_smt2_commands(ctx, in.begin(), in.end()));
+    VERIFY(ctx.end_assertions() - ctx.begin_assertions() == 1);
+    mapped_file null_file;
+    VERIFY(null_file.open("/dev/null"));
+    VERIFY(null_file.size() == 0);
+}
+#endif
+
 void tst_smt2print_parse() {
+#ifndef _WINDOWS
+    test_mapped_pipe();
+#endif
 
     // test basic datatypes  
     char const* spec1 = 
@@ -104,6 +141,54 @@ void tst_smt2print_parse() {
 
     test_parseprint(spec5);
 
+    // Test numerals with more digits than a machine integer
+    Z3_context ctx = Z3_mk_context(0);
+    Z3_ast a = Z3_parse_smtlib2_string(ctx,
+                                       "(declare-const x Real)\n"
+                                       "(assert (= x 12345678901234567890123.25))\n",
+                                       0, 0, 0, 0, 0, 0);
+    Z3_ast n = Z3_get_app_arg(ctx, Z3_to_app(ctx, a), 1);
+    std::cout << Z3_get_numeral_string(ctx, n) << "\n";
+    SASSERT(strcmp(Z3_get_numeral_string(ctx, n), "49382715604938271560493/4") == 0);
+    Z3_del_context(ctx);
+
     // Test ?     
 
 }
+
+static double parse_time(char const * file_name, bool use_buffer) {
+    cmd_context ctx;
+    ctx.set_ignore_check(true);
+    stopwatch sw;
+    sw.start();
+    if (use_buffer) {
+        mapped_file in;
+        if (in.open(file_name))
+            parse_smt2_commands(ctx, in.begin(), in.end());
+    }
+    else {
+        std::ifstream in(file_name);
+        parse_smt2_commands(ctx, in);
+    }
+    sw.stop();
+    return sw.get_seconds();
+}
+
+static void bench_file(char const * file_name) {
+    mapped_file in;
+    if (!in.open(file_name)) {
+        std::cerr << "(error \"failed to open file '" << file_name << "'\")\n";
+        return;
+    }
+    double mb = static_cast<double>(in.size()) / (1024.0 * 1024.0);
+    in.close();
+    double t_stream = parse_time(file_name, false);
+    double t_buffer = parse_time(file_name, true);
+    std::cout << file_name << " size: " << mb << "MB"
+              << " stream: " << t_stream << "s (" << (t_stream > 0 ? mb / t_stream : 0.0) << "MB/s)"
+              << " buffer: " << t_buffer << "s (" << (t_buffer > 0 ? mb / t_buffer : 0.0) << "MB/s)\n";
+}
+
+void tst_smt2_parse_bench(char ** argv, int argc, int & i) {
+    for_each_bench_file(argv, argc, i, bench_file);
+}
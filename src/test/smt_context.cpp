@@ -6,6 +6,60 @@ Copyright (c) 2015 Microsoft Corporation
 
 #include "smt_context.h"
 #include "reg_decl_plugins.h"
+#include "statistics.h"
+#include "util.h"
+#include "bench_util.h"
+
+static lbool check_random_3sat(unsigned seed, smt_params & params, statistics & st) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt::context ctx(m, params);
+    random_gen r(seed);
+    unsigned num_vars = 120;
+    expr_ref_vector vs(m);
+    for (unsigned i = 0; i < num_vars; ++i)
+        vs.push_back(m.mk_fresh_const("p", m.mk_bool_sort()));
+    for (unsigned i = 0; i < 4 * num_vars + 30; ++i) {
+        expr_ref_vector cls(m);
+        for (unsigned j = 0; j < 3; ++j) {
+            expr * v = vs.get(r(num_vars));
+            cls.push_back(r(2) == 0 ? v : m.mk_not(v));
+        }
+        ctx.assert_expr(m.mk_or(cls.size(), cls.c_ptr()));
+    }
+    lbool result = ctx.check();
+    ctx.collect_statistics(st);
+    return result;
+}
+
+// glue based lemma deletion and glucose restarts agree with the default configuration.
+static void tst_glue() {
+    unsigned restarts = 0, deleted = 0;
+    for (unsigned seed = 0; seed < 4; ++seed) {
+        smt_params p1, p2;
+        p2.m_lemma_gc_tiered     = true;
+        p2.m_lemma_gc_initial    = 50;
+        p2.m_recent_lemmas_size  = 10;
+        p2.m_restart_strategy    = RS_GLUCOSE;
+        // restart whenever the recent glue is above the average, and never skip a restart,
+        // so that the glucose restarts also happen on these small problems.
+        p2.m_restart_adaptive    = false;
+        p2.m_restart_glue_margin = 1.0;
+        statistics st1, st2;
+        lbool r1 = check_random_3sat(seed, p1, st1);
+        lbool r2 = check_random_3sat(seed, p2, st2);
+        std::cout << "result: " << r1 << " " << r2
+                  << " conflicts: " << get_uint_stat(st2, "conflicts")
+                  << " restarts: " << get_uint_stat(st2, "restarts")
+                  << " deleted clauses: " << get_uint_stat(st2, "del clause") << "\n";
+        VERIFY(r1 != l_undef);
+        VERIFY(r1 == r2);
+        restarts += get_uint_stat(st2, "restarts");
+        deleted  += get_uint_stat(st2, "del clause");
+    }
+    VERIFY(restarts > 0);
+    VERIFY(deleted > 0);
+}
 
 void tst_smt_context()
 {
@@ -32,4 +86,6 @@ void tst_smt_context()
     }
 
     ctx.check();
+
+    tst_glue();
 }
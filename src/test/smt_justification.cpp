@@ -0,0 +1,130 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    smt_justification.cpp
+
+Abstract:
+
+    Test compact justifications for equality propagation, and
+    benchmark them against the default encoding on SMT-LIB2 files.
+
+    Usage: test-z3 smt_justification_bench <file.smt2> [<file.smt2> ...]
+
+--*/
+
+#include"smt_kernel.h"
+#include"smt_context.h"
+#include"smt_params.h"
+#include"cmd_context.h"
+#include"reg_decl_plugins.h"
+#include"statistics.h"
+#include"bench_util.h"
+#include<string.h>
+
+static lbool check_chain(bool compact, unsigned n) {
+    // (a_i = a_{i+1} or a_i = b_i) and (a_i = a_{i+1} or a_i != b_i) for i < n, and f(a_0) != f(a_n)
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt_params fp;
+    fp.m_compact_justifications = compact;
+    smt::kernel k(m, fp);
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    func_decl_ref f(m.mk_func_decl(symbol("f"), s.get(), s.get()), m);
+    expr_ref_vector as(m), bs(m);
+    for (unsigned i = 0; i <= n; ++i) {
+        as.push_back(m.mk_fresh_const("a", s));
+        bs.push_back(m.mk_fresh_const("b", s));
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        expr_ref eq1(m.mk_eq(as.get(i), as.get(i+1)), m);
+        expr_ref eq2(m.mk_eq(as.get(i), bs.get(i)), m);
+        k.assert_expr(m.mk_or(eq1, eq2));
+        k.assert_expr(m.mk_or(eq1, m.mk_not(eq2)));
+    }
+    k.assert_expr(m.mk_not(m.mk_eq(m.mk_app(f, as.get(0)), m.mk_app(f, as.get(n)))));
+    return k.check();
+}
+
+// propagate (= a c) from a = f(u), c = f(v) and u = v, and return the justification of the assignment.
+// The equalities a = x and x = c would not do: (= a c) becomes congruent to (= x c) and copies its value.
+static smt::justification * propagate_eq(smt::context & ctx, expr * a, expr * c, func_decl * f, expr * u, expr * v, expr * eq) {
+    ast_manager & m = ctx.get_manager();
+    ctx.push();
+    ctx.assert_expr(m.mk_eq(a, m.mk_app(f, u)));
+    ctx.assert_expr(m.mk_eq(c, m.mk_app(f, v)));
+    ctx.assert_expr(m.mk_eq(u, v));
+    VERIFY(ctx.check() == l_true);
+    smt::bool_var b = ctx.get_bool_var(eq);
+    VERIFY(ctx.get_assignment(b) == l_true);
+    smt::b_justification js = ctx.get_justification(b);
+    VERIFY(js.get_kind() == smt::b_justification::JUSTIFICATION);
+    smt::justification * r = js.get_justification();
+    VERIFY(strcmp(r->get_name(), "eq-propagation") == 0);
+    ctx.pop(1);
+    return r;
+}
+
+// all propagations of an equality atom share one justification object.
+static void tst_shared_justification(bool compact) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt_params fp;
+    fp.m_compact_justifications = compact;
+    smt::context ctx(m, fp);
+    sort_ref s(m.mk_uninterpreted_sort(symbol("S")), m);
+    func_decl_ref f(m.mk_func_decl(symbol("f"), s.get(), s.get()), m);
+    expr_ref a(m.mk_const(symbol("a"), s), m), c(m.mk_const(symbol("c"), s), m);
+    expr_ref u1(m.mk_const(symbol("u1"), s), m), v1(m.mk_const(symbol("v1"), s), m);
+    expr_ref u2(m.mk_const(symbol("u2"), s), m), v2(m.mk_const(symbol("v2"), s), m);
+    expr_ref eq(m.mk_eq(a, c), m);
+    // internalize the atom at the base level.
+    ctx.assert_expr(m.mk_or(eq, m.mk_const(symbol("p"), m.mk_bool_sort())));
+    VERIFY(ctx.check() == l_true);
+    smt::justification * js1 = propagate_eq(ctx, a, c, f, u1, v1, eq);
+    smt::justification * js2 = propagate_eq(ctx, a, c, f, u2, v2, eq);
+    // without compact justifications, the region may reuse the address of js1 for js2.
+    std::cout << "compact: " << compact << " shared: " << (js1 == js2) << " in region: " << js1->in_region() << "\n";
+    if (compact) {
+        VERIFY(js1 == js2);
+        VERIFY(!js1->in_region());
+    }
+}
+
+void tst_smt_justification() {
+    tst_shared_justification(false);
+    tst_shared_justification(true);
+    for (unsigned n = 1; n < 20; ++n) {
+        lbool r1 = check_chain(false, n);
+        lbool r2 = check_chain(true, n);
+        std::cout << "chain " << n << ": " << r1 << " " << r2 << "\n";
+        VERIFY(r1 == l_false);
+        VERIFY(r1 == r2);
+    }
+}
+
+static lbool bench_file(char const * file_name, bool compact) {
+    cmd_context ctx;
+    if (!parse_bench_smt2_file(ctx, file_name))
+        return l_undef;
+    smt_params fp;
+    fp.m_compact_justifications = compact;
+    statistics st;
+    double seconds;
+    lbool r = check_bench_assertions(ctx, fp, st, seconds);
+    std::cout << file_name << " compact_justifications: " << (compact ? "true " : "false")
+              << " result: " << r
+              << " time: " << seconds << "s\n";
+    return r;
+}
+
+static void bench_file(char const * file_name) {
+    lbool r1 = bench_file(file_name, false);
+    lbool r2 = bench_file(file_name, true);
+    VERIFY(r1 == l_undef || r2 == l_undef || r1 == r2);
+}
+
+void tst_smt_justification_bench(char ** argv, int argc, int & i) {
+    for_each_bench_file(argv, argc, i, bench_file);
+}
@@ -17,8 +17,12 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<stdio.h>
+#include<stdlib.h>
 #include"symbol.h"
 #include"debug.h"
+#include"z3_omp.h"
+#include"stopwatch.h"
 
 static void tst1() {
     symbol s1("foo");
@@ -55,5 +59,50 @@ void tst_symbol() {
     tst1();
 }
 
-
-
+// Microbenchmark: intern many strings from several threads.
+// Usage: test-z3 symbol_bench [num_threads [num_strings_per_thread]]
+// Every thread interns the same set of names, so the run exercises both
+// the insertion path and the lookup path of the symbol table.
+void tst_symbol_bench(char** argv, int argc, int& i) {
+    int num_threads = omp_get_num_procs();
+    unsigned num_strings = 1000000;
+    if (i + 1 < argc) {
+        num_threads = atoi(argv[i + 1]);
+        ++i;
+    }
+    if (i + 1 < argc) {
+        num_strings = static_cast<unsigned>(atoi(argv[i + 1]));
+        ++i;
+    }
+    if (num_threads <= 0)
+        num_threads = 1;
+    unsigned const num_distinct = 1 << 16;
+    unsigned checksum = 0;
+    stopwatch watch;
+    watch.start();
+#ifndef _NO_OMP_
+    double wall_start = omp_get_wtime();
+#endif
+    #pragma omp parallel for num_threads(num_threads) reduction(+:checksum)
+    for (int t = 0; t < num_threads; ++t) {
+        char buffer[32];
+        unsigned local = 0;
+        for (unsigned k = 0; k < num_strings; ++k) {
+            sprintf(buffer, "sym!%u", (k * 2654435761u + t) % num_distinct);
+            symbol s(buffer);
+            local += s.bare_str()[0];
+        }
+        checksum += local;
+    }
+    watch.stop();
+    std::cout << "threads: " << num_threads
+              << " strings: " << static_cast<double>(num_strings) * num_threads
+              << " cpu time: " << watch.get_seconds() << "s";
+#ifndef _NO_OMP_
+    double wall = omp_get_wtime() - wall_start;
+    std::cout << " wall time: " << wall << "s"
+              << " symbols/s: " << (static_cast<double>(num_strings) * num_threads) / wall;
+#endif
+    std::cout << " checksum: " << checksum << "\n";
+    SASSERT(symbol("sym!0") == symbol("sym!0"));
+}
@@ -5,6 +5,8 @@ Copyright (c) 2015 Microsoft Corporation
 --*/
 
 #include "tbv.h"
+#include "stopwatch.h"
+#include "util.h"
 
 static void tst1(unsigned num_bits) {
     tbv_manager m(num_bits);
@@ -74,6 +76,67 @@ static void tst2(unsigned num_bits) {
     }
 }
 
+static tbv* mk_random_tbv(tbv_manager& m, random_gen& r, unsigned num_x) {
+    tbv* t = m.allocateX();
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        if (r(num_x) != 0) {
+            m.set(*t, i, r(2) == 0 ? BIT_0 : BIT_1);
+        }
+    }
+    return t;
+}
+
+static bool naive_contains(tbv_manager& m, tbv const& a, tbv const& b) {
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        if ((a[i] & b[i]) != b[i]) return false;
+    }
+    return true;
+}
+
+static bool naive_equals(tbv_manager& m, tbv const& a, tbv const& b) {
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+static bool naive_intersects(tbv_manager& m, tbv const& a, tbv const& b) {
+    for (unsigned i = 0; i < m.num_tbits(); ++i) {
+        if ((a[i] & b[i]) == BIT_z) return false;
+    }
+    return true;
+}
+
+// compare the word level operations with bit by bit implementations
+static void tst3(unsigned num_bits) {
+    tbv_manager m(num_bits);
+    random_gen r(num_bits);
+    ptr_vector<tbv> ts;
+    for (unsigned i = 0; i < 30; ++i) {
+        tbv* t = mk_random_tbv(m, r, 2 + i);
+        ts.push_back(t);
+        ts.push_back(m.allocate(*t));
+        // a vector that differs in a single bit or contains t
+        tbv* t2 = m.allocate(*t);
+        m.set(*t2, r(num_bits), r(2) == 0 ? BIT_x : BIT_0);
+        ts.push_back(t2);
+    }
+    tbv_ref tmp(m);
+    for (unsigned i = 0; i < ts.size(); ++i) {
+        for (unsigned j = 0; j < ts.size(); ++j) {
+            tbv const& a = *ts[i];
+            tbv const& b = *ts[j];
+            VERIFY(m.contains(a, b) == naive_contains(m, a, b));
+            VERIFY(m.equals(a, b) == naive_equals(m, a, b));
+            tmp = m.allocate(a);
+            VERIFY(m.set_and(*tmp, b) == naive_intersects(m, a, b));
+        }
+    }
+    for (unsigned i = 0; i < ts.size(); ++i) {
+        m.deallocate(ts[i]);
+    }
+}
+
 void tst_tbv() {
     tst0();
     
@@ -88,4 +151,82 @@ void tst_tbv() {
     tst2(15);
     tst2(16);
     tst2(17);
+
+    tst3(64);
+    tst3(100);
+    tst3(256);
+    tst3(1024);
+}
+
+// Measure the throughput of set_and, contains and equals on 64 to 1024 bit vectors.
+// Usage: test-z3 tbv_bench [num_rounds]
+void tst_tbv_bench(char** argv, int argc, int& i) {
+    unsigned num_rounds = 200;
+    if (i + 1 < argc) {
+        num_rounds = atoi(argv[i + 1]);
+        ++i;
+    }
+    unsigned const num_tbvs = 256;
+    for (unsigned num_bits = 64; num_bits <= 1024; num_bits *= 2) {
+        tbv_manager m(num_bits);
+        random_gen r(0);
+        ptr_vector<tbv> ts, copies;
+        for (unsigned k = 0; k < num_tbvs; ++k) {
+            ts.push_back(mk_random_tbv(m, r, 4));
+            copies.push_back(m.allocate(*ts.back()));
+        }
+        double num_ops = static_cast<double>(num_rounds) * num_tbvs * num_tbvs;
+        unsigned num_true = 0;
+
+        stopwatch sw;
+        sw.start();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (unsigned a = 0; a < num_tbvs; ++a) {
+                for (unsigned b = 0; b < num_tbvs; ++b) {
+                    m.copy(*copies[a], *ts[a]);
+                    num_true += m.set_and(*copies[a], *ts[b]);
+                }
+            }
+        }
+        sw.stop();
+        double and_time = sw.get_seconds();
+
+        sw.reset();
+        sw.start();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (unsigned a = 0; a < num_tbvs; ++a) {
+                for (unsigned b = 0; b < num_tbvs; ++b) {
+                    num_true += m.contains(*ts[a], *ts[b]);
+                }
+            }
+        }
+        sw.stop();
+        double contains_time = sw.get_seconds();
+
+        // compare equal vectors, so that all words are compared
+        for (unsigned k = 0; k < num_tbvs; ++k) {
+            m.copy(*copies[k], *ts[k]);
+        }
+        sw.reset();
+        sw.start();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (unsigned a = 0; a < num_tbvs; ++a) {
+                for (unsigned b = 0; b < num_tbvs; ++b) {
+                    num_true += m.equals(*ts[b], *copies[b]);
+                }
+            }
+        }
+        sw.stop();
+        double equals_time = sw.get_seconds();
+
+        std::cout << "bits: " << num_bits
+                  << " set_and: " << num_ops / and_time / 1e6 << " Mops/s"
+                  << " contains: " << num_ops / contains_time / 1e6 << " Mops/s"
+                  << " equals: " << num_ops / equals_time / 1e6 << " Mops/s"
+                  << " (" << num_true << ")\n";
+        for (unsigned k = 0; k < num_tbvs; ++k) {
+            m.deallocate(ts[k]);
+            m.deallocate(copies[k]);
+        }
+    }
 }
@@ -16,7 +16,34 @@ void tst_timeout() {
 }
 
 #else
+#include<unistd.h>
+#include "scoped_timer.h"
+#include "debug.h"
+
+class counter_eh : public event_handler {
+public:
+    volatile unsigned m_count;
+    counter_eh():m_count(0) {}
+    virtual void operator()() { m_count++; }
+};
+
 void tst_timeout() {
+    counter_eh fired, canceled;
+    {
+        // timers expire in deadline order and are not fired after cancellation.
+        scoped_timer t1(10, &fired);
+        scoped_timer t2(0, &fired);
+        {
+            scoped_timer t3(100000, &canceled);
+        }
+        usleep(200000);
+    }
+    SASSERT(fired.m_count == 2);
+    SASSERT(canceled.m_count == 0);
+    for (unsigned i = 0; i < 1000; ++i) {
+        scoped_timer t(100000, &canceled);
+    }
+    SASSERT(canceled.m_count == 0);
 }
 
 #endif
@@ -21,6 +21,16 @@ Revision History:
 #include"debug.h"
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define USE_AVX2
+#include <immintrin.h>
+#endif
+
 /**
    \brief (Debugging version) Return the position of the most significant (set) bit of a
    nonzero unsigned integer.
@@ -399,3 +409,112 @@ bool add(unsigned sz, unsigned const * a, unsigned const * b, unsigned * c) {
     return k == 0;
 }
 
+#ifdef USE_AVX2
+#define LOAD256(p) _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p))
+#endif
+#ifdef USE_SSE2
+#define LOAD128(p) _mm_loadu_si128(reinterpret_cast<__m128i const *>(p))
+#endif
+
+void bit_and(unsigned sz, unsigned * dst, unsigned const * src) {
+    unsigned i = 0;
+#ifdef USE_AVX2
+    for (; i + 8 <= sz; i += 8) 
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_and_si256(LOAD256(dst + i), LOAD256(src + i)));
+#endif
+#ifdef USE_SSE2
+    for (; i + 4 <= sz; i += 4) 
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_and_si128(LOAD128(dst + i), LOAD128(src + i)));
+#endif
+    for (; i < sz; i++) 
+        dst[i] &= src[i];
+}
+
+void bit_or(unsigned sz, unsigned * dst, unsigned const * src) {
+    unsigned i = 0;
+#ifdef USE_AVX2
+    for (; i + 8 <= sz; i += 8) 
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(LOAD256(dst + i), LOAD256(src + i)));
+#endif
+#ifdef USE_SSE2
+    for (; i + 4 <= sz; i += 4) 
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(LOAD128(dst + i), LOAD128(src + i)));
+#endif
+    for (; i < sz; i++) 
+        dst[i] |= src[i];
+}
+
+bool bit_eq(unsigned sz, unsigned const * a, unsigned const * b) {
+    unsigned i = 0;
+#ifdef USE_AVX2
+    for (; i + 8 <= sz; i += 8) {
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(LOAD256(a + i), LOAD256(b + i))) != -1)
+            return false;
+    }
+#endif
+#ifdef USE_SSE2
+    for (; i + 4 <= sz; i += 4) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(LOAD128(a + i), LOAD128(b + i))) != 0xFFFF)
+            return false;
+    }
+#endif
+    for (; i < sz; i++) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+bool bit_contains(unsigned sz, unsigned const * a, unsigned const * b) {
+    unsigned i = 0;
+#ifdef USE_AVX2
+    for (; i + 8 <= sz; i += 8) {
+        __m256i vb = LOAD256(b + i);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(LOAD256(a + i), vb), vb)) != -1)
+            return false;
+    }
+#endif
+#ifdef USE_SSE2
+    for (; i + 4 <= sz; i += 4) {
+        __m128i vb = LOAD128(b + i);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(LOAD128(a + i), vb), vb)) != 0xFFFF)
+            return false;
+    }
+#endif
+    for (; i < sz; i++) {
+        if ((a[i] & b[i]) != b[i])
+            return false;
+    }
+    return true;
+}
+
+bool has_zero_bit_pair(unsigned sz, unsigned const * data) {
+    unsigned i = 0;
+    // w | (w << 1) | 0x55555555 has a zero bit iff w has a pair of zero bits.
+#ifdef USE_AVX2
+    __m256i evens256 = _mm256_set1_epi32(0x55555555);
+    __m256i ones256  = _mm256_set1_epi32(-1);
+    for (; i + 8 <= sz; i += 8) {
+        __m256i w = LOAD256(data + i);
+        w = _mm256_or_si256(_mm256_or_si256(w, _mm256_slli_epi32(w, 1)), evens256);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(w, ones256)) != -1)
+            return true;
+    }
+#endif
+#ifdef USE_SSE2
+    __m128i evens = _mm_set1_epi32(0x55555555);
+    __m128i ones  = _mm_set1_epi32(-1);
+    for (; i + 4 <= sz; i += 4) {
+        __m128i w = LOAD128(data + i);
+        w = _mm_or_si128(_mm_or_si128(w, _mm_slli_epi32(w, 1)), evens);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(w, ones)) != 0xFFFF)
+            return true;
+    }
+#endif
+    for (; i < sz; i++) {
+        unsigned w = data[i];
+        if ((w | (w << 1) | 0x55555555) != 0xFFFFFFFF)
+            return true;
+    }
+    return false;
+}
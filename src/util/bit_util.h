@@ -129,4 +129,32 @@ bool lt(unsigned sz, unsigned * data1, unsigned * data2);
 */
 bool add(unsigned sz, unsigned const * a, unsigned const * b, unsigned * c);
 
+/**
+   \brief dst <- dst & src. Both must have the same size.
+
+   The functions below process several words at once using SSE2 (or AVX2 when the compiler
+   targets it), and fall back to a word by word loop on other architectures.
+*/
+void bit_and(unsigned sz, unsigned * dst, unsigned const * src);
+
+/**
+   \brief dst <- dst | src. Both must have the same size.
+*/
+void bit_or(unsigned sz, unsigned * dst, unsigned const * src);
+
+/**
+   \brief Return true if a and b contain the same words.
+*/
+bool bit_eq(unsigned sz, unsigned const * a, unsigned const * b);
+
+/**
+   \brief Return true if (a & b) == b, that is, every bit set in b is set in a.
+*/
+bool bit_contains(unsigned sz, unsigned const * a, unsigned const * b);
+
+/**
+   \brief Return true if, for some k, both bits 2k and 2k+1 of data are 0.
+*/
+bool has_zero_bit_pair(unsigned sz, unsigned const * data);
+
 #endif
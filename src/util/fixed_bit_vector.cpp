@@ -23,6 +23,7 @@ Revision History:
 #include"fixed_bit_vector.h"
 #include"trace.h"
 #include"hash.h"
+#include"bit_util.h"
 
 void fixed_bit_vector::set(fixed_bit_vector const& other, unsigned hi, unsigned lo) {
     if ((lo % 32) == 0) {
@@ -99,15 +100,13 @@ fixed_bit_vector_manager::fill1(fixed_bit_vector& bv) const {
 
 fixed_bit_vector& 
 fixed_bit_vector_manager::set_and(fixed_bit_vector& dst, fixed_bit_vector const& src) const {
-    for (unsigned i = 0; i < m_num_words; i++) 
-        dst.m_data[i] &= src.m_data[i];
+    bit_and(m_num_words, dst.m_data, src.m_data);
     return dst;
 }
 
 fixed_bit_vector& 
 fixed_bit_vector_manager::set_or(fixed_bit_vector& dst,  fixed_bit_vector const& src) const {
-    for (unsigned i = 0; i < m_num_words; i++) 
-        dst.m_data[i] |= src.m_data[i];
+    bit_or(m_num_words, dst.m_data, src.m_data);
     return dst;
 }
 
@@ -129,11 +128,7 @@ bool fixed_bit_vector_manager::equals(fixed_bit_vector const& a, fixed_bit_vecto
     unsigned n = num_words();
     if (n == 0)
         return true;
-    for (unsigned i = 0; i < n - 1; i++) {
-        if (a.m_data[i] != b.m_data[i])
-            return false;
-    }
-    return last_word(a) == last_word(b);
+    return bit_eq(n - 1, a.m_data, b.m_data) && last_word(a) == last_word(b);
 }
 unsigned fixed_bit_vector_manager::hash(fixed_bit_vector const& src) const {
     return string_hash(reinterpret_cast<char const* const>(src.m_data), num_bits()/8, num_bits());
@@ -143,11 +138,8 @@ bool fixed_bit_vector_manager::contains(fixed_bit_vector const& a, fixed_bit_vec
     unsigned n = num_words();
     if (n == 0)
         return true;
-    
-    for (unsigned i = 0; i < n - 1; ++i) {
-        if ((a.m_data[i] & b.m_data[i]) != b.m_data[i])
-            return false;
-    }
+    if (!bit_contains(n - 1, a.m_data, b.m_data))
+        return false;
     unsigned b_data = last_word(b);
     return (last_word(a) & b_data) == b_data;
 }
@@ -465,6 +465,40 @@ public:
         return 0;
     }
 
+    /**
+       \brief Return the entry with hash code \c hash whose data \c d satisfies \c eq(d), or 0 if there is none.
+       
+       It allows looking up a key that is not a value of type \c data, provided \c hash
+       is the hash code HashProc would compute for an equal value of type \c data.
+    */
+    template<typename Eq>
+    entry * find_core(unsigned hash, Eq const & eq) const {
+        unsigned mask = m_capacity - 1;
+        unsigned idx  = hash & mask;
+        entry * begin = m_table + idx;
+        entry * end   = m_table + m_capacity;
+        entry * curr  = begin;
+        for (; curr != end; ++curr) {
+            if (curr->is_used()) {
+                if (curr->get_hash() == hash && eq(curr->get_data()))
+                    return curr;
+            }
+            else if (curr->is_free()) {
+                return 0;
+            }
+        }
+        for (curr = m_table; curr != begin; ++curr) {
+            if (curr->is_used()) {
+                if (curr->get_hash() == hash && eq(curr->get_data()))
+                    return curr;
+            }
+            else if (curr->is_free()) {
+                return 0;
+            }
+        }
+        return 0;
+    }
+
     bool find(data const & k, data & r) const {
         entry * e = find_core(k);
         if (e != 0) {
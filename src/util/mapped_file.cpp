@@ -0,0 +1,104 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    mapped_file.cpp
+
+Abstract:
+
+    Read-only view of the contents of a file.
+
+Author:
+
+Revision History:
+
+--*/
+#include<fstream>
+#include"mapped_file.h"
+
+#ifndef _WINDOWS
+#define _USE_MMAP
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<errno.h>
+#endif
+
+static char const g_empty[1] = { 0 };
+
+mapped_file::mapped_file():
+    m_data(g_empty),
+    m_size(0),
+    m_mapped(false) {
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+bool mapped_file::open(char const * file_name) {
+    close();
+#ifdef _USE_MMAP
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * p = mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+            m_data   = static_cast<char const *>(p);
+            m_size   = static_cast<size_t>(st.st_size);
+            m_mapped = true;
+            ::close(fd);
+            return true;
+        }
+    }
+    // pipes, devices, and files that could not be mapped are read into the buffer.
+    // They are read from fd, because a pipe cannot be opened a second time.
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ::close(fd);
+            m_buffer.finalize();
+            return false;
+        }
+        m_buffer.append(static_cast<unsigned>(n), buffer);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(file_name, std::ios::in | std::ios::binary);
+    if (in.bad() || in.fail())
+        return false;
+    char buffer[4096];
+    while (in) {
+        in.read(buffer, sizeof(buffer));
+        m_buffer.append(static_cast<unsigned>(in.gcount()), buffer);
+    }
+#endif
+    m_size = m_buffer.size();
+    m_data = m_size == 0 ? g_empty : m_buffer.c_ptr();
+    return true;
+}
+
+void mapped_file::close() {
+#ifdef _USE_MMAP
+    if (m_mapped)
+        munmap(const_cast<char *>(m_data), m_size);
+#endif
+    m_buffer.finalize();
+    m_data   = g_empty;
+    m_size   = 0;
+    m_mapped = false;
+}
@@ -0,0 +1,45 @@
+/*++
+Copyright (c) 2016 Microsoft Corporation
+
+Module Name:
+
+    mapped_file.h
+
+Abstract:
+
+    Read-only view of the contents of a file.
+    The file is memory mapped when the platform supports it,
+    and read into a buffer otherwise.
+
+Author:
+
+Revision History:
+
+--*/
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include"vector.h"
+
+class mapped_file {
+    char const *  m_data;
+    size_t        m_size;
+    bool          m_mapped;
+    svector<char> m_buffer; // used when the file is not mapped
+public:
+    mapped_file();
+    ~mapped_file();
+
+    /**
+       \brief Map the file \c file_name. Return false if the file could not be opened.
+       Pipes and devices cannot be mapped, they are read into a buffer.
+    */
+    bool open(char const * file_name);
+    void close();
+
+    char const * begin() const { return m_data; }
+    char const * end() const { return m_data + m_size; }
+    size_t size() const { return m_size; }
+};
+
+#endif
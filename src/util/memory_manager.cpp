@@ -130,10 +130,15 @@ bool memory::above_high_watermark() {
     if (g_memory_watermark == 0)
         return false;
     bool r;
+#if defined(_WINDOWS) || defined(_USE_THREAD_LOCAL)
+    // the global counters are updated atomically, see synchronize_counters
+    r = g_memory_watermark < *static_cast<long long volatile *>(&g_memory_alloc_size);
+#else
     #pragma omp critical (z3_memory_manager) 
     {
         r = g_memory_watermark < g_memory_alloc_size;
     }
+#endif
     return r;
 }
 
@@ -161,10 +166,14 @@ void memory::finalize() {
 
 unsigned long long memory::get_allocation_size() {
     long long r;
+#if defined(_WINDOWS) || defined(_USE_THREAD_LOCAL)
+    r = *static_cast<long long volatile *>(&g_memory_alloc_size);
+#else
     #pragma omp critical (z3_memory_manager) 
     {
         r = g_memory_alloc_size;
     }
+#endif
     if (r < 0)
         r = 0;
     return r;
@@ -172,10 +181,14 @@ unsigned long long memory::get_allocation_size() {
 
 unsigned long long memory::get_max_used_memory() {
     unsigned long long r;
+#if defined(_WINDOWS) || defined(_USE_THREAD_LOCAL)
+    r = *static_cast<long long volatile *>(&g_memory_max_used_size);
+#else
     #pragma omp critical (z3_memory_manager) 
     {
         r = g_memory_max_used_size;
     }
+#endif
     return r;
 }
 
@@ -233,29 +246,57 @@ __thread long long g_memory_thread_alloc_size    = 0;
 __thread long long g_memory_thread_alloc_count  = 0;
 #endif
 
+// The global counters are updated using atomic operations instead of
+// the z3_memory_manager critical section. Thus, threads allocating memory
+// concurrently (e.g., one Z3 context per thread) do not contend on a lock.
+// Since each thread only flushes its counters every SYNCH_THRESHOLD bytes,
+// the global limits are checked approximately.
+
+#ifdef _WINDOWS
+#include<intrin.h>
+static long long atomic_add(long long * p, long long delta) {
+    long long old;
+    do {
+        old = *static_cast<long long volatile *>(p);
+    }
+    while (_InterlockedCompareExchange64(p, old + delta, old) != old);
+    return old + delta;
+}
+
+static bool atomic_cas(long long * p, long long old_val, long long new_val) {
+    return _InterlockedCompareExchange64(p, new_val, old_val) == old_val;
+}
+#else
+static long long atomic_add(long long * p, long long delta) {
+    return __sync_add_and_fetch(p, delta);
+}
+
+static bool atomic_cas(long long * p, long long old_val, long long new_val) {
+    return __sync_bool_compare_and_swap(p, old_val, new_val);
+}
+#endif
+
+static void atomic_max(long long * p, long long val) {
+    long long old = *static_cast<long long volatile *>(p);
+    while (val > old && !atomic_cas(p, old, val)) {
+        old = *static_cast<long long volatile *>(p);
+    }
+}
+
 static void synchronize_counters(bool allocating) {
 #ifdef PROFILE_MEMORY
     g_synch_counter++;
 #endif
 
-    bool out_of_mem = false;
-    bool counts_exceeded = false;
-    #pragma omp critical (z3_memory_manager) 
-    {
-        g_memory_alloc_size += g_memory_thread_alloc_size;
-        g_memory_alloc_count += g_memory_thread_alloc_count;
-        if (g_memory_alloc_size > g_memory_max_used_size)
-            g_memory_max_used_size = g_memory_alloc_size;
-        if (g_memory_max_size != 0 && g_memory_alloc_size > g_memory_max_size)
-            out_of_mem = true;
-        if (g_memory_max_alloc_count != 0 && g_memory_alloc_count > g_memory_max_alloc_count)
-            counts_exceeded = true;
-    }
-    g_memory_thread_alloc_size = 0;
-    if (out_of_mem && allocating) {
+    long long alloc_size  = atomic_add(&g_memory_alloc_size, g_memory_thread_alloc_size);
+    long long alloc_count = atomic_add(&g_memory_alloc_count, g_memory_thread_alloc_count);
+    g_memory_thread_alloc_size  = 0;
+    g_memory_thread_alloc_count = 0;
+    atomic_max(&g_memory_max_used_size, alloc_size);
+    if (allocating && g_memory_max_size != 0 && alloc_size > g_memory_max_size) {
         throw_out_of_memory();
     }
-    if (counts_exceeded && allocating) {
+    if (allocating && g_memory_max_alloc_count != 0 && alloc_count > g_memory_max_alloc_count) {
         throw_alloc_counts_exceeded();
     }
 }
@@ -295,7 +295,7 @@ void mpf_manager::set(mpf & o, unsigned ebits, unsigned sbits, mpf_rounding_mode
         TRACE("mpf_dbg", tout << "sig = " << m_mpz_manager.to_string(o.significand) <<
                                  " exp = " << o.exponent << std::endl;);
 
-        if (m_mpz_manager.is_small(exp)) {
+        if (m_mpz_manager.is_int(exp)) {
             o.exponent = m_mpz_manager.get_int64(exp);
             round(rm, o);
         }
@@ -52,7 +52,73 @@ class mpq_manager : public mpz_manager<SYNCH> {
         a.m_den.m_val = 1;
     }
 
+    // Store n/d in a, where d > 0 and gcd(|n|, d) == 1.
+    void set_small(mpq & a, int64 n, int64 d) {
+        SASSERT(d > 0);
+        mpz_manager<SYNCH>::set_i64(a.m_num, n);
+        mpz_manager<SYNCH>::set_i64(a.m_den, d);
+    }
+
+    // Store n/d in a after removing common factors. Assumes d > 0.
+    void set_small_normalized(mpq & a, int64 n, int64 d) {
+        SASSERT(d > 0);
+        if (d != 1 && n != 0) {
+            int64 g = static_cast<int64>(u64_gcd(n < 0 ? -n : n, d));
+            if (g != 1) {
+                n /= g;
+                d /= g;
+            }
+        }
+        else if (n == 0) {
+            d = 1;
+        }
+        set_small(a, n, d);
+    }
+
+    static int64 i64(mpz const & a) { return mpz_manager<SYNCH>::i64(a); }
+
+    // Machine word version of rat_add and rat_sub.
+    // Return false if an intermediate result does not fit in a small number,
+    // the caller must then use the arbitrary precision version.
+    bool small_rat_add(mpq const & a, mpq const & b, bool is_sub, mpq & c) {
+        if (!is_small(a) || !is_small(b))
+            return false;
+        int64 an = i64(a.m_num), ad = i64(a.m_den);
+        int64 bn = is_sub ? -i64(b.m_num) : i64(b.m_num), bd = i64(b.m_den);
+        int64 n, d;
+        if (ad == bd) {
+            if (!mpz_manager<SYNCH>::small_add(an, bn, n))
+                return false;
+            d = ad;
+        }
+        else {
+            int64 t1, t2;
+            if (!mpz_manager<SYNCH>::small_mul(an, bd, t1) ||
+                !mpz_manager<SYNCH>::small_mul(bn, ad, t2) ||
+                !mpz_manager<SYNCH>::small_add(t1, t2, n) ||
+                !mpz_manager<SYNCH>::small_mul(ad, bd, d))
+                return false;
+        }
+        set_small_normalized(c, n, d);
+        return true;
+    }
+
+    bool small_rat_mul(mpq const & a, mpq const & b, mpq & c) {
+        if (!is_small(a) || !is_small(b))
+            return false;
+        int64 n, d;
+        if (!mpz_manager<SYNCH>::small_mul(i64(a.m_num), i64(b.m_num), n) ||
+            !mpz_manager<SYNCH>::small_mul(i64(a.m_den), i64(b.m_den), d))
+            return false;
+        set_small_normalized(c, n, d);
+        return true;
+    }
+
     void normalize(mpq & a) {
+        if (is_small(a)) {
+            set_small_normalized(a, i64(a.m_num), i64(a.m_den));
+            return;
+        }
         if (SYNCH) {
             mpz tmp;
             gcd(a.m_num, a.m_den, tmp);
@@ -75,7 +141,10 @@ class mpq_manager : public mpz_manager<SYNCH> {
 
     void rat_add(mpq const & a, mpq const & b, mpq & c) {
         STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " + " << to_string(b) << " == ";); 
-        if (SYNCH) {
+        if (small_rat_add(a, b, false, c)) {
+            // done
+        }
+        else if (SYNCH) {
             mpz tmp1, tmp2;
             mul(a.m_num, b.m_den, tmp1);
             mul(b.m_num, a.m_den, tmp2);
@@ -116,7 +185,10 @@ class mpq_manager : public mpz_manager<SYNCH> {
 
     void rat_sub(mpq const & a, mpq const & b, mpq & c) {
         STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " - " << to_string(b) << " == ";); 
-        if (SYNCH) {
+        if (small_rat_add(a, b, true, c)) {
+            // done
+        }
+        else if (SYNCH) {
             mpz tmp1, tmp2;
             mul(a.m_num, b.m_den, tmp1);
             mul(b.m_num, a.m_den, tmp2);
@@ -138,9 +210,11 @@ class mpq_manager : public mpz_manager<SYNCH> {
 
     void rat_mul(mpq const & a, mpq const & b, mpq & c) {
         STRACE("rat_mpq", tout << "[mpq] " << to_string(a) << " * " << to_string(b) << " == ";); 
-        mul(a.m_num, b.m_num, c.m_num);
-        mul(a.m_den, b.m_den, c.m_den);
-        normalize(c);
+        if (!small_rat_mul(a, b, c)) {
+            mul(a.m_num, b.m_num, c.m_num);
+            mul(a.m_den, b.m_den, c.m_den);
+            normalize(c);
+        }
         STRACE("rat_mpq", tout << to_string(c) << "\n";);
     }
 
@@ -75,9 +75,13 @@ class mpz_cell {
    If m_ptr == 0, the it is a small number and the value is stored at m_val.
    Otherwise, m_val contains the sign (-1 negative, 1 positive), and m_ptr points to a mpz_cell that
    store the value. <<< This last statement is true only in Windows.
+
+   Small numbers are 64-bit integers different from INT64_MIN. So, neg, abs and division
+   of small numbers do not overflow. If _MPZ_SMALL_INT is defined, small numbers are
+   restricted to [-INT_MAX, INT_MAX] (similar to previous versions).
 */
 class mpz {
-    int        m_val; 
+    int64      m_val; 
 #ifndef _MP_GMP
     mpz_cell * m_ptr;
 #else
@@ -104,6 +108,7 @@ inline void swap(mpz & m1, mpz & m2) { m1.swap(m2); }
 
 template<bool SYNCH = true>
 class mpz_manager {
+    friend class mpq_manager<SYNCH>;
     small_object_allocator  m_allocator;
     omp_nest_lock_t         m_lock;
 #define MPZ_BEGIN_CRITICAL() if (SYNCH) omp_set_nest_lock(&m_lock);
@@ -114,7 +119,6 @@ class mpz_manager {
     unsigned                m_init_cell_capacity;
     mpz_cell *              m_tmp[2];
     mpz_cell *              m_arg[2];
-    mpz                     m_int_min;
     
     static unsigned cell_size(unsigned capacity) { return sizeof(mpz_cell) + sizeof(digit_t) * capacity; }
 
@@ -189,14 +193,44 @@ class mpz_manager {
     template<int IDX>
     void set(mpz & a, int sign, unsigned sz);
 
-    static int64 i64(mpz const & a) { return static_cast<int64>(a.m_val); }
+    static int64 i64(mpz const & a) { return a.m_val; }
+
+    static bool fits_small(int64 v) {
+#ifdef _MPZ_SMALL_INT
+        return -INT_MAX <= v && v <= INT_MAX;
+#else
+        return v != INT64_MIN;
+#endif
+    }
+
+    // Overflow checked operations on small numbers.
+    // They return false if the result is not a small number.
+    static bool small_add(int64 a, int64 b, int64 & r) {
+        SASSERT(a != INT64_MIN && b != INT64_MIN);
+        if (b >= 0 ? a > INT64_MAX - b : a < -INT64_MAX - b)
+            return false;
+        r = a + b;
+        return true;
+    }
+
+    static bool small_mul(int64 a, int64 b, int64 & r) {
+        SASSERT(a != INT64_MIN && b != INT64_MIN);
+        if (a < INT_MIN || a > INT_MAX || b < INT_MIN || b > INT_MAX) {
+            uint64 abs_a = a < 0 ? -a : a;
+            uint64 abs_b = b < 0 ? -b : b;
+            if (abs_a != 0 && abs_b > static_cast<uint64>(INT64_MAX) / abs_a)
+                return false;
+        }
+        r = a * b;
+        return true;
+    }
 
     void set_big_i64(mpz & c, int64 v);
 
     void set_i64(mpz & c, int64 v) { 
-        if (v >= INT_MIN && v <= INT_MAX) {
+        if (fits_small(v)) {
             del(c);
-            c.m_val = static_cast<int>(v); 
+            c.m_val = v; 
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -224,6 +258,37 @@ class mpz_manager {
             return size(a) <= 2;
     }
     
+    // Store the absolute value v in cell.
+    static void set_digits(mpz_cell * cell, uint64 v) {
+        if (sizeof(digit_t) == sizeof(uint64)) {
+            // 64-bit machine
+            cell->m_digits[0] = static_cast<digit_t>(v);
+            cell->m_size      = 1;
+        }
+        else {
+            // 32-bit machine
+            cell->m_digits[0] = static_cast<unsigned>(v);
+            cell->m_digits[1] = static_cast<unsigned>(v >> 32);
+            cell->m_size      = cell->m_digits[1] == 0 ? 1 : 2;
+        }
+    }
+
+    // Return true if the number sign*ds[sz-1]...ds[0] is a small number, and store it in v.
+    // Assumes ds[sz-1] != 0.
+    static bool digits_to_small(int sign, unsigned sz, digit_t const * ds, int64 & v) {
+        uint64 u;
+        if (sz == 1)
+            u = ds[0];
+        else if (sz == 2 && sizeof(digit_t) == sizeof(unsigned))
+            u = (static_cast<uint64>(ds[1]) << 32) | static_cast<uint64>(ds[0]);
+        else
+            return false;
+        if (u > static_cast<uint64>(INT64_MAX))
+            return false;
+        v = sign < 0 ? -static_cast<int64>(u) : static_cast<int64>(u);
+        return fits_small(v);
+    }
+
     // CAST the absolute value into a UINT64
     static uint64 big_abs_to_uint64(mpz const & a) {
         SASSERT(is_abs_uint64(a));
@@ -241,36 +306,43 @@ class mpz_manager {
     template<int IDX>
     void get_sign_cell(mpz const & a, int & sign, mpz_cell * & cell) {
         if (is_small(a)) {
-            if (a.m_val == INT_MIN) {
+            cell = m_arg[IDX];
+            if (a.m_val < 0) {
                 sign = -1;
-                cell = m_int_min.m_ptr;
+                set_digits(cell, -a.m_val);
             }
             else {
-                cell = m_arg[IDX];
-                SASSERT(cell->m_size == 1);
-                if (a.m_val < 0) {
-                    sign = -1;
-                    cell->m_digits[0] = -a.m_val;
-                }
-                else {
-                    sign = 1;
-                    cell->m_digits[0] = a.m_val;
-                }
+                sign = 1;
+                set_digits(cell, a.m_val);
             }
         }
         else {
-            sign = a.m_val;
+            sign = static_cast<int>(a.m_val);
             cell = a.m_ptr;
         }
     }
 #else
     // GMP code
 
+    void set_mpz_t(mpz_t & r, int64 v) {
+        if (sizeof(long) >= sizeof(int64)) {
+            mpz_set_si(r, static_cast<long>(v));
+        }
+        else {
+            uint64 u = v < 0 ? -v : v;
+            mpz_set_ui(r, static_cast<unsigned>(u >> 32));
+            mpz_mul_2exp(r, r, 32);
+            mpz_add_ui(r, r, static_cast<unsigned>(u));
+            if (v < 0)
+                mpz_neg(r, r);
+        }
+    }
+
     template<int IDX>
     void get_arg(mpz const & a, mpz_t * & result) {
         if (is_small(a)) {
             result = m_arg[IDX];
-            mpz_set_si(*result, a.m_val);
+            set_mpz_t(*result, a.m_val);
         }
         else {
             result = a.m_ptr;
@@ -345,8 +417,9 @@ public:
     
     void add(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " + " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) + i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && small_add(i64(a), i64(b), r)) {
+            set_i64(c, r);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -358,8 +431,9 @@ public:
 
     void sub(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " - " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) - i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && small_add(i64(a), -i64(b), r)) {
+            set_i64(c, r);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -375,8 +449,9 @@ public:
 
     void mul(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " * " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) * i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && small_mul(i64(a), i64(b), r)) {
+            set_i64(c, r);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -495,34 +570,24 @@ public:
 
     void neg(mpz & a) {
         STRACE("mpz", tout << "[mpz] 0 - " << to_string(a) << " == ";); 
-        if (is_small(a) && a.m_val == INT_MIN) {
-            // neg(INT_MIN) is not a small int
-            set_big_i64(a, - static_cast<long long>(INT_MIN)); 
-            return;
-        }
-#ifndef _MP_GMP
-        a.m_val = -a.m_val;
-#else
         if (is_small(a)) {
-            a.m_val = -a.m_val;
+            // -a.m_val does not overflow since a.m_val != INT64_MIN
+            set_i64(a, -i64(a));
         }
         else {
+#ifndef _MP_GMP
+            a.m_val = -a.m_val;
+#else
             mpz_neg(*a.m_ptr, *a.m_ptr);
-        }
 #endif
+        }
         STRACE("mpz", tout << to_string(a) << "\n";); 
     }
 
     void abs(mpz & a) {
         if (is_small(a)) {
-            if (a.m_val < 0) {
-                if (a.m_val == INT_MIN) {
-                    // abs(INT_MIN) is not a small int
-                    set_big_i64(a, - static_cast<long long>(INT_MIN)); 
-                }
-                else
-                    a.m_val = -a.m_val;
-            }
+            if (a.m_val < 0)
+                set_i64(a, -i64(a));
         }
         else {
 #ifndef _MP_GMP
@@ -567,13 +632,12 @@ public:
     }
 
     static int sign(mpz const & a) {
+        if (is_small(a))
+            return a.m_val < 0 ? -1 : (a.m_val > 0 ? 1 : 0);
 #ifndef _MP_GMP
-        return a.m_val;
+        return static_cast<int>(a.m_val);
 #else
-        if (is_small(a))
-            return a.m_val;
-        else
-            return mpz_sgn(*a.m_ptr);
+        return mpz_sgn(*a.m_ptr);
 #endif
     }
     
@@ -674,9 +738,9 @@ public:
     }
 
     void set(mpz & a, uint64 val) {
-        if (val < INT_MAX) {
+        if (val <= static_cast<uint64>(INT64_MAX) && fits_small(static_cast<int64>(val))) {
             del(a);
-            a.m_val = static_cast<int>(val);
+            a.m_val = static_cast<int64>(val);
         }
         else {
             MPZ_BEGIN_CRITICAL();
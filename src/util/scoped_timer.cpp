@@ -53,6 +53,206 @@ Revision History:
 #include<limits.h>
 #include"z3_omp.h"
 
+#if !defined(_WINDOWS) && !defined(_CYGWIN) && !(defined(__APPLE__) && defined(__MACH__)) && (defined(_LINUX_) || defined(_FREEBSD_))
+#define _USE_TIMER_SERVICE
+#include"vector.h"
+
+/**
+   \brief Process-wide timer service.
+
+   A single background thread keeps the armed timers in a binary heap
+   ordered by deadline, and invokes the event handler of each timer
+   that expires. Arming and canceling a timer does not create threads.
+
+   Cancellation has the same semantics of joining a dedicated timer thread:
+   when cancel returns, the event handler of the entry is not running and
+   will not be executed.
+*/
+class timer_service {
+public:
+    struct entry {
+        struct timespec m_deadline;
+        event_handler * m_eh;
+        unsigned        m_heap_idx; //!< position in the heap, UINT_MAX if the entry is not armed.
+        entry(event_handler * eh):m_eh(eh), m_heap_idx(UINT_MAX) {}
+    };
+
+private:
+    pthread_mutex_t    m_mutex;
+    pthread_cond_t     m_wakeup;   //!< signaled when the earliest deadline changes and on shutdown.
+    pthread_cond_t     m_fired;    //!< signaled when an event handler finishes.
+    pthread_t          m_thread_id;
+    bool               m_started;
+    bool               m_shutdown;
+    ptr_vector<entry>  m_heap;
+    entry *            m_running;  //!< entry whose event handler is being executed.
+
+    static bool lt(struct timespec const & t1, struct timespec const & t2) {
+        return t1.tv_sec < t2.tv_sec || (t1.tv_sec == t2.tv_sec && t1.tv_nsec < t2.tv_nsec);
+    }
+
+    void set(unsigned idx, entry * e) {
+        m_heap[idx]   = e;
+        e->m_heap_idx = idx;
+    }
+
+    void move_up(unsigned idx) {
+        entry * e = m_heap[idx];
+        while (idx > 0) {
+            unsigned parent = (idx - 1) / 2;
+            if (!lt(e->m_deadline, m_heap[parent]->m_deadline))
+                break;
+            set(idx, m_heap[parent]);
+            idx = parent;
+        }
+        set(idx, e);
+    }
+
+    void move_down(unsigned idx) {
+        entry * e   = m_heap[idx];
+        unsigned sz = m_heap.size();
+        while (true) {
+            unsigned child = 2 * idx + 1;
+            if (child >= sz)
+                break;
+            if (child + 1 < sz && lt(m_heap[child + 1]->m_deadline, m_heap[child]->m_deadline))
+                child++;
+            if (!lt(m_heap[child]->m_deadline, e->m_deadline))
+                break;
+            set(idx, m_heap[child]);
+            idx = child;
+        }
+        set(idx, e);
+    }
+
+    void erase(entry * e) {
+        SASSERT(e->m_heap_idx < m_heap.size() && m_heap[e->m_heap_idx] == e);
+        unsigned idx  = e->m_heap_idx;
+        entry * last  = m_heap.back();
+        m_heap.pop_back();
+        e->m_heap_idx = UINT_MAX;
+        if (last != e) {
+            set(idx, last);
+            move_up(idx);
+            move_down(last->m_heap_idx);
+        }
+    }
+
+    static void * thread_func(void * arg) {
+        static_cast<timer_service*>(arg)->run();
+        return 0;
+    }
+
+    void run() {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_shutdown) {
+            if (m_heap.empty()) {
+                pthread_cond_wait(&m_wakeup, &m_mutex);
+                continue;
+            }
+            entry * e = m_heap[0];
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (lt(now, e->m_deadline)) {
+                // e may be canceled (and destroyed) while we are waiting.
+                struct timespec deadline = e->m_deadline;
+                int r = pthread_cond_timedwait(&m_wakeup, &m_mutex, &deadline);
+                ENSURE(r == 0 || r == ETIMEDOUT);
+                continue;
+            }
+            erase(e);
+            m_running = e;
+            pthread_mutex_unlock(&m_mutex);
+            e->m_eh->operator()();
+            pthread_mutex_lock(&m_mutex);
+            m_running = 0;
+            pthread_cond_broadcast(&m_fired);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+public:
+    timer_service():
+        m_started(false),
+        m_shutdown(false),
+        m_running(0) {
+        pthread_condattr_t attr;
+        ENSURE(pthread_mutex_init(&m_mutex, NULL) == 0);
+        ENSURE(pthread_condattr_init(&attr) == 0);
+        ENSURE(pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0);
+        ENSURE(pthread_cond_init(&m_wakeup, &attr) == 0);
+        ENSURE(pthread_cond_init(&m_fired, NULL) == 0);
+        pthread_condattr_destroy(&attr);
+    }
+
+    ~timer_service() {
+        pthread_mutex_lock(&m_mutex);
+        m_shutdown = true;
+        pthread_cond_signal(&m_wakeup);
+        pthread_mutex_unlock(&m_mutex);
+        if (m_started)
+            pthread_join(m_thread_id, NULL);
+        // timers that are still armed (e.g., the global timeout) are discarded.
+        for (unsigned i = 0; i < m_heap.size(); ++i)
+            m_heap[i]->m_heap_idx = UINT_MAX;
+        pthread_cond_destroy(&m_fired);
+        pthread_cond_destroy(&m_wakeup);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    void arm(entry & e, unsigned ms) {
+        clock_gettime(CLOCK_MONOTONIC, &e.m_deadline);
+        e.m_deadline.tv_sec  += ms / 1000u;
+        e.m_deadline.tv_nsec += (ms % 1000u) * 1000000ull;
+        // check for overflow
+        if (e.m_deadline.tv_nsec >= 1000000000) {
+            ++e.m_deadline.tv_sec;
+            e.m_deadline.tv_nsec -= 1000000000;
+        }
+        pthread_mutex_lock(&m_mutex);
+        if (!m_started) {
+            ENSURE(pthread_create(&m_thread_id, NULL, &thread_func, this) == 0);
+            m_started = true;
+        }
+        m_heap.push_back(&e);
+        move_up(m_heap.size() - 1);
+        if (e.m_heap_idx == 0)
+            pthread_cond_signal(&m_wakeup);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void cancel(entry & e) {
+        pthread_mutex_lock(&m_mutex);
+        if (e.m_heap_idx != UINT_MAX) {
+            // the earliest deadline may have changed, but waking up
+            // the service thread early is harmless.
+            erase(&e);
+        }
+        else {
+            // The event handler may destroy its own timer (see timeout.cpp).
+            // In this case, we must not wait for it.
+            while (m_running == &e && !pthread_equal(pthread_self(), m_thread_id))
+                pthread_cond_wait(&m_fired, &m_mutex);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+};
+
+static timer_service * g_timer_service = 0;
+static pthread_mutex_t g_timer_service_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The service is created on demand since timers may be armed
+// before memory::initialize is invoked (e.g., z3 -T:<timeout>).
+static timer_service & get_timer_service() {
+    pthread_mutex_lock(&g_timer_service_lock);
+    if (!g_timer_service)
+        g_timer_service = alloc(timer_service);
+    pthread_mutex_unlock(&g_timer_service_lock);
+    return *g_timer_service;
+}
+
+#endif
+
 struct scoped_timer::imp {
     event_handler *  m_eh;
 #if defined(_WINDOWS) || defined(_CYGWIN)
@@ -68,11 +268,7 @@ struct scoped_timer::imp {
     struct timespec  m_end_time;
 #elif defined(_LINUX_) || defined(_FREEBSD_)
     // Linux & FreeBSD
-    pthread_t       m_thread_id;
-    pthread_mutex_t m_mutex;
-    pthread_cond_t  m_cond;
-    unsigned        m_ms;
-    bool            m_initialized;
+    timer_service::entry m_entry;
 #else
     // Other
 #endif
@@ -103,37 +299,17 @@ struct scoped_timer::imp {
 
         return st;
     }
-#elif defined(_LINUX_) || defined(_FREEBSD_)
-    static void* thread_func(void *arg) {
-        scoped_timer::imp *st = static_cast<scoped_timer::imp*>(arg);
-
-        struct timespec end_time;
-        clock_gettime(CLOCK_REALTIME, &end_time);
-        end_time.tv_sec  += st->m_ms / 1000u;
-        end_time.tv_nsec += (st->m_ms % 1000u) * 1000000ull;
-        // check for overflow
-        if (end_time.tv_nsec >= 1000000000) {
-            ++end_time.tv_sec;
-            end_time.tv_nsec -= 1000000000;
-        }
-
-        pthread_mutex_lock(&st->m_mutex);
-        st->m_initialized = true;
-        int e = pthread_cond_timedwait(&st->m_cond, &st->m_mutex, &end_time);
-        ENSURE(e == 0 || e == ETIMEDOUT);
-
-        pthread_mutex_unlock(&st->m_mutex);
-        if (e == ETIMEDOUT)
-            st->m_eh->operator()();
-        return 0;
-    }
 #else
     // Other
 #endif
 
 
     imp(unsigned ms, event_handler * eh):
-        m_eh(eh) {
+        m_eh(eh)
+#if defined(_USE_TIMER_SERVICE)
+        , m_entry(eh)
+#endif
+    {
 #if defined(_WINDOWS) || defined(_CYGWIN)
         m_first = true;
         CreateTimerQueueTimer(&m_timer,
@@ -168,11 +344,7 @@ struct scoped_timer::imp {
             throw default_exception("failed to start timer thread");
 #elif defined(_LINUX_) || defined(_FREEBSD_)
         // Linux & FreeBSD
-        m_ms = ms;
-        m_initialized = false;
-        ENSURE(pthread_mutex_init(&m_mutex, NULL) == 0);
-        ENSURE(pthread_cond_init(&m_cond, NULL) == 0);
-        ENSURE(pthread_create(&m_thread_id, NULL, &thread_func, this) == 0);
+        get_timer_service().arm(m_entry, ms);
 #else
     // Other platforms
 #endif
@@ -208,21 +380,8 @@ struct scoped_timer::imp {
             throw default_exception("failed to destroy pthread attributes object");
 #elif defined(_LINUX_) || defined(_FREEBSD_)
         // Linux & FreeBSD
-        bool init = false;
-
-        // spin until timer thread has been created
-        while (!init) {
-            pthread_mutex_lock(&m_mutex);
-            init = m_initialized;
-            pthread_mutex_unlock(&m_mutex);
-            if (!init)
-                sched_yield();
-        }
-        pthread_cond_signal(&m_cond);
-
-        pthread_join(m_thread_id, NULL);
-        pthread_cond_destroy(&m_cond);
-        pthread_mutex_destroy(&m_mutex);
+        if (g_timer_service)
+            g_timer_service->cancel(m_entry);
 #else
     // Other Platforms
 #endif
@@ -241,3 +400,12 @@ scoped_timer::~scoped_timer() {
     if (m_imp)
         dealloc(m_imp);
 }
+
+void finalize_scoped_timer() {
+#if defined(_USE_TIMER_SERVICE)
+    pthread_mutex_lock(&g_timer_service_lock);
+    dealloc(g_timer_service);
+    g_timer_service = 0;
+    pthread_mutex_unlock(&g_timer_service_lock);
+#endif
+}
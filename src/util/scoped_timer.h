@@ -29,4 +29,9 @@ public:
     ~scoped_timer();
 };
 
+void finalize_scoped_timer();
+/*
+  ADD_FINALIZER('finalize_scoped_timer();')
+*/
+
 #endif
@@ -27,23 +27,44 @@ const symbol symbol::null;
 
 /**
    \brief Symbol table manager. It stores the symbol strings created at runtime.
+
+   The table is partitioned into shards selected by the string hash.
+   Each shard owns its own region and lock, so threads interning
+   different strings rarely contend with each other.
 */
 class internal_symbol_table {
-    region        m_region; //!< Region used to store symbol strings.
-    str_hashtable m_table;  //!< Table of created symbol strings.
+    static const unsigned num_shards_log = 5;
+    static const unsigned num_shards     = 1u << num_shards_log;
+
+    struct shard {
+        omp_lock_t    m_lock;
+        region        m_region; //!< Region used to store symbol strings.
+        str_hashtable m_table;  //!< Table of created symbol strings.
+        shard() { omp_init_lock(&m_lock); }
+        ~shard() { omp_destroy_lock(&m_lock); }
+    };
+
+    shard m_shards[num_shards];
+
+    // The hashtable uses the low bits of the hash to select a bucket,
+    // so use the high bits to select the shard.
+    static unsigned shard_of(unsigned h) { return h >> (32 - num_shards_log); }
+
 public:
 
     char const * get_str(char const * d) {
         char * result;
-        #pragma omp critical (cr_symbol) 
-        {
+        size_t l    = strlen(d);
+        unsigned h  = string_hash(d, static_cast<unsigned>(l), 17);
+        shard & s   = m_shards[shard_of(h)];
+        omp_set_lock(&s.m_lock);
         char * r_d = const_cast<char *>(d);
         str_hashtable::entry * e;
-        if (m_table.insert_if_not_there_core(r_d, e)) {
+        if (s.m_table.insert_if_not_there_core(r_d, e)) {
             // new entry
-            size_t l   = strlen(d);
+            SASSERT(e->get_hash() == h);
             // store the hash-code before the string
-            size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + sizeof(size_t)));
+            size_t * mem = static_cast<size_t*>(s.m_region.allocate(l + 1 + sizeof(size_t)));
             *mem = e->get_hash();
             mem++;
             result = reinterpret_cast<char*>(mem);
@@ -54,8 +75,8 @@ public:
         else {
             result = e->get_data();
         }
-        SASSERT(m_table.contains(result));
-        }
+        SASSERT(s.m_table.contains(result));
+        omp_unset_lock(&s.m_lock);
         return result;
     }
 };